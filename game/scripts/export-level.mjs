@@ -0,0 +1,219 @@
+// Converts authored level JSON (levels/*.json) into the binary layout read by src/engine/Level.ts
+//
+// usage: node scripts/export-level.mjs <source dir> <output dir> [--json]
+// --json also writes the expanded data as JSON next to each .lvl, for Level.benchmark()
+import fs from 'node:fs';
+import path from 'node:path';
+
+const MAGIC = 0x4c564c53;
+const VERSION = 1;
+const HEADER_BYTES = 64;
+const SECTION_BYTES = 16;
+const BVH_LEAF_SIZE = 4;
+const NO_NEIGHBOUR = 0xffffffff;
+// XFRM follows the transform schema, the same one src/engine/Components.ts is generated from
+const TRANSFORM = JSON.parse(fs.readFileSync(new URL('../components/transform.json', import.meta.url), 'utf8'));
+// Fields without a size are scalars, as in scripts/generate-components.mjs
+const fieldSize = (field) => field.size ?? 1;
+const TRANSFORM_STRIDE = TRANSFORM.fields.reduce((sum, field) => sum + fieldSize(field), 0);
+const TRANSFORM_DEFAULTS = { rotation: [0, 0, 0, 1], scale: [1, 1, 1] };
+
+const fourCC = (id) => (id.charCodeAt(0) | id.charCodeAt(1) << 8 | id.charCodeAt(2) << 16 | id.charCodeAt(3) << 24) >>> 0;
+
+function buildBvh(entities) {
+    const bounds = entities.map((entity) => {
+        const [x, y, z] = entity.position;
+        const [sx, sy, sz] = (entity.scale ?? [1, 1, 1]).map((s) => Math.abs(s) / 2);
+
+        return [x - sx, y - sy, z - sz, x + sx, y + sy, z + sz];
+    });
+    const items = entities.map((_, i) => i);
+    const nodes = [];
+
+    const build = (node, first, count) => {
+        const box = [Infinity, Infinity, Infinity, -Infinity, -Infinity, -Infinity];
+
+        for (let i = first; i < first + count; i++) {
+            const b = bounds[items[i]];
+
+            for (let k = 0; k < 3; k++) {
+                box[k] = Math.min(box[k], b[k]);
+                box[k + 3] = Math.max(box[k + 3], b[k + 3]);
+            }
+        }
+
+        nodes[node] = { box, first, count };
+
+        if (count <= BVH_LEAF_SIZE) {
+            return;
+        }
+
+        const extent = [box[3] - box[0], box[4] - box[1], box[5] - box[2]];
+        const axis = extent.indexOf(Math.max(...extent));
+        const centre = (i) => bounds[i][axis] + bounds[i][axis + 3];
+        const sorted = items.slice(first, first + count).sort((a, b) => centre(a) - centre(b));
+
+        items.splice(first, count, ...sorted);
+
+        const half = count >> 1;
+        const left = nodes.length;
+
+        nodes.push(null, null);
+        nodes[node] = { box, first: left, count: 0 };
+
+        build(left, first, half);
+        build(left + 1, first + half, count - half);
+    };
+
+    if (entities.length > 0) {
+        build(0, 0, entities.length);
+    }
+
+    return { nodes, items };
+}
+
+function buildNeighbours(triangles) {
+    const edges = new Map();
+    const neighbours = triangles.map(() => [NO_NEIGHBOUR, NO_NEIGHBOUR, NO_NEIGHBOUR]);
+
+    triangles.forEach((triangle, t) => {
+        for (let e = 0; e < 3; e++) {
+            const a = triangle[e];
+            const b = triangle[(e + 1) % 3];
+            const key = a < b ? `${a}:${b}` : `${b}:${a}`;
+            const other = edges.get(key);
+
+            if (other) {
+                neighbours[t][e] = other.t;
+                neighbours[other.t][other.e] = t;
+            } else {
+                edges.set(key, { t, e });
+            }
+        }
+    });
+
+    return neighbours;
+}
+
+function expand(level) {
+    const entities = level.entities ?? [];
+    const lights = level.lights ?? [];
+    const rooms = level.rooms ?? 1 + Math.max(0, ...entities.map((entity) => entity.room ?? 0));
+    const navmesh = level.navmesh ?? { vertices: [], triangles: [] };
+    const roomLights = Array.from({ length: rooms }, () => []);
+
+    lights.forEach((light, i) => roomLights[light.room ?? 0].push(i));
+
+    return {
+        rooms,
+        entities,
+        bvh: buildBvh(entities),
+        portals: level.portals ?? [],
+        navmesh: { vertices: navmesh.vertices, triangles: navmesh.triangles, neighbours: buildNeighbours(navmesh.triangles) },
+        lights,
+        roomLights
+    };
+}
+
+function write(data) {
+    const sections = [];
+    const add = (id, Type, values) => sections.push({ id: fourCC(id), data: Type.from(values), count: 0 });
+
+    const { entities, bvh, portals, navmesh, lights, roomLights } = data;
+
+    add('EKND', Uint16Array, entities.map((entity) => entity.kind ?? 0));
+    add('EFLG', Uint16Array, entities.map((entity) => entity.flags ?? 0));
+    add('EROM', Uint16Array, entities.map((entity) => entity.room ?? 0));
+    add('XFRM', Float32Array, entities.flatMap((entity) => TRANSFORM.fields.flatMap((field) => {
+        const size = fieldSize(field);
+        const value = entity[field.name] ?? TRANSFORM_DEFAULTS[field.name] ?? new Array(size).fill(0);
+        // A scalar field is written as one float, authored as a number or a one element array
+        const values = typeof value === 'number' ? [value] : value;
+
+        if (values.length !== size) {
+            throw new Error(`Entity ${field.name} has ${values.length} Values, the Transform Schema Expects ${size}.`);
+        }
+
+        return values;
+    })));
+    add('BVHB', Float32Array, bvh.nodes.flatMap((node) => node.box));
+    add('BVHL', Uint32Array, bvh.nodes.flatMap((node) => [node.first, node.count]));
+    add('BVHI', Uint32Array, bvh.items);
+    add('PRTQ', Float32Array, portals.flatMap((portal) => portal.quad));
+    add('PRTR', Uint16Array, portals.flatMap((portal) => portal.rooms));
+    add('NAVV', Float32Array, navmesh.vertices.flat());
+    add('NAVT', Uint32Array, navmesh.triangles.flatMap((triangle, t) => [...triangle, ...navmesh.neighbours[t]]));
+    add('LITE', Float32Array, lights.flatMap((light) => [
+        ...light.position, light.range ?? 5,
+        ...(light.color ?? [1, 1, 1]), light.intensity ?? 1,
+        ...(light.direction ?? [0, -1, 0]), light.cone ?? -1
+    ]));
+
+    const starts = [0];
+
+    roomLights.forEach((list) => starts.push(starts[starts.length - 1] + list.length));
+
+    add('RLST', Uint32Array, starts);
+    add('RLIT', Uint16Array, roomLights.flat());
+
+    const widths = { EKND: 1, EFLG: 1, EROM: 1, XFRM: TRANSFORM_STRIDE, BVHB: 6, BVHL: 2, BVHI: 1, PRTQ: 12, PRTR: 2, NAVV: 3, NAVT: 6, LITE: 12, RLST: 1, RLIT: 1 };
+    let offset = HEADER_BYTES + sections.length * SECTION_BYTES;
+
+    for (const section of sections) {
+        const name = String.fromCharCode(section.id & 0xff, section.id >> 8 & 0xff, section.id >> 16 & 0xff, section.id >>> 24);
+
+        offset = (offset + 15) & ~15;
+        section.offset = offset;
+        section.count = section.data.length / widths[name];
+        offset += section.data.byteLength;
+    }
+
+    const total = (offset + 15) & ~15;
+    const buffer = new ArrayBuffer(total);
+    const header = new DataView(buffer);
+
+    header.setUint32(0, MAGIC, true);
+    header.setUint16(4, VERSION, true);
+    header.setUint16(6, sections.length, true);
+    header.setUint32(8, total, true);
+
+    sections.forEach((section, i) => {
+        const at = HEADER_BYTES + i * SECTION_BYTES;
+
+        header.setUint32(at, section.id, true);
+        header.setUint32(at + 4, section.offset, true);
+        header.setUint32(at + 8, section.data.byteLength, true);
+        header.setUint32(at + 12, section.count, true);
+
+        new Uint8Array(buffer, section.offset, section.data.byteLength).set(new Uint8Array(section.data.buffer));
+    });
+
+    return new Uint8Array(buffer);
+}
+
+function main(args) {
+    const [source, output] = args.filter((arg) => !arg.startsWith('--'));
+    const json = args.includes('--json');
+
+    if (!source || !output) {
+        throw new Error('Usage: node scripts/export-level.mjs <source dir> <output dir> [--json]');
+    }
+
+    fs.mkdirSync(output, { recursive: true });
+
+    for (const file of fs.readdirSync(source).filter((file) => file.endsWith('.json'))) {
+        const name = path.basename(file, '.json');
+        const data = expand(JSON.parse(fs.readFileSync(path.join(source, file), 'utf8')));
+        const binary = write(data);
+
+        fs.writeFileSync(path.join(output, `${name}.lvl`), binary);
+
+        if (json) {
+            fs.writeFileSync(path.join(output, `${name}.json`), JSON.stringify(data));
+        }
+
+        console.log(`${name}: ${data.entities.length} entities, ${data.bvh.nodes.length} bvh nodes, ${binary.byteLength} bytes`);
+    }
+}
+
+main(process.argv.slice(2));
@@ -0,0 +1,138 @@
+// Generates monomorphic accessors for the component schemas in components/*.json into one TypeScript file
+//
+// usage: node scripts/generate-components.mjs <schema dir> <output file>
+//
+// Each component is one interleaved typed array, stride scalars per entity. Vector fields expand to one
+// scalar per axis (position -> positionX, positionY, positionZ). For every component the output holds
+//   <Name>Layout   stride and field offsets
+//   <Name>Columns  get and set per field at a fixed offset
+//   <Name>Query    steps through entities, loading every field into plain properties and storing them back
+//   write/read<Name>  little endian serializers over entities [0, count)
+// Code that reads components through names or string keys sees many object shapes at one site and
+// V8 gives up on it, here every access is a constant offset into one array type.
+import fs from 'node:fs';
+import path from 'node:path';
+
+const TYPES = {
+    f32: { array: 'Float32Array', bytes: 4, view: 'Float32' },
+    i32: { array: 'Int32Array', bytes: 4, view: 'Int32' },
+    u32: { array: 'Uint32Array', bytes: 4, view: 'Uint32' },
+    u16: { array: 'Uint16Array', bytes: 2, view: 'Uint16' },
+    u8: { array: 'Uint8Array', bytes: 1, view: 'Uint8' }
+};
+const AXES = ['X', 'Y', 'Z', 'W'];
+
+const capitalize = (name) => name[0].toUpperCase() + name.slice(1);
+
+function expand(schema, file) {
+    const type = TYPES[schema.type];
+
+    if (!/^[A-Z]\w*$/.test(schema.name ?? '') || !type) {
+        throw new Error(`Component Schema '${file}' Needs a Capitalized name and one of the types ${Object.keys(TYPES).join(', ')}.`);
+    }
+
+    const scalars = schema.fields.flatMap((field) => {
+        const size = field.size ?? 1;
+
+        if (size < 1 || size > AXES.length) {
+            throw new Error(`Field '${schema.name}.${field.name}' has a size of ${size}, Expected 1 to ${AXES.length}.`);
+        }
+
+        return size === 1 ? [field.name] : AXES.slice(0, size).map((axis) => field.name + axis);
+    });
+
+    return { name: schema.name, type, scalars };
+}
+
+function generate({ name, type, scalars }) {
+    const stride = scalars.length;
+    const at = (i) => (i === 0 ? 'base' : `base + ${i}`);
+    const lines = [];
+
+    lines.push(`// ${name}, ${stride} ${type.view.toLowerCase()} per entity`);
+    lines.push(`const ${name}Layout = {`);
+    lines.push(`    stride: ${stride},`);
+    scalars.forEach((scalar, i) => lines.push(`    ${scalar}: ${i}${i < stride - 1 ? ',' : ''}`));
+    lines.push('} as const;', '');
+
+    lines.push(`class ${name}Columns {`);
+    lines.push(`    public readonly data: ${type.array};`, '');
+    lines.push(`    constructor(data: ${type.array}) {`, '        this.data = data;', '    }');
+
+    scalars.forEach((scalar, i) => {
+        const offset = i === 0 ? '' : ` + ${i}`;
+
+        lines.push('');
+        lines.push(`    public ${scalar}(entity: number): number {`, `        return this.data[entity * ${stride}${offset}];`, '    }', '');
+        lines.push(`    public set${capitalize(scalar)}(entity: number, value: number): void {`, `        this.data[entity * ${stride}${offset}] = value;`, '    }');
+    });
+
+    lines.push('}', '');
+
+    lines.push(`class ${name}Query {`);
+    lines.push('    public entity: number = -1;');
+    scalars.forEach((scalar) => lines.push(`    public ${scalar}: number = 0;`));
+    lines.push('');
+    lines.push(`    private data: ${type.array};`);
+    lines.push('    private entities: Uint32Array | null = null;');
+    lines.push('    private count: number = 0;');
+    lines.push('    private cursor: number = 0;', '');
+    lines.push(`    constructor(data: ${type.array}) {`, '        this.data = data;', '    }', '');
+    lines.push('    // entities lists the indices to visit, null visits [0, count)');
+    lines.push('    public reset(entities: Uint32Array | null, count: number): this {');
+    lines.push('        this.entities = entities;', '        this.count = count;', '        this.cursor = 0;', '        this.entity = -1;', '');
+    lines.push('        return this;', '    }', '');
+    lines.push('    public next(): boolean {', '        if (this.cursor >= this.count) {', '            return false;', '        }', '');
+    lines.push('        const entity = this.entities ? this.entities[this.cursor] : this.cursor;');
+    lines.push(`        const base = entity * ${stride};`);
+    lines.push('        const data = this.data;', '');
+    lines.push('        this.cursor++;', '        this.entity = entity;');
+    scalars.forEach((scalar, i) => lines.push(`        this.${scalar} = data[${at(i)}];`));
+    lines.push('', '        return true;', '    }', '');
+    lines.push('    // Writes the current entity\'s fields back');
+    lines.push('    public store(): void {');
+    lines.push(`        const base = this.entity * ${stride};`);
+    lines.push('        const data = this.data;', '');
+    scalars.forEach((scalar, i) => lines.push(`        data[${at(i)}] = this.${scalar};`));
+    lines.push('    }', '}', '');
+
+    const little = type.bytes === 1 ? '' : ', true';
+
+    lines.push('// Returns the byte offset after the last entity');
+    lines.push(`const write${name} = (view: DataView, offset: number, data: ${type.array}, count: number): number => {`);
+    lines.push('    for (let entity = 0; entity < count; entity++) {');
+    lines.push(`        const base = entity * ${stride};`, '');
+    scalars.forEach((_, i) => lines.push(`        view.set${type.view}(${i === 0 ? 'offset' : `offset + ${i * type.bytes}`}, data[${at(i)}]${little});`));
+    lines.push(`        offset += ${stride * type.bytes};`, '    }', '', '    return offset;', '};', '');
+
+    lines.push(`const read${name} = (view: DataView, offset: number, data: ${type.array}, count: number): number => {`);
+    lines.push('    for (let entity = 0; entity < count; entity++) {');
+    lines.push(`        const base = entity * ${stride};`, '');
+    scalars.forEach((_, i) => lines.push(`        data[${at(i)}] = view.get${type.view}(${i === 0 ? 'offset' : `offset + ${i * type.bytes}`}${little});`));
+    lines.push(`        offset += ${stride * type.bytes};`, '    }', '', '    return offset;', '};');
+
+    return lines.join('\n');
+}
+
+function main(args) {
+    const [source, output] = args;
+
+    if (!source || !output) {
+        throw new Error('Usage: node scripts/generate-components.mjs <schema dir> <output file>');
+    }
+
+    const components = fs.readdirSync(source)
+        .filter((file) => file.endsWith('.json'))
+        .sort()
+        .map((file) => expand(JSON.parse(fs.readFileSync(path.join(source, file), 'utf8')), file));
+    const names = components.flatMap(({ name }) => [`${name}Layout`, `${name}Columns`, `${name}Query`, `write${name}`, `read${name}`]);
+    const header = `// Generated by scripts/generate-components.mjs from ${source}/*.json, edit the schemas instead`;
+
+    fs.writeFileSync(output, `${header}\n${components.map(generate).join('\n\n')}\n\nexport {\n    ${names.join(',\n    ')}\n};\n`);
+
+    for (const { name, scalars } of components) {
+        console.log(`${name}: ${scalars.length} fields`);
+    }
+}
+
+main(process.argv.slice(2));
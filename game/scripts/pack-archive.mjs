@@ -0,0 +1,190 @@
+// Packs asset directories into one archive, read by src/engine/AssetArchive.ts (keep both in sync)
+//
+// usage: node scripts/pack-archive.mjs <source dir> <output name> <sub dir>...
+// e.g.   node scripts/pack-archive.mjs public public/assets levels sounds
+//        writes public/assets.pak with raw blocks and public/assets.lz4.pak with LZ4 blocks
+//
+// header   32 bytes  u32 magic 'SPAK', u16 version, u16 entry count, u32 block size, u32 block count, u32 data offset, rest reserved
+// blocks   12 bytes per block  u32 file offset, u32 stored bytes, u32 raw bytes (stored equal to raw means not compressed)
+// entries  per entry  u32 first block, u32 block count, u32 raw bytes, u8 name length, ascii name
+// data     block contents back to back, the blocks of an entry are contiguous
+//
+// Blocks compress independently, so one large asset decodes on several threads at once.
+import fs from 'node:fs';
+import path from 'node:path';
+
+const MAGIC = 0x4b415053;
+const VERSION = 1;
+const HEADER_BYTES = 32;
+const BLOCK_ENTRY_BYTES = 12;
+const BLOCK_SIZE = 65536;
+const HASH_BITS = 16;
+const MIN_MATCH = 4;
+// The format ends every block on literals, a match may not start in the last 12 bytes or cover the last 5
+const LAST_MATCH_START = 12;
+const LAST_LITERALS = 5;
+
+// Greedy LZ4 block compression with a single entry hash table
+function compressBlock(input) {
+    const output = Buffer.alloc(input.length + Math.ceil(input.length / 255) + 16);
+    const table = new Int32Array(1 << HASH_BITS).fill(-1);
+    const hash = (at) => Math.imul(input.readUInt32LE(at), 2654435761) >>> (32 - HASH_BITS);
+    let anchor = 0;
+    let at = 0;
+    let out = 0;
+
+    const writeLength = (length) => {
+        for (; length >= 255; length -= 255) {
+            output[out++] = 255;
+        }
+
+        output[out++] = length;
+    };
+
+    const sequence = (literalEnd, matchLength, offset) => {
+        const literals = literalEnd - anchor;
+        const token = out++;
+
+        output[token] = Math.min(literals, 15) << 4;
+
+        if (literals >= 15) {
+            writeLength(literals - 15);
+        }
+
+        input.copy(output, out, anchor, literalEnd);
+        out += literals;
+
+        if (matchLength > 0) {
+            output.writeUInt16LE(offset, out);
+            out += 2;
+            output[token] |= Math.min(matchLength - MIN_MATCH, 15);
+
+            if (matchLength - MIN_MATCH >= 15) {
+                writeLength(matchLength - MIN_MATCH - 15);
+            }
+        }
+    };
+
+    while (at < input.length - LAST_MATCH_START) {
+        const slot = hash(at);
+        const candidate = table[slot];
+
+        table[slot] = at;
+
+        if (candidate < 0 || at - candidate > 65535 || input.readUInt32LE(candidate) !== input.readUInt32LE(at)) {
+            at++;
+            continue;
+        }
+
+        let length = MIN_MATCH;
+
+        while (at + length < input.length - LAST_LITERALS && input[candidate + length] === input[at + length]) {
+            length++;
+        }
+
+        sequence(at, length, at - candidate);
+        at += length;
+        anchor = at;
+    }
+
+    sequence(input.length, 0, 0);
+
+    return output.subarray(0, out);
+}
+
+function collect(root, dirs) {
+    const files = [];
+
+    const walk = (dir) => {
+        for (const entry of fs.readdirSync(path.join(root, dir), { withFileTypes: true })) {
+            const name = path.posix.join(dir, entry.name);
+
+            if (entry.isDirectory()) {
+                walk(name);
+            } else {
+                files.push(name);
+            }
+        }
+    };
+
+    for (const dir of dirs) {
+        walk(dir);
+    }
+
+    return files.sort();
+}
+
+function pack(root, files, compress) {
+    const blocks = [];
+    const entries = [];
+
+    for (const name of files) {
+        const data = fs.readFileSync(path.join(root, name));
+
+        if (name.length > 255) {
+            throw new Error(`Asset Name '${name}' is Longer than 255 Characters.`);
+        }
+
+        entries.push({ name, first: blocks.length, count: Math.ceil(data.length / BLOCK_SIZE), bytes: data.length });
+
+        for (let start = 0; start < data.length; start += BLOCK_SIZE) {
+            const raw = data.subarray(start, Math.min(data.length, start + BLOCK_SIZE));
+            const packed = compress ? compressBlock(raw) : raw;
+
+            // Incompressible blocks, audio and video mostly, are stored as they are
+            blocks.push({ raw: raw.length, data: packed.length < raw.length ? packed : raw });
+        }
+    }
+
+    const table = Buffer.concat(entries.map((entry) => {
+        const bytes = Buffer.alloc(13 + entry.name.length);
+
+        bytes.writeUInt32LE(entry.first, 0);
+        bytes.writeUInt32LE(entry.count, 4);
+        bytes.writeUInt32LE(entry.bytes, 8);
+        bytes.writeUInt8(entry.name.length, 12);
+        bytes.write(entry.name, 13, 'ascii');
+
+        return bytes;
+    }));
+    const dataOffset = HEADER_BYTES + blocks.length * BLOCK_ENTRY_BYTES + table.length;
+    const blockTable = Buffer.alloc(blocks.length * BLOCK_ENTRY_BYTES);
+    const header = Buffer.alloc(HEADER_BYTES);
+    let offset = dataOffset;
+
+    blocks.forEach((block, i) => {
+        blockTable.writeUInt32LE(offset, i * BLOCK_ENTRY_BYTES);
+        blockTable.writeUInt32LE(block.data.length, i * BLOCK_ENTRY_BYTES + 4);
+        blockTable.writeUInt32LE(block.raw, i * BLOCK_ENTRY_BYTES + 8);
+        offset += block.data.length;
+    });
+
+    header.writeUInt32LE(MAGIC, 0);
+    header.writeUInt16LE(VERSION, 4);
+    header.writeUInt16LE(entries.length, 6);
+    header.writeUInt32LE(BLOCK_SIZE, 8);
+    header.writeUInt32LE(blocks.length, 12);
+    header.writeUInt32LE(dataOffset, 16);
+
+    return Buffer.concat([header, blockTable, table, ...blocks.map((block) => block.data)]);
+}
+
+function main(args) {
+    const [source, output, ...dirs] = args;
+
+    if (!source || !output || dirs.length === 0) {
+        throw new Error('Usage: node scripts/pack-archive.mjs <source dir> <output name> <sub dir>...');
+    }
+
+    const files = collect(source, dirs);
+    const raw = pack(source, files, false);
+    const compressed = pack(source, files, true);
+
+    fs.mkdirSync(path.dirname(output), { recursive: true });
+    fs.writeFileSync(`${output}.pak`, raw);
+    fs.writeFileSync(`${output}.lz4.pak`, compressed);
+
+    console.log(`${path.basename(output)}: ${files.length} assets, ${raw.length} bytes raw, ${compressed.length} bytes lz4`);
+}
+
+main(process.argv.slice(2));
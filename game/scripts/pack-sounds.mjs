@@ -0,0 +1,193 @@
+// Packs every sub directory of sounds/ into one sound bank (<name>.bank), read by src/engine/SoundBank.ts (keep both in sync)
+//
+// usage: node scripts/pack-sounds.mjs <source dir> <output dir>
+//
+// header  16 bytes  u32 magic 'SBNK', u16 version, u16 sound count, u32 sample rate, u32 audio byte offset
+// table   per sound u32 first sample, u32 sample count, u8 name length, ascii name
+// audio   the MP3 frames of every sound back to back, so the whole bank decodes in one go
+//
+// MP3 streams can be joined at frame boundaries. Tags and the Xing/Info frame are dropped, otherwise
+// decoders would trim gapless padding from the first sound only and every later offset would be off.
+// The trim moves into the table instead: a sound's region starts after the decoder delay and the
+// encoder delay from its LAME tag, and stops before the encoder padding, so loops have no silent seam.
+import fs from 'node:fs';
+import path from 'node:path';
+
+const MAGIC = 0x4b4e4253;
+const VERSION = 1;
+const HEADER_BYTES = 16;
+// Samples every Layer III decoder outputs before the first encoded one
+const DECODER_DELAY = 529;
+
+// Layer III only, indexed by the version bits (0 MPEG 2.5, 2 MPEG 2, 3 MPEG 1)
+const BITRATES = {
+    3: [0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320],
+    2: [0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160],
+    0: [0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160]
+};
+const SAMPLE_RATES = {
+    3: [44100, 48000, 32000],
+    2: [22050, 24000, 16000],
+    0: [11025, 12000, 8000]
+};
+
+function parseHeader(bytes, at) {
+    if (at + 4 > bytes.length || bytes[at] !== 0xff || (bytes[at + 1] & 0xe0) !== 0xe0) {
+        return null;
+    }
+
+    const version = (bytes[at + 1] >> 3) & 3;
+    const layer = (bytes[at + 1] >> 1) & 3;
+    const bitrate = BITRATES[version]?.[bytes[at + 2] >> 4];
+    const sampleRate = SAMPLE_RATES[version]?.[(bytes[at + 2] >> 2) & 3];
+    const padding = (bytes[at + 2] >> 1) & 1;
+
+    if (layer !== 1 || !bitrate || !sampleRate) {
+        return null;
+    }
+
+    const samples = version === 3 ? 1152 : 576;
+    const mono = bytes[at + 3] >> 6 === 3;
+    // A Xing/Info/VBRI tag sits right after the side information
+    const sideInfo = version === 3 ? (mono ? 17 : 32) : (mono ? 9 : 17);
+
+    return { sampleRate, samples, sideInfo, length: Math.floor(samples / 8 * bitrate * 1000 / sampleRate) + padding };
+}
+
+// Encoder delay and padding in samples, from the LAME extension that follows a Xing/Info tag
+//
+// tag    4 bytes 'Xing' or 'Info', u32 flags, then frames, bytes, toc and quality when their flag is set
+// LAME   9 bytes version string, revision, lowpass, 8 bytes replay gain, flags, bitrate, then 12 bit delay and padding
+function readGapless(frame, tagStart) {
+    const flags = frame.readUInt32BE(tagStart + 4);
+    let at = tagStart + 8;
+
+    at += flags & 1 ? 4 : 0;
+    at += flags & 2 ? 4 : 0;
+    at += flags & 4 ? 100 : 0;
+    at += flags & 8 ? 4 : 0;
+
+    if (at + 24 > frame.length || !/^(LAME|Lavc|Lavf|GOGO)/.test(frame.toString('latin1', at, at + 4))) {
+        return { delay: 0, padding: 0 };
+    }
+
+    const packed = frame.readUIntBE(at + 21, 3);
+
+    return { delay: packed >> 12, padding: packed & 0xfff };
+}
+
+// Returns the audio frames without tags, with their sample rate, decoded length and gapless trim
+function readFrames(file) {
+    const bytes = fs.readFileSync(file);
+    const frames = [];
+    let at = 0;
+    let sampleRate = 0;
+    let samples = 0;
+    // Without a LAME tag nothing says how much the encoder added, the region then keeps all of it
+    let gapless = { delay: 0, padding: 0 };
+
+    // ID3v2 tag, its size is a 28 bit syncsafe integer
+    if (bytes.toString('latin1', 0, 3) === 'ID3') {
+        at = 10 + ((bytes[6] << 21) | (bytes[7] << 14) | (bytes[8] << 7) | bytes[9]);
+    }
+
+    while (at < bytes.length) {
+        const header = parseHeader(bytes, at);
+
+        if (!header) {
+            // Trailing ID3v1 tag or garbage between frames
+            at++;
+            continue;
+        }
+
+        const frame = bytes.subarray(at, at + header.length);
+        const tag = frame.toString('latin1', 4 + header.sideInfo, 8 + header.sideInfo);
+
+        at += header.length;
+
+        if (frames.length === 0 && (tag === 'Xing' || tag === 'Info')) {
+            gapless = readGapless(frame, 4 + header.sideInfo);
+            continue;
+        }
+
+        if (frames.length === 0 && frame.toString('latin1', 36, 40) === 'VBRI') {
+            continue;
+        }
+
+        if (sampleRate && header.sampleRate !== sampleRate) {
+            throw new Error(`${file} Changes Sample Rate Mid Stream.`);
+        }
+
+        sampleRate = header.sampleRate;
+        samples += header.samples;
+        frames.push(frame);
+    }
+
+    if (frames.length === 0) {
+        throw new Error(`${file} Holds no MPEG Layer III Frames.`);
+    }
+
+    if (gapless.delay + gapless.padding >= samples) {
+        throw new Error(`${file} Trims ${gapless.delay + gapless.padding} Samples but Holds only ${samples}.`);
+    }
+
+    return { frames, sampleRate, samples, ...gapless };
+}
+
+function pack(directory) {
+    const files = fs.readdirSync(directory).filter((file) => file.endsWith('.mp3')).sort();
+    const sounds = files.map((file) => ({ name: path.basename(file, '.mp3'), ...readFrames(path.join(directory, file)) }));
+    const sampleRate = sounds[0]?.sampleRate;
+
+    for (const sound of sounds) {
+        if (sound.sampleRate !== sampleRate) {
+            throw new Error(`${sound.name} is ${sound.sampleRate}Hz but its Bank is ${sampleRate}Hz, Resample it or Move it to Another Bank.`);
+        }
+    }
+
+    const table = Buffer.concat(sounds.map((sound, i) => {
+        const entry = Buffer.alloc(9 + sound.name.length);
+        const first = sounds.slice(0, i).reduce((sum, other) => sum + other.samples, 0);
+
+        // Every sound's frames are still in the bank, the region skips what the decoders would have trimmed
+        entry.writeUInt32LE(DECODER_DELAY + first + sound.delay, 0);
+        entry.writeUInt32LE(sound.samples - sound.delay - sound.padding, 4);
+        entry.writeUInt8(sound.name.length, 8);
+        entry.write(sound.name, 9, 'ascii');
+
+        return entry;
+    }));
+    const header = Buffer.alloc(HEADER_BYTES);
+
+    header.writeUInt32LE(MAGIC, 0);
+    header.writeUInt16LE(VERSION, 4);
+    header.writeUInt16LE(sounds.length, 6);
+    header.writeUInt32LE(sampleRate, 8);
+    header.writeUInt32LE(HEADER_BYTES + table.length, 12);
+
+    return { sounds, binary: Buffer.concat([header, table, ...sounds.flatMap((sound) => sound.frames)]) };
+}
+
+function main(args) {
+    const [source, output] = args;
+
+    if (!source || !output) {
+        throw new Error('Usage: node scripts/pack-sounds.mjs <source dir> <output dir>');
+    }
+
+    fs.mkdirSync(output, { recursive: true });
+
+    for (const bank of fs.readdirSync(source, { withFileTypes: true }).filter((entry) => entry.isDirectory())) {
+        const { sounds, binary } = pack(path.join(source, bank.name));
+
+        if (sounds.length === 0) {
+            continue;
+        }
+
+        fs.writeFileSync(path.join(output, `${bank.name}.bank`), binary);
+
+        console.log(`${bank.name}: ${sounds.length} sounds, ${(sounds.reduce((sum, sound) => sum + sound.samples, 0) / sounds[0].sampleRate).toFixed(1)}s, ${binary.byteLength} bytes`);
+    }
+}
+
+main(process.argv.slice(2));
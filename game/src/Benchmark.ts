@@ -0,0 +1,129 @@
+import CommandRecorder from './engine/CommandRecorder';
+import Engine from './engine/Engine';
+import createRandom from './engine/Random';
+import StressScenes from './engine/StressScenes';
+import type { Subsystem } from './engine/StressScenes';
+
+interface BenchmarkOptions {
+    scene: string;
+    seed: number;
+    frames: number;
+    warmup: number;
+    // Frames of gl calls to record from the start of the run, 0 to not record
+    capture: number;
+}
+
+interface Distribution {
+    mean: number;
+    p50: number;
+    p95: number;
+    p99: number;
+    max: number;
+}
+
+interface BenchmarkReport {
+    scene: string;
+    subsystem: Subsystem;
+    seed: number;
+    frames: number;
+    frameMs: Distribution;
+    cpuMs: Distribution;
+    gpuMs: Distribution;
+    drawCalls: number;
+    counters: Record<string, number>;
+}
+
+const distribution = (samples: Float64Array): Distribution => {
+    const sorted = samples.slice().sort();
+    const at = (p: number) => sorted[Math.min(sorted.length - 1, Math.floor(p * sorted.length))];
+    let sum = 0;
+
+    for (const sample of sorted) {
+        sum += sample;
+    }
+
+    return { mean: sum / sorted.length, p50: at(0.5), p95: at(0.95), p99: at(0.99), max: sorted[sorted.length - 1] };
+};
+
+// Runs one stress scene straight on the engine, without the menu or the game layer
+class Benchmark {
+    public static run(canvas: HTMLCanvasElement, options: BenchmarkOptions): Promise<BenchmarkReport> {
+        const create = StressScenes[options.scene];
+
+        if (!create) {
+            throw new Error(`Unknown Stress Scene '${options.scene}', Expected one of ${Object.keys(StressScenes).join(', ')}.`);
+        }
+
+        const gl = canvas.getContext('webgl2');
+
+        if (!gl) {
+            throw new Error('WebGL is Not Supported in your Browser or System, Could be due to mofiying the Runtime.');
+        }
+
+        let recorder = options.capture > 0 ? new CommandRecorder(gl, options.capture) : null;
+        const engine = new Engine(gl);
+        const scene = create();
+        const frameMs = new Float64Array(options.frames);
+        const cpuMs = new Float64Array(options.frames);
+        const gpuMs = new Float64Array(options.frames);
+        let drawCalls = 0;
+        let frame = -options.warmup;
+
+        scene.setup(engine, createRandom(options.seed));
+
+        return new Promise((resolve, reject) => {
+            // An error in a frame fails the run right away, instead of the runner waiting out its timeout
+            const tick = (time: number) => {
+                try {
+                    const start = performance.now();
+
+                    scene.update(engine, time);
+                    engine.frame(time);
+
+                    const capture = recorder?.endFrame();
+
+                    if (capture) {
+                        window.api.saveTelemetry(`capture-${options.scene}-${options.seed}.glcap`, capture);
+                        recorder = null;
+                    }
+
+                    if (frame >= 0) {
+                        frameMs[frame] = engine.frameTime;
+                        cpuMs[frame] = performance.now() - start;
+                        gpuMs[frame] = engine.gpuTime;
+                        drawCalls += engine.drawCalls;
+                    }
+
+                    if (++frame < options.frames) {
+                        requestAnimationFrame(tick);
+
+                        return;
+                    }
+
+                    const report: BenchmarkReport = {
+                        scene: options.scene,
+                        subsystem: scene.subsystem,
+                        seed: options.seed,
+                        frames: options.frames,
+                        frameMs: distribution(frameMs),
+                        cpuMs: distribution(cpuMs),
+                        gpuMs: distribution(gpuMs),
+                        drawCalls: drawCalls / options.frames,
+                        counters: scene.counters()
+                    };
+
+                    scene.dispose(engine);
+                    engine.dispose();
+                    resolve(report);
+                } catch (error) {
+                    reject(error);
+                }
+            };
+
+            requestAnimationFrame(tick);
+        });
+    }
+}
+
+export type { BenchmarkOptions, BenchmarkReport };
+export default Benchmark;
@@ -1,9 +1,46 @@
+import { toImageData } from './engine/AsyncReadback';
+import CommandRecorder from './engine/CommandRecorder';
+import Engine from './engine/Engine';
+import { Priority } from './engine/FrameBudget';
+import Hud from './Hud';
+import PerfHeatmap, { HeatmapOverlay } from './engine/PerfHeatmap';
+import ResourceScope from './engine/ResourceScope';
+import Simulation from './engine/Simulation';
+import SoundBank from './engine/SoundBank';
+import StaticNoise from './engine/StaticNoise';
+import type { ScopeReport } from './engine/ResourceScope';
+
+const TELEMETRY_INTERVAL = 30000;
+const LOOK_SENSITIVITY = 0.0025;
+const FIRST_LEVEL = 'hallway';
+const EXTRAPOLATION_MODES = ['off', 'auto', 'always'] as const;
+// Milliseconds, a stretch of bad signal drops out over and over but should only scare once
+const STINGER_COOLDOWN = 30000;
+
 class Game {
     private canvas: HTMLCanvasElement;
     private gl: WebGL2RenderingContext;
+    private engine: Engine;
+    private session: string = `heatmap-${Date.now()}.bin`;
+    private markStarted: () => void = () => {};
+    private recorder: CommandRecorder | null = null;
+    private hud: Hud | null = null;
+    private staticNoise: StaticNoise | null = null;
+    private stingers: SoundBank | null = null;
+    private lastStinger: number = 0;
+    private lastDropout: number = 0;
+    private lastTelemetry: number = performance.now();
 
-    constructor(canvas: HTMLCanvasElement) {
+    // Resolves once the first frame has been submitted
+    public readonly started: Promise<void>;
+
+    // menu is the scope of the screen that launched the game, it is released once gameplay starts
+    // capture records the first frames' gl calls to a replayable file, see CommandRecorder
+    constructor(canvas: HTMLCanvasElement, menu: ResourceScope = new ResourceScope('menu'), capture: number = 0) {
         this.canvas = canvas;
+        this.started = new Promise((resolve) => {
+            this.markStarted = resolve;
+        });
 
         this.gl = this.canvas.getContext('webgl2') as WebGL2RenderingContext;
 
@@ -11,20 +48,231 @@ class Game {
             throw new Error('WebGL is Not Supported in your Browser or System, Could be due to mofiying the Runtime.');
         }
 
+        if (capture > 0) {
+            this.recorder = new CommandRecorder(this.gl, capture);
+        }
+
+        this.engine = new Engine(this.gl, menu);
+        this.engine.simulation = new Simulation();
+        this.reportTransition(this.engine.enterState('gameplay'));
+
+        // Rendering starts right away, the level's simulation and lights join once it has loaded
+        this.engine.loadLevel(FIRST_LEVEL).catch((error: Error) => {
+            console.error(`could not load level ${FIRST_LEVEL} (${error.message}), run npm run levels`);
+        });
+
         this.init();
         this.loop();
     }
 
     public init(): void {
         // This is Ran Once
+        // Serialising the heatmap is cheap enough to wait for a frame that has time left
+        this.engine.budget.register('telemetry', Priority.low, 2, () => {
+            if (performance.now() - this.lastTelemetry >= TELEMETRY_INTERVAL) {
+                this.lastTelemetry = performance.now();
+                this.saveTelemetry();
+            }
+        }, 120);
+
+        document.addEventListener('visibilitychange', () => {
+            if (document.visibilityState === 'hidden') {
+                this.saveTelemetry();
+            }
+        });
+
+        this.canvas.addEventListener('click', () => {
+            this.canvas.requestPointerLock();
+            this.startAudio().catch((error: Error) => {
+                console.warn(`audio did not start (${error.message}), the next click tries again`);
+            });
+        });
+
+        document.addEventListener('mousemove', (event) => {
+            if (document.pointerLockElement !== this.canvas) {
+                return;
+            }
+
+            const camera = this.engine.camera;
+
+            camera.yaw -= event.movementX * LOOK_SENSITIVITY;
+            camera.pitch = Math.max(-1.5, Math.min(1.5, camera.pitch - event.movementY * LOOK_SENSITIVITY));
+            this.engine.latency.input(event.timeStamp);
+        });
+
+        window.api.isdev().then((isDev) => {
+            if (isDev) {
+                this.hud = new Hud(this.engine);
+                this.engine.budget.register('hud', Priority.low, 0.5, () => this.hud!.update(performance.now()));
+
+                window.addEventListener('keydown', (event) => {
+                    if (event.code === 'F2') {
+                        this.hud!.visible = !this.hud!.visible;
+                    } else if (event.code === 'F3') {
+                        this.toggleHeatmap();
+                    } else if (event.code === 'F4') {
+                        this.cycleExtrapolation();
+                    } else if (event.code === 'F6') {
+                        this.toggleMultiResolution();
+                    } else if (event.code === 'F7') {
+                        this.engine.autoExposure.enabled = !this.engine.autoExposure.enabled;
+                    } else if (event.code === 'F8' && event.shiftKey) {
+                        this.cyclePrepass();
+                    } else if (event.code === 'F8') {
+                        this.engine.prepass.view = !this.engine.prepass.view;
+                    } else if (event.code === 'F9') {
+                        this.saveScreenshot();
+                    }
+                });
+            }
+        });
+    }
+
+    public loop(): void {
+        // this ran every frame after init, a blocking while loop would never let the browser present
+        const frame = (time: number) => {
+            this.engine.frame(time);
+            this.staticNoise?.update(this.engine.post.staticNoise);
+            this.playStinger(time);
+            this.markStarted();
+
+            const capture = this.recorder?.endFrame();
+
+            if (capture) {
+                window.api.saveTelemetry(`capture-${Date.now()}.glcap`, capture);
+                this.recorder = null;
+            }
+
+            requestAnimationFrame(frame);
+        };
+
+        requestAnimationFrame(frame);
+    }
+
+    // Browsers only start audio from a user gesture, the first click that locks the pointer and any after a failed start
+    private async startAudio(): Promise<void> {
+        if (this.engine.audio) {
+            return;
+        }
+
+        const audio = new AudioContext();
+
+        this.engine.audio = audio;
+
+        try {
+            this.staticNoise = await StaticNoise.create(audio, this.engine.simulation?.seed ?? 1);
+        } catch (error) {
+            // Without the worklet there is nothing to play, a later click starts over with a fresh context
+            this.engine.audio = null;
+            audio.close();
+            throw error;
+        }
+
+        // Built by npm run sounds, the game plays on without stingers before the first build
+        SoundBank.load(audio, '/sounds/stingers.bank').then((bank) => {
+            this.stingers = bank;
+        }, (error: Error) => {
+            console.info(`stingers unavailable (${error.message})`);
+        });
+    }
+
+    // The picture and the hiss cutting out is the scare, the stinger lands on the first frame of it
+    private playStinger(time: number): void {
+        const dropout = this.engine.post.staticNoise.dropout;
+
+        if (this.stingers && dropout > 0 && this.lastDropout === 0 && time - this.lastStinger > STINGER_COOLDOWN) {
+            this.stingers.play('jumpscare');
+            this.lastStinger = time;
+        }
+
+        this.lastDropout = dropout;
+    }
+
+    private saveTelemetry(): Promise<void> {
+        return window.api.saveTelemetry(this.session, this.engine.heatmap.serialize());
+    }
+
+    // Dev toggle, logs the input latency of full and reprojected frames measured in the previous mode
+    private cycleExtrapolation(): void {
+        const extrapolator = this.engine.extrapolator;
+        const next = EXTRAPOLATION_MODES[(EXTRAPOLATION_MODES.indexOf(extrapolator.mode) + 1) % EXTRAPOLATION_MODES.length];
+
+        console.info(`extrapolation ${extrapolator.mode} -> ${next}`, {
+            full: this.engine.latency.summary(0),
+            reprojected: this.engine.latency.summary(1)
+        });
+
+        extrapolator.mode = next;
+    }
+
+    private async reportTransition(report: ScopeReport): Promise<void> {
+        if (await window.api.isdev()) {
+            const kinds = Object.entries(report.bytes).filter(([, bytes]) => bytes > 0).map(([kind, bytes]) => `${kind} ${(bytes / 1048576).toFixed(2)}MB`);
+
+            console.info(`released ${report.scope}: ${report.resources} resources, ${(report.total / 1048576).toFixed(2)}MB in ${report.releaseMs.toFixed(1)}ms`, kinds.join(', '));
+        }
+    }
+
+    // The readback never stalls the frame, the file is written a few frames later
+    private async saveScreenshot(): Promise<void> {
+        const image = toImageData(await this.engine.screenshot());
+        const canvas = new OffscreenCanvas(image.width, image.height);
+
+        canvas.getContext('2d')!.putImageData(image, 0, 0);
+
+        const png = await canvas.convertToBlob({ type: 'image/png' });
+
+        await window.api.saveTelemetry(`screenshot-${Date.now()}.png`, await png.arrayBuffer());
     }
 
-    public loop(): never {
-        // this ran every frame after init
-        while (true) {
-            // Code here
+    private toggleMultiResolution(): void {
+        const multiResolution = this.engine.multiResolution;
+        const savings = multiResolution.savings(this.engine.post.vignette);
+
+        // Two geometry passes and a resolve only pay off when the periphery sheds more than that costs
+        if (!multiResolution.enabled && savings <= 0) {
+            console.warn('multi-resolution stays off, the vignette is too light for a low resolution periphery', { shadedPixelsSaved: savings });
+
+            return;
+        }
+
+        multiResolution.enabled = !multiResolution.enabled;
+        console.info(`multi-resolution ${multiResolution.enabled ? 'on' : 'off'}`, {
+            shadedPixelsSaved: savings,
+            gpuTime: this.engine.gpuTime
+        });
+    }
+
+    private cyclePrepass(): void {
+        const prepass = this.engine.prepass;
+        const modes = ['auto', 'on', 'off'] as const;
+
+        prepass.mode = modes[(modes.indexOf(prepass.mode) + 1) % modes.length];
+        console.info(`depth prepass ${prepass.mode}`, { active: prepass.active, overdraw: prepass.overdraw, gpuTime: this.engine.gpuTime });
+    }
+
+    // Dev view, shows every recorded session merged with the current one
+    private async toggleHeatmap(): Promise<void> {
+        if (this.engine.heatmapOverlay) {
+            this.engine.heatmapOverlay.dispose();
+            this.engine.heatmapOverlay = null;
+
+            return;
+        }
+
+        const merged = new PerfHeatmap(this.engine.heatmap.cellSize, this.engine.heatmap.sectors);
+
+        await this.saveTelemetry();
+
+        for (const file of await window.api.loadTelemetry('heatmap-')) {
+            merged.merge(file.buffer.slice(file.byteOffset, file.byteOffset + file.byteLength) as ArrayBuffer);
         }
+
+        const overlay = new HeatmapOverlay(this.gl);
+
+        overlay.update(merged);
+        this.engine.heatmapOverlay = overlay;
     }
 }
 
-export default Game;
\ No newline at end of file
+export default Game;
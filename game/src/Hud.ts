@@ -0,0 +1,66 @@
+import type Engine from './engine/Engine';
+
+const REFRESH_INTERVAL = 250;
+
+// Dev overlay with the engine's frame statistics, refreshed a few times a second to stay cheap
+class Hud {
+    public readonly element: HTMLPreElement;
+
+    private engine: Engine;
+    private lastRefresh: number = 0;
+    private frames: number = 0;
+    private frameTime: number = 0;
+
+    constructor(engine: Engine, parent: HTMLElement = document.body) {
+        this.engine = engine;
+        this.element = document.createElement('pre');
+        this.element.className = 'hud';
+        // Hidden until F2, like the other dev overlays
+        this.element.style.display = 'none';
+        parent.appendChild(this.element);
+    }
+
+    public get visible(): boolean {
+        return this.element.style.display !== 'none';
+    }
+
+    public set visible(visible: boolean) {
+        this.element.style.display = visible ? '' : 'none';
+    }
+
+    public update(time: number): void {
+        const engine = this.engine;
+
+        this.frames++;
+        this.frameTime += engine.frameTime;
+
+        if (!this.visible || time - this.lastRefresh < REFRESH_INTERVAL) {
+            return;
+        }
+
+        const frameMs = this.frameTime / Math.max(1, this.frames);
+        const streams = engine.streams.stats;
+        const prepass = engine.prepass;
+        const budget = engine.budget.stats;
+
+        this.element.textContent = [
+            `frame   ${frameMs.toFixed(2)}ms (${(1000 / Math.max(frameMs, 1e-3)).toFixed(0)} fps)`,
+            `gpu     ${engine.gpuTime.toFixed(2)}ms`,
+            `draws   ${engine.drawCalls}`,
+            `prepass ${prepass.mode}${prepass.active ? ' (active)' : ''}, overdraw ${prepass.overdraw.toFixed(2)}x`,
+            `stream  ${(streams.bytesThisFrame / 1024).toFixed(0)}KB/frame`,
+            `stalls  ${streams.avoidedStalls} avoided, ${streams.orphans} orphans, ${streams.grows} grows`,
+            `budget  ${budget.deferrals} deferred, ${budget.overruns} overruns`
+        ].join('\n');
+
+        this.lastRefresh = time;
+        this.frames = 0;
+        this.frameTime = 0;
+    }
+
+    public dispose(): void {
+        this.element.remove();
+    }
+}
+
+export default Hud;
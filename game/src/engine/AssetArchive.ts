@@ -0,0 +1,205 @@
+// Asset archive layout, written by scripts/pack-archive.mjs (keep both in sync)
+//
+// header   32 bytes  u32 magic 'SPAK', u16 version, u16 entry count, u32 block size, u32 block count, u32 data offset, rest reserved
+// blocks   12 bytes per block  u32 file offset, u32 stored bytes, u32 raw bytes (stored equal to raw means not compressed)
+// entries  per entry  u32 first block, u32 block count, u32 raw bytes, u8 name length, ascii name
+// data     block contents back to back, the blocks of an entry are contiguous
+import Lz4Pool from './Lz4';
+
+const MAGIC = 0x4b415053; // 'SPAK'
+const VERSION = 1;
+const HEADER_BYTES = 32;
+const BLOCK_ENTRY_BYTES = 12;
+
+interface ArchiveEntry {
+    firstBlock: number;
+    blockCount: number;
+    rawBytes: number;
+    // Bytes read from disk for the whole entry
+    storedBytes: number;
+}
+
+interface ArchiveFile {
+    name: string;
+    blockSize: number;
+    blocks: Uint32Array;
+    entries: Map<string, ArchiveEntry>;
+    dataOffset: number;
+    dataBytes: number;
+}
+
+// Reads go through the main process, which reads the file at an offset instead of loading all of it
+const readFile = async (name: string, offset: number, length: number): Promise<Uint8Array> => {
+    const bytes = await window.api.readAsset(name, offset, length);
+
+    if (bytes.byteLength !== length) {
+        throw new Error(`Asset Archive ${name} is Truncated.`);
+    }
+
+    return bytes;
+};
+
+// Every asset is packed twice, raw and LZ4 compressed, and each read picks whichever arrives sooner
+//
+// Disk throughput is measured on every read and decode throughput on every block, so a slow disk
+// (HDD, network home directory) moves reads to the compressed copy and a fast one keeps them raw.
+class AssetArchive {
+    // Measured, bytes per millisecond
+    public diskBytesPerMs: number = 0;
+    public rawReads: number = 0;
+    public compressedReads: number = 0;
+
+    private raw: ArchiveFile;
+    private compressed: ArchiveFile;
+    private pool: Lz4Pool;
+
+    constructor(raw: ArchiveFile, compressed: ArchiveFile, pool: Lz4Pool) {
+        this.raw = raw;
+        this.compressed = compressed;
+        this.pool = pool;
+    }
+
+    // Opens <name>.pak and <name>.lz4.pak and probes the disk with one block
+    public static async open(name: string): Promise<AssetArchive> {
+        const [raw, compressed, pool] = await Promise.all([
+            AssetArchive.openFile(`${name}.pak`),
+            AssetArchive.openFile(`${name}.lz4.pak`),
+            Lz4Pool.create()
+        ]);
+        const archive = new AssetArchive(raw, compressed, pool);
+
+        await archive.timedRead(raw.name, raw.dataOffset, Math.min(raw.dataBytes, raw.blockSize));
+
+        return archive;
+    }
+
+    private static async openFile(name: string): Promise<ArchiveFile> {
+        const header = new DataView((await readFile(name, 0, HEADER_BYTES)).slice().buffer);
+
+        if (header.getUint32(0, true) !== MAGIC) {
+            throw new Error(`${name} is Not an Asset Archive.`);
+        }
+
+        if (header.getUint16(4, true) !== VERSION) {
+            throw new Error(`Asset Archive Version ${header.getUint16(4, true)} is not Supported, Expected ${VERSION}.`);
+        }
+
+        const entryCount = header.getUint16(6, true);
+        const blockCount = header.getUint32(12, true);
+        const dataOffset = header.getUint32(16, true);
+        const tables = (await readFile(name, HEADER_BYTES, dataOffset - HEADER_BYTES)).slice();
+        const blocks = new Uint32Array(tables.buffer, 0, blockCount * BLOCK_ENTRY_BYTES / 4);
+        const view = new DataView(tables.buffer);
+        const entries = new Map<string, ArchiveEntry>();
+        let at = blocks.byteLength;
+        let dataBytes = 0;
+
+        for (let i = 0; i < blockCount; i++) {
+            dataBytes += blocks[i * 3 + 1];
+        }
+
+        for (let i = 0; i < entryCount; i++) {
+            const firstBlock = view.getUint32(at, true);
+            const count = view.getUint32(at + 4, true);
+            const length = view.getUint8(at + 12);
+            let storedBytes = 0;
+
+            for (let block = firstBlock; block < firstBlock + count; block++) {
+                storedBytes += blocks[block * 3 + 1];
+            }
+
+            entries.set(String.fromCharCode(...tables.subarray(at + 13, at + 13 + length)), {
+                firstBlock, blockCount: count, rawBytes: view.getUint32(at + 8, true), storedBytes
+            });
+            at += 13 + length;
+        }
+
+        return { name, blockSize: header.getUint32(8, true), blocks, entries, dataOffset, dataBytes };
+    }
+
+    public has(name: string): boolean {
+        return this.raw.entries.has(name);
+    }
+
+    // Over shared memory when the page is cross origin isolated, the decoders then write into it directly
+    // The view starts at offset 0 and ends at the asset's last byte, whatever the buffer behind it holds
+    public async read(name: string): Promise<Uint8Array> {
+        const raw = this.raw.entries.get(name);
+        const compressed = this.compressed.entries.get(name);
+
+        if (!raw || !compressed) {
+            throw new Error(`Asset '${name}' is Not in the Archive.`);
+        }
+
+        const rawMs = raw.storedBytes / this.diskBytesPerMs;
+        const compressedMs = compressed.storedBytes / this.diskBytesPerMs + raw.rawBytes / (this.pool.bytesPerMs * Math.min(this.pool.size, compressed.blockCount));
+
+        if (compressedMs < rawMs) {
+            this.compressedReads++;
+
+            return this.readCompressed(compressed);
+        }
+
+        this.rawReads++;
+
+        const bytes = await this.readEntry(this.raw, raw);
+
+        return bytes.byteOffset === 0 ? bytes : bytes.slice();
+    }
+
+    public dispose(): void {
+        this.pool.dispose();
+    }
+
+    private async readCompressed(entry: ArchiveEntry): Promise<Uint8Array> {
+        const bytes = await this.readEntry(this.compressed, entry);
+        const target = this.pool.createTarget(entry.rawBytes, this.compressed.blockSize);
+        const destination = target ? target.memory.buffer : new ArrayBuffer(entry.rawBytes);
+        const blocks = this.compressed.blocks;
+        const start = blocks[entry.firstBlock * 3];
+        const decodes: Promise<void>[] = [];
+        let offset = 0;
+
+        for (let block = entry.firstBlock; block < entry.firstBlock + entry.blockCount; block++) {
+            const source = bytes.subarray(blocks[block * 3] - start, blocks[block * 3] - start + blocks[block * 3 + 1]);
+            const rawBytes = blocks[block * 3 + 2];
+
+            if (source.byteLength === rawBytes) {
+                new Uint8Array(destination, offset, rawBytes).set(source);
+            } else {
+                decodes.push(this.pool.decode(source, rawBytes, target ?? destination, offset));
+            }
+
+            offset += rawBytes;
+        }
+
+        await Promise.all(decodes);
+
+        // The memory is padded to whole pages and holds the workers' scratch slots behind the asset
+        return new Uint8Array(destination, 0, entry.rawBytes);
+    }
+
+    private readEntry(file: ArchiveFile, entry: ArchiveEntry): Promise<Uint8Array> {
+        const offset = entry.blockCount > 0 ? file.blocks[entry.firstBlock * 3] : file.dataOffset;
+
+        return this.timedRead(file.name, offset, entry.storedBytes);
+    }
+
+    // Small reads are mostly latency, only reads of a block or more update the throughput
+    private async timedRead(name: string, offset: number, length: number): Promise<Uint8Array> {
+        const start = performance.now();
+        const bytes = await readFile(name, offset, length);
+        const rate = length / Math.max(0.01, performance.now() - start);
+
+        if (this.diskBytesPerMs === 0) {
+            this.diskBytesPerMs = rate;
+        } else if (length >= this.raw.blockSize) {
+            this.diskBytesPerMs += (rate - this.diskBytesPerMs) * 0.2;
+        }
+
+        return bytes;
+    }
+}
+
+export type { ArchiveEntry };
+export default AssetArchive;
@@ -0,0 +1,159 @@
+import type RenderTarget from './RenderTarget';
+
+interface Readback {
+    width: number;
+    height: number;
+    // Rows bottom up, as GL returns them
+    pixels: Uint8Array;
+}
+
+interface PackBuffer {
+    buffer: WebGLBuffer;
+    capacity: number;
+}
+
+interface PendingRead {
+    pack: PackBuffer;
+    sync: WebGLSync;
+    width: number;
+    height: number;
+    resolve: (readback: Readback) => void;
+    reject: (error: Error) => void;
+}
+
+// Reads pixels without stalling, the copy lands in a pixel pack buffer and is mapped once its fence has passed
+//
+// A plain readPixels into client memory waits for every queued command to finish. Here the GPU copies
+// into a buffer object in order with the rest of the frame and poll() picks the data up frames later.
+class AsyncReadback {
+    private gl: WebGL2RenderingContext;
+    private free: PackBuffer[] = [];
+    private pending: PendingRead[] = [];
+    private disposed: boolean = false;
+
+    constructor(gl: WebGL2RenderingContext) {
+        this.gl = gl;
+    }
+
+    public get inFlight(): number {
+        return this.pending.length;
+    }
+
+    // Reads RGBA8 from a colour attachment of target, or from the drawing buffer when target is null
+    public read(target: RenderTarget | null, x: number, y: number, width: number, height: number, attachment: number = 0): Promise<Readback> {
+        if (this.disposed) {
+            return Promise.reject(new Error('GPU Readback was Disposed.'));
+        }
+
+        const gl = this.gl;
+        const pack = this.acquire(width * height * 4);
+
+        gl.bindFramebuffer(gl.READ_FRAMEBUFFER, target ? target.framebuffer : null);
+        gl.readBuffer(target ? gl.COLOR_ATTACHMENT0 + attachment : gl.BACK);
+        gl.bindBuffer(gl.PIXEL_PACK_BUFFER, pack.buffer);
+        gl.readPixels(x, y, width, height, gl.RGBA, gl.UNSIGNED_BYTE, 0);
+        gl.bindBuffer(gl.PIXEL_PACK_BUFFER, null);
+        gl.bindFramebuffer(gl.READ_FRAMEBUFFER, null);
+
+        const sync = gl.fenceSync(gl.SYNC_GPU_COMMANDS_COMPLETE, 0)!;
+
+        // The fence has to reach the GPU or it never signals
+        gl.flush();
+
+        return new Promise((resolve, reject) => {
+            this.pending.push({ pack, sync, width, height, resolve, reject });
+        });
+    }
+
+    // Called once per frame, resolves every read whose fence has passed without waiting on the rest
+    // Past the deadline the remaining copies wait for the next poll, at least one is always taken
+    public poll(deadline: number = Infinity): void {
+        const gl = this.gl;
+        let copied = 0;
+
+        for (let i = 0; i < this.pending.length; i++) {
+            if (copied > 0 && performance.now() > deadline) {
+                break;
+            }
+
+            const read = this.pending[i];
+            const status = gl.clientWaitSync(read.sync, 0, 0);
+
+            if (status === gl.TIMEOUT_EXPIRED) {
+                continue;
+            }
+
+            this.pending.splice(i--, 1);
+            gl.deleteSync(read.sync);
+
+            if (status === gl.WAIT_FAILED) {
+                this.free.push(read.pack);
+                read.reject(new Error('GPU Readback Failed, the Context may have been Lost.'));
+
+                continue;
+            }
+
+            const pixels = new Uint8Array(read.width * read.height * 4);
+
+            gl.bindBuffer(gl.PIXEL_PACK_BUFFER, read.pack.buffer);
+            gl.getBufferSubData(gl.PIXEL_PACK_BUFFER, 0, pixels);
+            gl.bindBuffer(gl.PIXEL_PACK_BUFFER, null);
+
+            this.free.push(read.pack);
+            copied++;
+            read.resolve({ width: read.width, height: read.height, pixels });
+        }
+    }
+
+    public dispose(): void {
+        // Nothing polls after this, callers waiting on a read would never hear back otherwise
+        for (const read of this.pending) {
+            this.gl.deleteSync(read.sync);
+            this.gl.deleteBuffer(read.pack.buffer);
+            read.reject(new Error('GPU Readback was Disposed.'));
+        }
+
+        for (const { buffer } of this.free) {
+            this.gl.deleteBuffer(buffer);
+        }
+
+        this.pending = [];
+        this.free = [];
+        this.disposed = true;
+    }
+
+    // Buffers are reused by size, reads of the same kind (histograms, thumbnails) keep hitting the same one
+    private acquire(bytes: number): PackBuffer {
+        const gl = this.gl;
+        const index = this.free.findIndex((entry) => entry.capacity >= bytes);
+
+        if (index >= 0) {
+            return this.free.splice(index, 1)[0];
+        }
+
+        const buffer = gl.createBuffer();
+
+        gl.bindBuffer(gl.PIXEL_PACK_BUFFER, buffer);
+        gl.bufferData(gl.PIXEL_PACK_BUFFER, bytes, gl.STREAM_READ);
+        gl.bindBuffer(gl.PIXEL_PACK_BUFFER, null);
+
+        return { buffer, capacity: bytes };
+    }
+}
+
+// Flips rows into top down order, for images and files
+const toImageData = (readback: Readback): ImageData => {
+    const { width, height, pixels } = readback;
+    const image = new ImageData(width, height);
+    const row = width * 4;
+
+    for (let y = 0; y < height; y++) {
+        image.data.set(pixels.subarray((height - 1 - y) * row, (height - y) * row), y * row);
+    }
+
+    return image;
+};
+
+export type { Readback };
+export { toImageData };
+export default AsyncReadback;
@@ -0,0 +1,147 @@
+import type AsyncReadback from './AsyncReadback';
+import RenderTarget from './RenderTarget';
+import Shader from './Shader';
+
+// Luminance is measured on a small grid, read back a few frames later and turned into a histogram on the CPU
+const GRID = 64;
+const BINS = 64;
+// log2 luminance range the histogram covers
+const MIN_LOG = -10;
+const MAX_LOG = 0;
+
+const LUMINANCE_FRAGMENT = `#version 300 es
+precision highp float;
+
+in vec2 uv;
+
+uniform sampler2D scene;
+uniform vec2 footprint;
+
+out vec4 outColor;
+
+void main() {
+    float sum = 0.0;
+
+    // 4x4 taps spread over the scene pixels this texel covers
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            vec3 color = texture(scene, uv + (vec2(x, y) - 1.5) * footprint * 0.25).rgb;
+            sum += log2(dot(color, vec3(0.2126, 0.7152, 0.0722)) + 1e-4);
+        }
+    }
+
+    outColor = vec4(clamp((sum / 16.0 + ${(-MIN_LOG).toFixed(1)}) / ${(MAX_LOG - MIN_LOG).toFixed(1)}, 0.0, 1.0), 0.0, 0.0, 1.0);
+}`;
+
+// Drives PostChain.exposure from a luminance histogram of the scene, without ever waiting on the GPU
+class AutoExposure {
+    public enabled: boolean = false;
+    // Middle grey the average luminance is mapped to
+    public key: number = 0.18;
+    public minExposure: number = 0.5;
+    public maxExposure: number = 4;
+    // Darkest and brightest fractions of the histogram are ignored, e.g. the sky or a light source
+    public lowPercentile: number = 0.1;
+    public highPercentile: number = 0.95;
+    // Adaptation rate per second
+    public speed: number = 1.5;
+    public readonly histogram: Uint32Array = new Uint32Array(BINS);
+    public exposure: number = 1;
+
+    private gl: WebGL2RenderingContext;
+    private target: RenderTarget;
+    private shader: Shader;
+    private emptyVao: WebGLVertexArrayObject;
+    private targetExposure: number = 1;
+    private measuring: boolean = false;
+
+    constructor(gl: WebGL2RenderingContext) {
+        this.gl = gl;
+        this.target = new RenderTarget(gl, [gl.RGBA8], false, gl.NEAREST);
+        this.shader = new Shader(gl, Shader.FULLSCREEN_VERTEX, LUMINANCE_FRAGMENT);
+        this.emptyVao = gl.createVertexArray();
+    }
+
+    // Starts a measurement unless one is still in flight, then steps the exposure towards the latest result
+    public update(scene: RenderTarget, readback: AsyncReadback, frameTime: number): number {
+        if (!this.enabled) {
+            this.exposure = 1;
+
+            return this.exposure;
+        }
+
+        if (!this.measuring) {
+            this.measure(scene, readback);
+        }
+
+        this.exposure += (this.targetExposure - this.exposure) * (1 - Math.exp(-this.speed * frameTime / 1000));
+
+        return this.exposure;
+    }
+
+    public dispose(): void {
+        this.target.dispose();
+        this.shader.dispose();
+        this.gl.deleteVertexArray(this.emptyVao);
+    }
+
+    private measure(scene: RenderTarget, readback: AsyncReadback): void {
+        const gl = this.gl;
+        const shader = this.shader;
+
+        this.target.resize(GRID, GRID);
+        this.target.bind();
+
+        gl.disable(gl.DEPTH_TEST);
+        gl.bindVertexArray(this.emptyVao);
+        shader.use();
+        gl.activeTexture(gl.TEXTURE0);
+        gl.bindTexture(gl.TEXTURE_2D, scene.texture);
+        gl.uniform1i(shader.uniform('scene'), 0);
+        gl.uniform2f(shader.uniform('footprint'), 1 / GRID, 1 / GRID);
+        gl.drawArrays(gl.TRIANGLES, 0, 3);
+        gl.bindVertexArray(null);
+        gl.enable(gl.DEPTH_TEST);
+
+        this.measuring = true;
+
+        readback.read(this.target, 0, 0, GRID, GRID).then((result) => {
+            this.measuring = false;
+            this.targetExposure = this.evaluate(result.pixels);
+        }, () => {
+            this.measuring = false;
+        });
+    }
+
+    private evaluate(pixels: Uint8Array): number {
+        const histogram = this.histogram;
+        const total = GRID * GRID;
+
+        histogram.fill(0);
+
+        for (let i = 0; i < total; i++) {
+            histogram[Math.min(BINS - 1, pixels[i * 4] * BINS >> 8)]++;
+        }
+
+        // Mean log luminance of the samples between the two percentiles
+        const low = total * this.lowPercentile;
+        const high = total * this.highPercentile;
+        let seen = 0;
+        let sum = 0;
+        let count = 0;
+
+        for (let bin = 0; bin < BINS; bin++) {
+            const take = Math.max(0, Math.min(seen + histogram[bin], high) - Math.max(seen, low));
+
+            sum += take * (MIN_LOG + (bin + 0.5) / BINS * (MAX_LOG - MIN_LOG));
+            count += take;
+            seen += histogram[bin];
+        }
+
+        const average = count > 0 ? Math.pow(2, sum / count) : this.key;
+
+        return Math.min(this.maxExposure, Math.max(this.minExposure, this.key / average));
+    }
+}
+
+export default AutoExposure;
@@ -0,0 +1,117 @@
+// yaw 0 looks down -Z, positive pitch looks up
+class Camera {
+    public readonly position: Float32Array = new Float32Array(3);
+    public yaw: number = 0;
+    public pitch: number = 0;
+    public fov: number = Math.PI / 3;
+    public near: number = 0.1;
+    public far: number = 200;
+
+    public readonly view: Float32Array = new Float32Array(16);
+    public readonly projection: Float32Array = new Float32Array(16);
+    public readonly viewProjection: Float32Array = new Float32Array(16);
+    public readonly inverseViewProjection: Float32Array = new Float32Array(16);
+    // Last frame's viewProjection, for reprojection and camera velocity
+    public readonly previousViewProjection: Float32Array = new Float32Array(16);
+
+    private initialized: boolean = false;
+
+    public update(aspect: number): void {
+        const f = 1 / Math.tan(this.fov / 2);
+        const range = 1 / (this.near - this.far);
+        const p = this.projection;
+
+        p.fill(0);
+        p[0] = f / aspect;
+        p[5] = f;
+        p[10] = (this.far + this.near) * range;
+        p[11] = -1;
+        p[14] = 2 * this.far * this.near * range;
+
+        // Inverse of translate(position) * rotateY(yaw) * rotateX(pitch)
+        const cy = Math.cos(this.yaw);
+        const sy = Math.sin(this.yaw);
+        const cp = Math.cos(this.pitch);
+        const sp = Math.sin(this.pitch);
+        const [x, y, z] = this.position;
+        const v = this.view;
+
+        v[0] = cy; v[1] = sy * sp; v[2] = sy * cp; v[3] = 0;
+        v[4] = 0; v[5] = cp; v[6] = -sp; v[7] = 0;
+        v[8] = -sy; v[9] = cy * sp; v[10] = cy * cp; v[11] = 0;
+        v[12] = -(v[0] * x + v[4] * y + v[8] * z);
+        v[13] = -(v[1] * x + v[5] * y + v[9] * z);
+        v[14] = -(v[2] * x + v[6] * y + v[10] * z);
+        v[15] = 1;
+
+        this.previousViewProjection.set(this.viewProjection);
+        Camera.multiply(this.viewProjection, p, v);
+        Camera.invert(this.inverseViewProjection, this.viewProjection);
+
+        if (!this.initialized) {
+            this.previousViewProjection.set(this.viewProjection);
+            this.initialized = true;
+        }
+    }
+
+    public static multiply(out: Float32Array, a: Float32Array, b: Float32Array): Float32Array {
+        for (let col = 0; col < 4; col++) {
+            const b0 = b[col * 4];
+            const b1 = b[col * 4 + 1];
+            const b2 = b[col * 4 + 2];
+            const b3 = b[col * 4 + 3];
+
+            for (let row = 0; row < 4; row++) {
+                out[col * 4 + row] = a[row] * b0 + a[4 + row] * b1 + a[8 + row] * b2 + a[12 + row] * b3;
+            }
+        }
+
+        return out;
+    }
+
+    public static invert(out: Float32Array, m: Float32Array): Float32Array {
+        const [a00, a01, a02, a03, a10, a11, a12, a13, a20, a21, a22, a23, a30, a31, a32, a33] = m;
+
+        const b00 = a00 * a11 - a01 * a10;
+        const b01 = a00 * a12 - a02 * a10;
+        const b02 = a00 * a13 - a03 * a10;
+        const b03 = a01 * a12 - a02 * a11;
+        const b04 = a01 * a13 - a03 * a11;
+        const b05 = a02 * a13 - a03 * a12;
+        const b06 = a20 * a31 - a21 * a30;
+        const b07 = a20 * a32 - a22 * a30;
+        const b08 = a20 * a33 - a23 * a30;
+        const b09 = a21 * a32 - a22 * a31;
+        const b10 = a21 * a33 - a23 * a31;
+        const b11 = a22 * a33 - a23 * a32;
+
+        const det = b00 * b11 - b01 * b10 + b02 * b09 + b03 * b08 - b04 * b07 + b05 * b06;
+
+        if (det === 0) {
+            return out.fill(0);
+        }
+
+        const inv = 1 / det;
+
+        out[0] = (a11 * b11 - a12 * b10 + a13 * b09) * inv;
+        out[1] = (a02 * b10 - a01 * b11 - a03 * b09) * inv;
+        out[2] = (a31 * b05 - a32 * b04 + a33 * b03) * inv;
+        out[3] = (a22 * b04 - a21 * b05 - a23 * b03) * inv;
+        out[4] = (a12 * b08 - a10 * b11 - a13 * b07) * inv;
+        out[5] = (a00 * b11 - a02 * b08 + a03 * b07) * inv;
+        out[6] = (a32 * b02 - a30 * b05 - a33 * b01) * inv;
+        out[7] = (a20 * b05 - a22 * b02 + a23 * b01) * inv;
+        out[8] = (a10 * b10 - a11 * b08 + a13 * b06) * inv;
+        out[9] = (a01 * b08 - a00 * b10 - a03 * b06) * inv;
+        out[10] = (a30 * b04 - a31 * b02 + a33 * b00) * inv;
+        out[11] = (a21 * b02 - a20 * b04 - a23 * b00) * inv;
+        out[12] = (a11 * b07 - a10 * b09 - a12 * b06) * inv;
+        out[13] = (a00 * b09 - a01 * b07 + a02 * b06) * inv;
+        out[14] = (a31 * b01 - a30 * b03 - a32 * b00) * inv;
+        out[15] = (a20 * b03 - a21 * b01 + a22 * b00) * inv;
+
+        return out;
+    }
+}
+
+export default Camera;
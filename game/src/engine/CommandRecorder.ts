@@ -0,0 +1,324 @@
+// Capture format 'GLCP' v1, little endian
+//
+// header   u32 magic, u16 version, u16 name count, u32 frames, u32 width, u32 height, u32 command bytes
+// names    u8 length + ascii, gl method names or 'EXTENSION.method'
+// commands u16 name (FRAME_END closes a frame), u8 argument count, u32 result object id (0 for none), arguments
+//
+// Every argument starts with a tag, see Tag. Objects the context hands out (buffers, programs,
+// uniform locations, ...) are numbered in creation order and referenced by that number.
+const MAGIC = 0x50434c47;
+const VERSION = 1;
+const HEADER_BYTES = 24;
+const FRAME_END = 0xffff;
+
+const Tag = {
+    Undefined: 0,
+    Null: 1,
+    False: 2,
+    True: 3,
+    Int: 4,
+    Float: 5,
+    Object: 6,
+    String: 7,
+    View: 8,
+    Numbers: 9,
+    Image: 10,
+    // String arrays, e.g. transformFeedbackVaryings names
+    Strings: 11,
+    // Integers past the i32 range, masks and 0xffffffff sentinels
+    Uint: 12
+} as const;
+
+// Constructor order is the view type code in the file
+const VIEW_TYPES = [Int8Array, Uint8Array, Uint8ClampedArray, Int16Array, Uint16Array, Int32Array, Uint32Array, Float32Array, Float64Array, DataView];
+
+// Queries only read state back, replaying them would time the readback and not the workload
+const SKIPPED = /^(get(?!Extension$|UniformLocation$)|is[A-Z]|checkFramebufferStatus$)/;
+
+class ByteWriter {
+    public length: number = 0;
+
+    private bytes: Uint8Array = new Uint8Array(1 << 20);
+    private view: DataView = new DataView(this.bytes.buffer);
+    private encoder: TextEncoder = new TextEncoder();
+
+    public u8(value: number): void {
+        this.reserve(1);
+        this.view.setUint8(this.length, value);
+        this.length += 1;
+    }
+
+    public u16(value: number): void {
+        this.reserve(2);
+        this.view.setUint16(this.length, value, true);
+        this.length += 2;
+    }
+
+    public u32(value: number): void {
+        this.reserve(4);
+        this.view.setUint32(this.length, value, true);
+        this.length += 4;
+    }
+
+    public i32(value: number): void {
+        this.reserve(4);
+        this.view.setInt32(this.length, value, true);
+        this.length += 4;
+    }
+
+    // GL converts every float argument to single precision, so nothing is lost here
+    public f32(value: number): void {
+        this.reserve(4);
+        this.view.setFloat32(this.length, value, true);
+        this.length += 4;
+    }
+
+    public raw(data: Uint8Array): void {
+        this.reserve(data.byteLength);
+        this.bytes.set(data, this.length);
+        this.length += data.byteLength;
+    }
+
+    public string(value: string): void {
+        const data = this.encoder.encode(value);
+
+        this.u32(data.byteLength);
+        this.raw(data);
+    }
+
+    public finish(): Uint8Array {
+        return this.bytes.subarray(0, this.length);
+    }
+
+    private reserve(bytes: number): void {
+        if (this.length + bytes <= this.bytes.byteLength) {
+            return;
+        }
+
+        const grown = new Uint8Array(Math.max(this.bytes.byteLength * 2, this.length + bytes));
+
+        grown.set(this.bytes.subarray(0, this.length));
+        this.bytes = grown;
+        this.view = new DataView(grown.buffer);
+    }
+}
+
+const isImageSource = (value: object): value is TexImageSource => {
+    return value instanceof ImageData || value instanceof ImageBitmap || value instanceof HTMLImageElement ||
+        value instanceof HTMLCanvasElement || value instanceof HTMLVideoElement || value instanceof OffscreenCanvas ||
+        value instanceof VideoFrame;
+};
+
+// Records every state changing gl call, with its arguments and uploaded data, until a frame limit is reached
+//
+// The wrappers are installed on the context instance, so every subsystem that already holds the
+// context is recorded. Resources created before the recorder was attached cannot be replayed, so it
+// has to be attached right after the context is created.
+class CommandRecorder {
+    public readonly limit: number;
+    public frames: number = 0;
+
+    private gl: WebGL2RenderingContext;
+    private commands: ByteWriter = new ByteWriter();
+    private names: Map<string, number> = new Map();
+    private ids: WeakMap<object, number> = new WeakMap();
+    private nextId: number = 1;
+    private patched: { target: object; name: string }[] = [];
+    private extensions: Set<object> = new Set();
+    private scratch: OffscreenCanvasRenderingContext2D | null = null;
+
+    constructor(gl: WebGL2RenderingContext, limit: number) {
+        this.gl = gl;
+        this.limit = limit;
+
+        this.patch(gl, WebGL2RenderingContext.prototype, '');
+    }
+
+    // Returns the capture once the frame limit is reached, the context is no longer recorded after that
+    public endFrame(): ArrayBuffer | null {
+        this.commands.u16(FRAME_END);
+        this.commands.u8(0);
+        this.commands.u32(0);
+
+        if (++this.frames < this.limit) {
+            return null;
+        }
+
+        return this.finish();
+    }
+
+    public finish(): ArrayBuffer {
+        for (const { target, name } of this.patched) {
+            delete (target as Record<string, unknown>)[name];
+        }
+
+        this.patched = [];
+        this.extensions.clear();
+
+        const header = new ByteWriter();
+        const commands = this.commands.finish();
+
+        header.u32(MAGIC);
+        header.u16(VERSION);
+        header.u16(this.names.size);
+        header.u32(this.frames);
+        header.u32(this.gl.drawingBufferWidth);
+        header.u32(this.gl.drawingBufferHeight);
+        header.u32(commands.byteLength);
+
+        for (const name of this.names.keys()) {
+            header.u8(name.length);
+
+            for (let i = 0; i < name.length; i++) {
+                header.u8(name.charCodeAt(i));
+            }
+        }
+
+        header.raw(commands);
+
+        return header.finish().slice().buffer;
+    }
+
+    private patch(target: object, prototype: object, prefix: string): void {
+        for (const name of Object.getOwnPropertyNames(prototype)) {
+            const descriptor = Object.getOwnPropertyDescriptor(prototype, name);
+
+            if (name === 'constructor' || !descriptor || typeof descriptor.value !== 'function' || SKIPPED.test(name)) {
+                continue;
+            }
+
+            const original = descriptor.value as (...args: unknown[]) => unknown;
+            const qualified = prefix + name;
+
+            Object.defineProperty(target, name, {
+                configurable: true,
+                writable: true,
+                value: (...args: unknown[]) => {
+                    const result = original.apply(target, args);
+
+                    this.record(qualified, args, result);
+
+                    // Extension entry points are recorded under the extension's name
+                    if (name === 'getExtension' && result && !this.extensions.has(result)) {
+                        this.extensions.add(result);
+                        this.patch(result, Object.getPrototypeOf(result), `${args[0] as string}.`);
+                    }
+
+                    return result;
+                }
+            });
+
+            this.patched.push({ target, name });
+        }
+    }
+
+    private record(name: string, args: unknown[], result: unknown): void {
+        const writer = this.commands;
+        let index = this.names.get(name);
+
+        if (index === undefined) {
+            index = this.names.size;
+            this.names.set(name, index);
+        }
+
+        writer.u16(index);
+        writer.u8(args.length);
+        writer.u32(typeof result === 'object' && result !== null ? this.idOf(result) : 0);
+
+        for (const arg of args) {
+            this.argument(arg);
+        }
+    }
+
+    private argument(arg: unknown): void {
+        const writer = this.commands;
+
+        if (arg === undefined) {
+            writer.u8(Tag.Undefined);
+        } else if (arg === null) {
+            writer.u8(Tag.Null);
+        } else if (typeof arg === 'boolean') {
+            writer.u8(arg ? Tag.True : Tag.False);
+        } else if (typeof arg === 'number') {
+            if (Number.isInteger(arg) && arg >= -0x80000000 && arg <= 0x7fffffff) {
+                writer.u8(Tag.Int);
+                writer.i32(arg);
+            } else if (Number.isInteger(arg) && arg > 0 && arg <= 0xffffffff) {
+                writer.u8(Tag.Uint);
+                writer.u32(arg);
+            } else {
+                writer.u8(Tag.Float);
+                writer.f32(arg);
+            }
+        } else if (typeof arg === 'string') {
+            writer.u8(Tag.String);
+            writer.string(arg);
+        } else if (ArrayBuffer.isView(arg) || arg instanceof ArrayBuffer) {
+            const view = arg instanceof ArrayBuffer ? new Uint8Array(arg) : arg;
+
+            writer.u8(Tag.View);
+            writer.u8(VIEW_TYPES.findIndex((type) => view instanceof type));
+            writer.u32(view.byteLength);
+            writer.raw(new Uint8Array(view.buffer, view.byteOffset, view.byteLength));
+        } else if (Array.isArray(arg) && arg.length > 0 && arg.every((value) => typeof value === 'string')) {
+            writer.u8(Tag.Strings);
+            writer.u32(arg.length);
+
+            for (const value of arg) {
+                writer.string(value);
+            }
+        } else if (Array.isArray(arg)) {
+            writer.u8(Tag.Numbers);
+            writer.u32(arg.length);
+
+            for (const value of arg) {
+                writer.f32(value);
+            }
+        } else if (typeof arg === 'object' && isImageSource(arg)) {
+            const pixels = this.pixels(arg);
+
+            writer.u8(Tag.Image);
+            writer.u32(pixels.width);
+            writer.u32(pixels.height);
+            writer.raw(new Uint8Array(pixels.data.buffer, pixels.data.byteOffset, pixels.data.byteLength));
+        } else {
+            writer.u8(Tag.Object);
+            writer.u32(this.idOf(arg as object));
+        }
+    }
+
+    private idOf(object: object): number {
+        let id = this.ids.get(object);
+
+        if (id === undefined) {
+            id = this.nextId++;
+            this.ids.set(object, id);
+        }
+
+        return id;
+    }
+
+    // Image sources are stored as their RGBA pixels, the replayer uploads them as ImageData
+    private pixels(source: TexImageSource): ImageData {
+        if (source instanceof ImageData) {
+            return source;
+        }
+
+        const width = source instanceof HTMLVideoElement ? source.videoWidth : source instanceof VideoFrame ? source.displayWidth : source.width;
+        const height = source instanceof HTMLVideoElement ? source.videoHeight : source instanceof VideoFrame ? source.displayHeight : source.height;
+
+        if (!this.scratch || this.scratch.canvas.width < width || this.scratch.canvas.height < height) {
+            this.scratch = new OffscreenCanvas(width, height).getContext('2d', { willReadFrequently: true });
+        }
+
+        const context = this.scratch!;
+
+        context.clearRect(0, 0, width, height);
+        context.drawImage(source, 0, 0);
+
+        return context.getImageData(0, 0, width, height);
+    }
+}
+
+export { MAGIC, VERSION, HEADER_BYTES, FRAME_END, Tag, VIEW_TYPES };
+export default CommandRecorder;
@@ -0,0 +1,364 @@
+import { FRAME_END, HEADER_BYTES, MAGIC, Tag, VERSION, VIEW_TYPES } from './CommandRecorder';
+
+// Object arguments are resolved when the command runs, the object is created by an earlier command
+class Ref {
+    public readonly id: number;
+
+    constructor(id: number) {
+        this.id = id;
+    }
+}
+
+interface Command {
+    name: number;
+    args: unknown[];
+    // Argument positions holding a Ref
+    refs: number[];
+    result: number;
+}
+
+interface CallTiming {
+    name: string;
+    calls: number;
+    cpuMs: number;
+}
+
+interface PassTiming {
+    frame: number;
+    // Framebuffer object id the pass rendered to, 'screen' for the default framebuffer
+    target: string;
+    calls: number;
+    cpuMs: number;
+    gpuMs: number;
+}
+
+interface ReplayReport {
+    frames: number;
+    width: number;
+    height: number;
+    frameCpuMs: number[];
+    calls: CallTiming[];
+    passes: PassTiming[];
+}
+
+const TIME_ELAPSED_EXT = 0x88bf;
+
+// Replays a capture made by CommandRecorder, one captured frame per animation frame
+//
+// A pass is every command between two framebuffer binds. The capture's own timer queries are
+// dropped because they would overlap the queries the replayer measures passes with.
+class CommandReplayer {
+    public readonly frames: number;
+    public readonly width: number;
+    public readonly height: number;
+    // Swaps shader sources as they are uploaded, to time an alternative variant of the same frames
+    public rewriteShader: ((source: string) => string) | null = null;
+
+    private gl: WebGL2RenderingContext;
+    private names: string[] = [];
+    private commands: Command[][] = [];
+    private functions: ((...args: unknown[]) => unknown)[] = [];
+    private objects: Map<number, unknown> = new Map();
+    private timer: { TIME_ELAPSED_EXT: number; GPU_DISJOINT_EXT: number } | null;
+
+    constructor(gl: WebGL2RenderingContext, buffer: ArrayBuffer) {
+        const header = new DataView(buffer);
+
+        if (buffer.byteLength < HEADER_BYTES || header.getUint32(0, true) !== MAGIC) {
+            throw new Error('Capture is Not a GL Command Capture.');
+        }
+
+        if (header.getUint16(4, true) !== VERSION) {
+            throw new Error(`Capture Version ${header.getUint16(4, true)} is not Supported, Expected ${VERSION}.`);
+        }
+
+        this.gl = gl;
+        this.frames = header.getUint32(8, true);
+        this.width = header.getUint32(12, true);
+        this.height = header.getUint32(16, true);
+        this.timer = gl.getExtension('EXT_disjoint_timer_query_webgl2');
+
+        let offset = HEADER_BYTES;
+
+        for (let i = header.getUint16(6, true); i > 0; i--) {
+            const length = header.getUint8(offset);
+
+            this.names.push(String.fromCharCode(...new Uint8Array(buffer, offset + 1, length)));
+            offset += 1 + length;
+        }
+
+        this.decode(buffer, offset, header.getUint32(20, true));
+    }
+
+    public run(): Promise<ReplayReport> {
+        const gl = this.gl;
+        const calls = this.names.map((name) => ({ name, calls: 0, cpuMs: 0 }));
+        const passes: PassTiming[] = [];
+        const queries: { pass: PassTiming; query: WebGLQuery }[] = [];
+        const frameCpuMs: number[] = [];
+        let frame = 0;
+
+        (gl.canvas as HTMLCanvasElement).width = this.width;
+        (gl.canvas as HTMLCanvasElement).height = this.height;
+
+        const beginPass = (target: string): PassTiming => {
+            const pass = { frame, target, calls: 0, cpuMs: 0, gpuMs: 0 };
+
+            passes.push(pass);
+
+            if (this.timer) {
+                const query = gl.createQuery();
+
+                gl.beginQuery(this.timer.TIME_ELAPSED_EXT, query);
+                queries.push({ pass, query });
+            }
+
+            return pass;
+        };
+
+        const endPass = (): void => {
+            if (this.timer) {
+                gl.endQuery(this.timer.TIME_ELAPSED_EXT);
+            }
+        };
+
+        return new Promise((resolve) => {
+            const tick = () => {
+                const frameStart = performance.now();
+                let pass = beginPass('screen');
+
+                for (const command of this.commands[frame]) {
+                    if (this.skipped(command)) {
+                        continue;
+                    }
+
+                    const name = this.names[command.name];
+                    const args = command.refs.length === 0 ? command.args : this.resolve(command);
+
+                    if (name === 'shaderSource' && this.rewriteShader) {
+                        args[1] = this.rewriteShader(args[1] as string);
+                    }
+
+                    if (name === 'bindFramebuffer' && args[0] !== gl.READ_FRAMEBUFFER) {
+                        endPass();
+                        pass = beginPass(command.args[1] instanceof Ref ? `fb${command.args[1].id}` : 'screen');
+                    }
+
+                    const fn = this.functions[command.name] ?? this.bind(command.name);
+                    const start = performance.now();
+                    const result = fn(...args);
+                    const ms = performance.now() - start;
+
+                    if (command.result !== 0) {
+                        this.objects.set(command.result, result);
+                    }
+
+                    calls[command.name].calls++;
+                    calls[command.name].cpuMs += ms;
+                    pass.calls++;
+                    pass.cpuMs += ms;
+                }
+
+                endPass();
+                frameCpuMs.push(performance.now() - frameStart);
+
+                if (++frame < this.commands.length) {
+                    requestAnimationFrame(tick);
+
+                    return;
+                }
+
+                this.collect(queries).then(() => resolve({
+                    frames: this.commands.length,
+                    width: this.width,
+                    height: this.height,
+                    frameCpuMs,
+                    calls: calls.filter((call) => call.calls > 0).sort((a, b) => b.cpuMs - a.cpuMs),
+                    passes: passes.filter((p) => p.calls > 0)
+                }));
+            };
+
+            requestAnimationFrame(tick);
+        });
+    }
+
+    // Query results arrive a few frames later, a disjoint event invalidates all of them
+    private collect(queries: { pass: PassTiming; query: WebGLQuery }[]): Promise<void> {
+        const gl = this.gl;
+
+        return new Promise((resolve) => {
+            const poll = () => {
+                const last = queries[queries.length - 1];
+
+                if (last && !gl.getQueryParameter(last.query, gl.QUERY_RESULT_AVAILABLE)) {
+                    requestAnimationFrame(poll);
+
+                    return;
+                }
+
+                const disjoint = this.timer !== null && gl.getParameter(this.timer.GPU_DISJOINT_EXT);
+
+                for (const { pass, query } of queries) {
+                    pass.gpuMs = disjoint ? NaN : gl.getQueryParameter(query, gl.QUERY_RESULT) / 1e6;
+                    gl.deleteQuery(query);
+                }
+
+                resolve();
+            };
+
+            poll();
+        });
+    }
+
+    private skipped(command: Command): boolean {
+        const name = this.names[command.name];
+
+        return ((name === 'beginQuery' || name === 'endQuery') && command.args[0] === TIME_ELAPSED_EXT) || name.endsWith('.queryCounterEXT');
+    }
+
+    private resolve(command: Command): unknown[] {
+        const args = command.args.slice();
+
+        for (const i of command.refs) {
+            args[i] = this.objects.get((args[i] as Ref).id) ?? null;
+        }
+
+        return args;
+    }
+
+    // Extension entry points resolve on first use, the capture enabled the extension before that
+    private bind(index: number): (...args: unknown[]) => unknown {
+        const name = this.names[index];
+        const dot = name.indexOf('.');
+        const target = (dot < 0 ? this.gl : this.gl.getExtension(name.slice(0, dot))) as Record<string, (...args: unknown[]) => unknown> | null;
+        const method = target?.[dot < 0 ? name : name.slice(dot + 1)];
+
+        if (!target || typeof method !== 'function') {
+            throw new Error(`Capture Uses ${name} which is not Available on this System.`);
+        }
+
+        this.functions[index] = method.bind(target);
+
+        return this.functions[index];
+    }
+
+    // Everything is decoded up front so the replay only times the gl calls
+    private decode(buffer: ArrayBuffer, offset: number, length: number): void {
+        const view = new DataView(buffer);
+        const decoder = new TextDecoder();
+        const end = offset + length;
+        let frame: Command[] = [];
+
+        while (offset < end) {
+            const name = view.getUint16(offset, true);
+            const count = view.getUint8(offset + 2);
+            const result = view.getUint32(offset + 3, true);
+
+            offset += 7;
+
+            if (name === FRAME_END) {
+                this.commands.push(frame);
+                frame = [];
+
+                continue;
+            }
+
+            const args: unknown[] = [];
+            const refs: number[] = [];
+
+            for (let i = 0; i < count; i++) {
+                const tag = view.getUint8(offset++);
+
+                switch (tag) {
+                    case Tag.Undefined:
+                        args.push(undefined);
+                        break;
+                    case Tag.Null:
+                        args.push(null);
+                        break;
+                    case Tag.False:
+                    case Tag.True:
+                        args.push(tag === Tag.True);
+                        break;
+                    case Tag.Int:
+                        args.push(view.getInt32(offset, true));
+                        offset += 4;
+                        break;
+                    case Tag.Uint:
+                        args.push(view.getUint32(offset, true));
+                        offset += 4;
+                        break;
+                    case Tag.Float:
+                        args.push(view.getFloat32(offset, true));
+                        offset += 4;
+                        break;
+                    case Tag.Object:
+                        refs.push(i);
+                        args.push(new Ref(view.getUint32(offset, true)));
+                        offset += 4;
+                        break;
+                    case Tag.String: {
+                        const bytes = view.getUint32(offset, true);
+
+                        args.push(decoder.decode(new Uint8Array(buffer, offset + 4, bytes)));
+                        offset += 4 + bytes;
+                        break;
+                    }
+                    case Tag.View: {
+                        const Type = VIEW_TYPES[view.getUint8(offset)];
+                        const bytes = view.getUint32(offset + 1, true);
+                        // Copied so the view is aligned for its element type
+                        const data = buffer.slice(offset + 5, offset + 5 + bytes);
+
+                        args.push(Type === DataView ? new DataView(data) : new (Type as Uint8ArrayConstructor)(data));
+                        offset += 5 + bytes;
+                        break;
+                    }
+                    case Tag.Numbers: {
+                        const numbers = view.getUint32(offset, true);
+
+                        args.push(Array.from({ length: numbers }, (_, n) => view.getFloat32(offset + 4 + n * 4, true)));
+                        offset += 4 + numbers * 4;
+                        break;
+                    }
+                    case Tag.Strings: {
+                        const strings: string[] = [];
+                        const count = view.getUint32(offset, true);
+
+                        offset += 4;
+
+                        for (let n = 0; n < count; n++) {
+                            const bytes = view.getUint32(offset, true);
+
+                            strings.push(decoder.decode(new Uint8Array(buffer, offset + 4, bytes)));
+                            offset += 4 + bytes;
+                        }
+
+                        args.push(strings);
+                        break;
+                    }
+                    case Tag.Image: {
+                        const width = view.getUint32(offset, true);
+                        const height = view.getUint32(offset + 4, true);
+                        const bytes = width * height * 4;
+
+                        args.push(new ImageData(new Uint8ClampedArray(buffer.slice(offset + 8, offset + 8 + bytes)), width, height));
+                        offset += 8 + bytes;
+                        break;
+                    }
+                    default:
+                        throw new Error(`Capture is Corrupt, Unknown Argument Tag ${tag}.`);
+                }
+            }
+
+            frame.push({ name, args, refs, result });
+        }
+
+        if (frame.length > 0) {
+            this.commands.push(frame);
+        }
+    }
+}
+
+export type { ReplayReport, PassTiming, CallTiming };
+export default CommandReplayer;
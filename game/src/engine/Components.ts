@@ -0,0 +1,339 @@
+// Generated by scripts/generate-components.mjs from components/*.json, edit the schemas instead
+// Animation, 2 float32 per entity
+const AnimationLayout = {
+    stride: 2,
+    clip: 0,
+    phase: 1
+} as const;
+
+class AnimationColumns {
+    public readonly data: Float32Array;
+
+    constructor(data: Float32Array) {
+        this.data = data;
+    }
+
+    public clip(entity: number): number {
+        return this.data[entity * 2];
+    }
+
+    public setClip(entity: number, value: number): void {
+        this.data[entity * 2] = value;
+    }
+
+    public phase(entity: number): number {
+        return this.data[entity * 2 + 1];
+    }
+
+    public setPhase(entity: number, value: number): void {
+        this.data[entity * 2 + 1] = value;
+    }
+}
+
+class AnimationQuery {
+    public entity: number = -1;
+    public clip: number = 0;
+    public phase: number = 0;
+
+    private data: Float32Array;
+    private entities: Uint32Array | null = null;
+    private count: number = 0;
+    private cursor: number = 0;
+
+    constructor(data: Float32Array) {
+        this.data = data;
+    }
+
+    // entities lists the indices to visit, null visits [0, count)
+    public reset(entities: Uint32Array | null, count: number): this {
+        this.entities = entities;
+        this.count = count;
+        this.cursor = 0;
+        this.entity = -1;
+
+        return this;
+    }
+
+    public next(): boolean {
+        if (this.cursor >= this.count) {
+            return false;
+        }
+
+        const entity = this.entities ? this.entities[this.cursor] : this.cursor;
+        const base = entity * 2;
+        const data = this.data;
+
+        this.cursor++;
+        this.entity = entity;
+        this.clip = data[base];
+        this.phase = data[base + 1];
+
+        return true;
+    }
+
+    // Writes the current entity's fields back
+    public store(): void {
+        const base = this.entity * 2;
+        const data = this.data;
+
+        data[base] = this.clip;
+        data[base + 1] = this.phase;
+    }
+}
+
+// Returns the byte offset after the last entity
+const writeAnimation = (view: DataView, offset: number, data: Float32Array, count: number): number => {
+    for (let entity = 0; entity < count; entity++) {
+        const base = entity * 2;
+
+        view.setFloat32(offset, data[base], true);
+        view.setFloat32(offset + 4, data[base + 1], true);
+        offset += 8;
+    }
+
+    return offset;
+};
+
+const readAnimation = (view: DataView, offset: number, data: Float32Array, count: number): number => {
+    for (let entity = 0; entity < count; entity++) {
+        const base = entity * 2;
+
+        data[base] = view.getFloat32(offset, true);
+        data[base + 1] = view.getFloat32(offset + 4, true);
+        offset += 8;
+    }
+
+    return offset;
+};
+
+// Transform, 10 float32 per entity
+const TransformLayout = {
+    stride: 10,
+    positionX: 0,
+    positionY: 1,
+    positionZ: 2,
+    rotationX: 3,
+    rotationY: 4,
+    rotationZ: 5,
+    rotationW: 6,
+    scaleX: 7,
+    scaleY: 8,
+    scaleZ: 9
+} as const;
+
+class TransformColumns {
+    public readonly data: Float32Array;
+
+    constructor(data: Float32Array) {
+        this.data = data;
+    }
+
+    public positionX(entity: number): number {
+        return this.data[entity * 10];
+    }
+
+    public setPositionX(entity: number, value: number): void {
+        this.data[entity * 10] = value;
+    }
+
+    public positionY(entity: number): number {
+        return this.data[entity * 10 + 1];
+    }
+
+    public setPositionY(entity: number, value: number): void {
+        this.data[entity * 10 + 1] = value;
+    }
+
+    public positionZ(entity: number): number {
+        return this.data[entity * 10 + 2];
+    }
+
+    public setPositionZ(entity: number, value: number): void {
+        this.data[entity * 10 + 2] = value;
+    }
+
+    public rotationX(entity: number): number {
+        return this.data[entity * 10 + 3];
+    }
+
+    public setRotationX(entity: number, value: number): void {
+        this.data[entity * 10 + 3] = value;
+    }
+
+    public rotationY(entity: number): number {
+        return this.data[entity * 10 + 4];
+    }
+
+    public setRotationY(entity: number, value: number): void {
+        this.data[entity * 10 + 4] = value;
+    }
+
+    public rotationZ(entity: number): number {
+        return this.data[entity * 10 + 5];
+    }
+
+    public setRotationZ(entity: number, value: number): void {
+        this.data[entity * 10 + 5] = value;
+    }
+
+    public rotationW(entity: number): number {
+        return this.data[entity * 10 + 6];
+    }
+
+    public setRotationW(entity: number, value: number): void {
+        this.data[entity * 10 + 6] = value;
+    }
+
+    public scaleX(entity: number): number {
+        return this.data[entity * 10 + 7];
+    }
+
+    public setScaleX(entity: number, value: number): void {
+        this.data[entity * 10 + 7] = value;
+    }
+
+    public scaleY(entity: number): number {
+        return this.data[entity * 10 + 8];
+    }
+
+    public setScaleY(entity: number, value: number): void {
+        this.data[entity * 10 + 8] = value;
+    }
+
+    public scaleZ(entity: number): number {
+        return this.data[entity * 10 + 9];
+    }
+
+    public setScaleZ(entity: number, value: number): void {
+        this.data[entity * 10 + 9] = value;
+    }
+}
+
+class TransformQuery {
+    public entity: number = -1;
+    public positionX: number = 0;
+    public positionY: number = 0;
+    public positionZ: number = 0;
+    public rotationX: number = 0;
+    public rotationY: number = 0;
+    public rotationZ: number = 0;
+    public rotationW: number = 0;
+    public scaleX: number = 0;
+    public scaleY: number = 0;
+    public scaleZ: number = 0;
+
+    private data: Float32Array;
+    private entities: Uint32Array | null = null;
+    private count: number = 0;
+    private cursor: number = 0;
+
+    constructor(data: Float32Array) {
+        this.data = data;
+    }
+
+    // entities lists the indices to visit, null visits [0, count)
+    public reset(entities: Uint32Array | null, count: number): this {
+        this.entities = entities;
+        this.count = count;
+        this.cursor = 0;
+        this.entity = -1;
+
+        return this;
+    }
+
+    public next(): boolean {
+        if (this.cursor >= this.count) {
+            return false;
+        }
+
+        const entity = this.entities ? this.entities[this.cursor] : this.cursor;
+        const base = entity * 10;
+        const data = this.data;
+
+        this.cursor++;
+        this.entity = entity;
+        this.positionX = data[base];
+        this.positionY = data[base + 1];
+        this.positionZ = data[base + 2];
+        this.rotationX = data[base + 3];
+        this.rotationY = data[base + 4];
+        this.rotationZ = data[base + 5];
+        this.rotationW = data[base + 6];
+        this.scaleX = data[base + 7];
+        this.scaleY = data[base + 8];
+        this.scaleZ = data[base + 9];
+
+        return true;
+    }
+
+    // Writes the current entity's fields back
+    public store(): void {
+        const base = this.entity * 10;
+        const data = this.data;
+
+        data[base] = this.positionX;
+        data[base + 1] = this.positionY;
+        data[base + 2] = this.positionZ;
+        data[base + 3] = this.rotationX;
+        data[base + 4] = this.rotationY;
+        data[base + 5] = this.rotationZ;
+        data[base + 6] = this.rotationW;
+        data[base + 7] = this.scaleX;
+        data[base + 8] = this.scaleY;
+        data[base + 9] = this.scaleZ;
+    }
+}
+
+// Returns the byte offset after the last entity
+const writeTransform = (view: DataView, offset: number, data: Float32Array, count: number): number => {
+    for (let entity = 0; entity < count; entity++) {
+        const base = entity * 10;
+
+        view.setFloat32(offset, data[base], true);
+        view.setFloat32(offset + 4, data[base + 1], true);
+        view.setFloat32(offset + 8, data[base + 2], true);
+        view.setFloat32(offset + 12, data[base + 3], true);
+        view.setFloat32(offset + 16, data[base + 4], true);
+        view.setFloat32(offset + 20, data[base + 5], true);
+        view.setFloat32(offset + 24, data[base + 6], true);
+        view.setFloat32(offset + 28, data[base + 7], true);
+        view.setFloat32(offset + 32, data[base + 8], true);
+        view.setFloat32(offset + 36, data[base + 9], true);
+        offset += 40;
+    }
+
+    return offset;
+};
+
+const readTransform = (view: DataView, offset: number, data: Float32Array, count: number): number => {
+    for (let entity = 0; entity < count; entity++) {
+        const base = entity * 10;
+
+        data[base] = view.getFloat32(offset, true);
+        data[base + 1] = view.getFloat32(offset + 4, true);
+        data[base + 2] = view.getFloat32(offset + 8, true);
+        data[base + 3] = view.getFloat32(offset + 12, true);
+        data[base + 4] = view.getFloat32(offset + 16, true);
+        data[base + 5] = view.getFloat32(offset + 20, true);
+        data[base + 6] = view.getFloat32(offset + 24, true);
+        data[base + 7] = view.getFloat32(offset + 28, true);
+        data[base + 8] = view.getFloat32(offset + 32, true);
+        data[base + 9] = view.getFloat32(offset + 36, true);
+        offset += 40;
+    }
+
+    return offset;
+};
+
+export {
+    AnimationLayout,
+    AnimationColumns,
+    AnimationQuery,
+    writeAnimation,
+    readAnimation,
+    TransformLayout,
+    TransformColumns,
+    TransformQuery,
+    writeTransform,
+    readTransform
+};
@@ -0,0 +1,249 @@
+import type AsyncReadback from './AsyncReadback';
+import type Camera from './Camera';
+import type GeometryArena from './GeometryArena';
+import RenderTarget from './RenderTarget';
+import Shader from './Shader';
+
+type PrepassMode = 'off' | 'on' | 'auto';
+
+// Arena geometry has its world space position at location 0
+// Material shaders that draw over the prepass with LEQUAL declare gl_Position invariant as well, the
+// same expression in two programs is otherwise free to compile to slightly different depths
+const POSITION_VERTEX = `#version 300 es
+layout(location = 0) in vec3 position;
+
+uniform mat4 viewProjection;
+
+invariant gl_Position;
+
+void main() {
+    gl_Position = viewProjection * vec4(position, 1.0);
+}`;
+
+const DEPTH_FRAGMENT = `#version 300 es
+precision lowp float;
+
+out vec4 outColor;
+
+void main() {
+    outColor = vec4(0.0);
+}`;
+
+// Every invocation adds one step, up to 255 layers fit in the 8 bit target
+const COUNT_FRAGMENT = `#version 300 es
+precision lowp float;
+
+out vec4 outColor;
+
+void main() {
+    outColor = vec4(1.0 / 255.0, 0.0, 0.0, 1.0);
+}`;
+
+const HEAT_FRAGMENT = `#version 300 es
+precision mediump float;
+
+in vec2 uv;
+
+uniform sampler2D counts;
+
+out vec4 outColor;
+
+void main() {
+    float layers = texture(counts, uv).r * 255.0;
+
+    // 1 blue, 2 green, 3 yellow, 4 red, 6 and up white
+    vec3 color = layers < 1.0 ? vec3(0.0)
+        : layers < 2.0 ? mix(vec3(0.0, 0.0, 0.4), vec3(0.0, 0.2, 1.0), layers - 1.0)
+        : layers < 3.0 ? mix(vec3(0.0, 0.2, 1.0), vec3(0.0, 1.0, 0.2), layers - 2.0)
+        : layers < 4.0 ? mix(vec3(0.0, 1.0, 0.2), vec3(1.0, 1.0, 0.0), layers - 3.0)
+        : layers < 6.0 ? mix(vec3(1.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0), (layers - 4.0) / 2.0)
+        : mix(vec3(1.0, 0.0, 0.0), vec3(1.0), min(1.0, (layers - 6.0) / 6.0));
+
+    outColor = vec4(color, 1.0);
+}`;
+
+// Probes for auto mode render at this fraction of the scene resolution
+const PROBE_SCALE = 0.25;
+const PROBE_INTERVAL = 60;
+
+// Depth only prepass for the arena geometry, and the overdraw measurements that decide when to use it
+//
+// With the prepass every visible pixel of an opaque material is shaded once, at the cost of transforming
+// the geometry twice. That pays off in dense interiors with expensive lighting, so auto mode renders a
+// small fragment count probe every few seconds and switches the prepass on while overdraw is high.
+class DepthPrepass {
+    public mode: PrepassMode = 'auto';
+    // Orders arena draws front to back, helps early depth with or without the prepass
+    public sort: boolean = true;
+    // Debug view, replaces the scene with a heat map of fragment shader invocations per pixel
+    public view: boolean = false;
+    // Average shaded fragments per covered pixel without the prepass, from the latest probe
+    public overdraw: number = 0;
+    // Auto mode switches on above enableAt and off again below disableAt
+    public enableAt: number = 2.5;
+    public disableAt: number = 1.8;
+
+    private gl: WebGL2RenderingContext;
+    private depthShader: Shader;
+    private countShader: Shader;
+    private heatShader: Shader;
+    private counts: RenderTarget;
+    private probe: RenderTarget;
+    private emptyVao: WebGLVertexArrayObject;
+    private autoActive: boolean = false;
+    private probing: boolean = false;
+    private frames: number = 0;
+
+    constructor(gl: WebGL2RenderingContext) {
+        this.gl = gl;
+        this.depthShader = new Shader(gl, POSITION_VERTEX, DEPTH_FRAGMENT);
+        this.countShader = new Shader(gl, POSITION_VERTEX, COUNT_FRAGMENT);
+        this.heatShader = new Shader(gl, Shader.FULLSCREEN_VERTEX, HEAT_FRAGMENT);
+        this.counts = new RenderTarget(gl, [gl.RGBA8], true, gl.NEAREST);
+        this.probe = new RenderTarget(gl, [gl.RGBA8], true, gl.NEAREST);
+        this.emptyVao = gl.createVertexArray();
+    }
+
+    public get active(): boolean {
+        return this.mode === 'on' || (this.mode === 'auto' && this.autoActive);
+    }
+
+    // Draws the queued arena geometry into the bound target and keeps the queue, returns the draw calls
+    public draw(arena: GeometryArena, camera: Camera, bindMaterial: (material: number) => void): number {
+        const gl = this.gl;
+
+        if (!this.active) {
+            return arena.flush(bindMaterial, true);
+        }
+
+        gl.colorMask(false, false, false, false);
+        this.bindPositionShader(this.depthShader, camera);
+        let calls = arena.flush(() => {}, true);
+        gl.colorMask(true, true, true, true);
+
+        // Depth is final, materials only shade the fragments that won
+        gl.depthFunc(gl.LEQUAL);
+        gl.depthMask(false);
+        calls += arena.flush(bindMaterial, true);
+        gl.depthMask(true);
+        gl.depthFunc(gl.LESS);
+
+        return calls;
+    }
+
+    // Runs the probe when one is due and fills the overdraw view, after the opaque geometry and before the queue is dropped
+    public measure(arena: GeometryArena, camera: Camera, scene: RenderTarget, readback: AsyncReadback): void {
+        if (this.view) {
+            this.count(this.counts, scene.width, scene.height, arena, camera, this.active);
+        }
+
+        if (this.mode !== 'auto' && !this.view) {
+            return;
+        }
+
+        if (!this.probing && ++this.frames >= PROBE_INTERVAL) {
+            this.frames = 0;
+            this.startProbe(arena, camera, scene, readback);
+        }
+
+        scene.bind();
+    }
+
+    // Replaces the scene colour with the heat map, call once everything counted has been drawn
+    public composite(scene: RenderTarget): void {
+        if (!this.view) {
+            return;
+        }
+
+        const gl = this.gl;
+        const shader = this.heatShader;
+
+        scene.bind();
+        gl.disable(gl.DEPTH_TEST);
+        gl.bindVertexArray(this.emptyVao);
+        shader.use();
+        gl.activeTexture(gl.TEXTURE0);
+        gl.bindTexture(gl.TEXTURE_2D, this.counts.texture);
+        gl.uniform1i(shader.uniform('counts'), 0);
+        gl.drawArrays(gl.TRIANGLES, 0, 3);
+        gl.bindVertexArray(null);
+        gl.enable(gl.DEPTH_TEST);
+    }
+
+    public dispose(): void {
+        this.depthShader.dispose();
+        this.countShader.dispose();
+        this.heatShader.dispose();
+        this.counts.dispose();
+        this.probe.dispose();
+        this.gl.deleteVertexArray(this.emptyVao);
+    }
+
+    // The probe always counts without the prepass, it measures what the prepass would save
+    private startProbe(arena: GeometryArena, camera: Camera, scene: RenderTarget, readback: AsyncReadback): void {
+        const probe = this.probe;
+
+        this.count(probe, scene.width * PROBE_SCALE, scene.height * PROBE_SCALE, arena, camera, false);
+        this.probing = true;
+
+        readback.read(probe, 0, 0, probe.width, probe.height).then((result) => {
+            this.probing = false;
+            this.overdraw = DepthPrepass.average(result.pixels);
+            this.autoActive = this.autoActive ? this.overdraw > this.disableAt : this.overdraw > this.enableAt;
+        }, () => {
+            this.probing = false;
+        });
+    }
+
+    // Additive blending counts invocations, with depth testing as the real pass would do it
+    private count(target: RenderTarget, width: number, height: number, arena: GeometryArena, camera: Camera, prepass: boolean): void {
+        const gl = this.gl;
+
+        // Counts start at zero, whatever clear colour the frame uses is put back afterwards
+        const clearColor = gl.getParameter(gl.COLOR_CLEAR_VALUE) as Float32Array;
+
+        target.resize(width, height);
+        target.bind();
+        gl.clearColor(0, 0, 0, 0);
+        gl.clear(gl.COLOR_BUFFER_BIT | gl.DEPTH_BUFFER_BIT);
+        gl.clearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+
+        if (prepass) {
+            gl.colorMask(false, false, false, false);
+            this.bindPositionShader(this.depthShader, camera);
+            arena.flush(() => {}, true);
+            gl.colorMask(true, true, true, true);
+            gl.depthFunc(gl.LEQUAL);
+            gl.depthMask(false);
+        }
+
+        gl.enable(gl.BLEND);
+        gl.blendFunc(gl.ONE, gl.ONE);
+        this.bindPositionShader(this.countShader, camera);
+        arena.flush(() => {}, true);
+        gl.disable(gl.BLEND);
+        gl.depthMask(true);
+        gl.depthFunc(gl.LESS);
+    }
+
+    private bindPositionShader(shader: Shader, camera: Camera): void {
+        shader.use();
+        this.gl.uniformMatrix4fv(shader.uniform('viewProjection'), false, camera.viewProjection);
+    }
+
+    // Shaded fragments per pixel that was covered at all
+    private static average(pixels: Uint8Array): number {
+        let layers = 0;
+        let covered = 0;
+
+        for (let i = 0; i < pixels.length; i += 4) {
+            layers += pixels[i];
+            covered += pixels[i] > 0 ? 1 : 0;
+        }
+
+        return covered > 0 ? layers / covered : 0;
+    }
+}
+
+export type { PrepassMode };
+export default DepthPrepass;
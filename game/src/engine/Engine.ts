@@ -0,0 +1,297 @@
+import AssetArchive from './AssetArchive';
+import AsyncReadback from './AsyncReadback';
+import type { Readback } from './AsyncReadback';
+import AutoExposure from './AutoExposure';
+import Camera from './Camera';
+import DepthPrepass from './DepthPrepass';
+import FrameBudget, { Priority } from './FrameBudget';
+import FrameExtrapolator from './FrameExtrapolator';
+import GeometryArena from './GeometryArena';
+import GpuTimer from './GpuTimer';
+import LatencyMeter from './LatencyMeter';
+import Level from './Level';
+import MultiResolution from './MultiResolution';
+import PerfHeatmap, { HeatmapOverlay } from './PerfHeatmap';
+import PostChain from './PostChain';
+import PreSkinning from './PreSkinning';
+import RenderTarget from './RenderTarget';
+import ResourceScope from './ResourceScope';
+import type Simulation from './Simulation';
+import { updateStatic } from './StaticNoise';
+import StreamingBuffers from './StreamingBuffers';
+import type { ScopeReport } from './ResourceScope';
+
+interface RenderPass {
+    render(engine: Engine, time: number): void;
+}
+
+class Engine {
+    public readonly gl: WebGL2RenderingContext;
+    public readonly camera: Camera = new Camera();
+    public readonly arena: GeometryArena;
+    public readonly gpuTimer: GpuTimer;
+    public readonly post: PostChain;
+    public readonly extrapolator: FrameExtrapolator;
+    public readonly multiResolution: MultiResolution;
+    public readonly prepass: DepthPrepass;
+    // Skinned characters, skinned once per frame and drawn by every pass as arena geometry
+    public readonly skinning: PreSkinning;
+    public readonly readback: AsyncReadback;
+    public readonly autoExposure: AutoExposure;
+    // Per frame CPU written geometry, see StreamingBuffers
+    public readonly streams: StreamingBuffers;
+    public readonly latency: LatencyMeter = new LatencyMeter();
+    public readonly heatmap: PerfHeatmap = new PerfHeatmap();
+    // Work that can slip a frame when the frame runs long, see FrameBudget
+    public readonly budget: FrameBudget = new FrameBudget();
+    public heatmapOverlay: HeatmapOverlay | null = null;
+    public level: Level | null = null;
+    // Opened on the first loadLevel(), levels load as loose files when it is missing
+    public archiveName: string = 'assets';
+    private archive: Promise<AssetArchive | null> | null = null;
+    // Interpolated game state, render code reads it instead of the simulation's own copy
+    public simulation: Simulation | null = null;
+    // Lives as long as the engine, a game state's scope would close it on the first transition
+    public audio: AudioContext | null = null;
+    public readonly passes: RenderPass[] = [];
+    // Resources of the current game state, the engine's own resources live until dispose()
+    public scope: ResourceScope;
+    public readonly transitions: ScopeReport[] = [];
+    public drawCalls: number = 0;
+    public frameTime: number = 0;
+    // Latest resolved GPU frame time, lags a few frames behind
+    public gpuTime: number = 0;
+
+    private materials: (() => void)[] = [];
+    private lastTime: number = -1;
+    // Reads that need the finished frame, issued after it has been composited
+    // Reads waiting for the next frame, rejected if the engine is disposed first
+    private frameReads: { read: () => void; reject: (error: Error) => void }[] = [];
+
+    // scope hands over the state that was active before the engine existed, e.g. the menu
+    constructor(gl: WebGL2RenderingContext, scope: ResourceScope = new ResourceScope('boot')) {
+        this.gl = gl;
+        this.scope = scope;
+        this.arena = new GeometryArena(gl);
+        this.gpuTimer = new GpuTimer(gl);
+        this.post = new PostChain(gl);
+        this.extrapolator = new FrameExtrapolator(gl);
+        this.multiResolution = new MultiResolution(gl);
+        this.prepass = new DepthPrepass(gl);
+        this.skinning = new PreSkinning(gl, this.arena);
+        this.readback = new AsyncReadback(gl);
+        this.autoExposure = new AutoExposure(gl);
+        this.streams = new StreamingBuffers(gl);
+
+        this.budget.register('readback', Priority.high, 1, (deadline) => this.readback.poll(deadline), 4);
+        this.budget.register('arena', Priority.low, 2, (deadline) => this.arena.maintain(deadline));
+    }
+
+    // Returns the id that static meshes are queued with, see GeometryArena.draw
+    public registerMaterial(bind: () => void): number {
+        this.materials.push(bind);
+
+        return this.materials.length - 1;
+    }
+
+    // Ends the current state, everything allocated into its scope is released in one go
+    public enterState(name: string): ScopeReport {
+        const report = this.scope.release();
+
+        this.scope = new ResourceScope(name);
+        this.transitions.push(report);
+
+        return report;
+    }
+
+    public async loadLevel(name: string): Promise<Level> {
+        const path = `levels/${name}.lvl`;
+        const archive = await this.openArchive();
+        const level = archive?.has(path) ? new Level(await archive.read(path)) : await Level.load(`/${path}`);
+
+        this.enterState(`level:${name}`);
+        this.simulation?.load(level);
+        this.level = this.scope.track('data', level, () => {
+            if (this.level === level) {
+                this.level = null;
+            }
+        }, level.bytes.byteLength);
+
+        return level;
+    }
+
+    public frame(time: number): void {
+        const gl = this.gl;
+        const start = performance.now();
+
+        this.frameTime = this.lastTime < 0 ? 0 : time - this.lastTime;
+        this.lastTime = time;
+
+        const warp = this.extrapolator.shouldWarp();
+
+        // Timer tags carry the heatmap bucket and whether the frame was a warp
+        this.gpuTimer.poll((tag, ms) => {
+            this.gpuTime = ms;
+            this.heatmap.addGpuTime(tag >> 1, ms);
+
+            if ((tag & 1) === 0) {
+                this.extrapolator.sampleGpu(ms);
+            }
+        });
+        this.gpuTimer.begin();
+        this.streams.beginFrame();
+
+        this.simulation?.sample();
+
+        if (this.simulation) {
+            updateStatic(this.post.staticNoise, this.simulation.effects, this.simulation.seed);
+        }
+
+        this.resize();
+        this.camera.update(gl.drawingBufferWidth / Math.max(1, gl.drawingBufferHeight));
+        this.simulation?.focus(this.camera.position);
+
+        if (warp) {
+            this.arena.discard();
+            this.post.end(this.camera, this.extrapolator.warp(this.post.scene, this.camera));
+            this.drawCalls = 2;
+        } else {
+            this.render(time);
+            this.extrapolator.capture(this.camera);
+            this.post.exposure = this.autoExposure.update(this.post.scene, this.readback, this.frameTime);
+        }
+
+        for (const { read } of this.frameReads) {
+            read();
+        }
+
+        this.frameReads = [];
+        this.streams.endFrame();
+        this.budget.run(start);
+        this.latency.present(warp ? 1 : 0);
+
+        const position = this.camera.position;
+        const bucket = this.heatmap.record(position[0], position[2], this.camera.yaw, this.frameTime, this.drawCalls);
+
+        this.gpuTimer.end(bucket * 2 + (warp ? 1 : 0));
+    }
+
+    // The next presented frame, full resolution with post processing, resolves a few frames later
+    public screenshot(): Promise<Readback> {
+        return new Promise((resolve, reject) => {
+            this.frameReads.push({ read: () => {
+                const gl = this.gl;
+
+                this.readback.read(null, 0, 0, gl.drawingBufferWidth, gl.drawingBufferHeight).then(resolve, reject);
+            }, reject });
+        });
+    }
+
+    // Downscaled scene of the next frame, e.g. for save slots, without post processing
+    public thumbnail(width: number = 256, height: number = 144): Promise<Readback> {
+        const target = new RenderTarget(this.gl, [this.gl.RGBA8]);
+
+        target.resize(width, height);
+
+        return new Promise<Readback>((resolve, reject) => {
+            this.frameReads.push({ read: () => {
+                const gl = this.gl;
+                const scene = this.post.scene;
+
+                gl.bindFramebuffer(gl.READ_FRAMEBUFFER, scene.framebuffer);
+                gl.bindFramebuffer(gl.DRAW_FRAMEBUFFER, target.framebuffer);
+                gl.blitFramebuffer(0, 0, scene.width, scene.height, 0, 0, width, height, gl.COLOR_BUFFER_BIT, gl.LINEAR);
+                gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+
+                this.readback.read(target, 0, 0, width, height).then(resolve, reject);
+            }, reject });
+        }).finally(() => target.dispose());
+    }
+
+    // Builds ship an archive next to the loose files, dev servers before the first build do not
+    private openArchive(): Promise<AssetArchive | null> {
+        this.archive ??= AssetArchive.open(this.archiveName).catch((error: Error) => {
+            console.info(`asset archive unavailable, loading loose files (${error.message})`);
+            return null;
+        });
+
+        return this.archive;
+    }
+
+    private render(time: number): void {
+        const gl = this.gl;
+
+        this.post.begin(gl.drawingBufferWidth, gl.drawingBufferHeight);
+        gl.enable(gl.DEPTH_TEST);
+
+        const bind = (material: number): void => this.materials[material]();
+        const opaque = (): number => this.prepass.draw(this.arena, this.camera, bind);
+        const vignette = this.post.vignette;
+
+        // Before sorting, skinned characters join the queue here
+        this.skinning.update(this.camera);
+
+        if (this.prepass.sort) {
+            this.arena.sort(this.camera.position);
+        }
+
+        // Only the arena geometry is split by resolution, passes and overlays still draw at full resolution
+        if (this.multiResolution.enabled && vignette.strength > 0 && this.multiResolution.savings(vignette) > 0) {
+            this.drawCalls = this.multiResolution.render(this.post.scene, vignette, opaque);
+        } else {
+            gl.clear(gl.COLOR_BUFFER_BIT | gl.DEPTH_BUFFER_BIT);
+            this.drawCalls = opaque();
+        }
+
+        this.prepass.measure(this.arena, this.camera, this.post.scene, this.readback);
+        this.arena.discard();
+
+        for (const pass of this.passes) {
+            pass.render(this, time);
+        }
+
+        this.prepass.composite(this.post.scene);
+        this.heatmapOverlay?.draw(this.camera.viewProjection);
+
+        this.post.end(this.camera);
+    }
+
+    // Keeps the drawing buffer at the canvas' displayed size
+    public resize(): void {
+        const canvas = this.gl.canvas as HTMLCanvasElement;
+        const width = Math.max(1, Math.round(canvas.clientWidth * devicePixelRatio));
+        const height = Math.max(1, Math.round(canvas.clientHeight * devicePixelRatio));
+
+        if (canvas.width !== width || canvas.height !== height) {
+            canvas.width = width;
+            canvas.height = height;
+        }
+    }
+
+    public dispose(): void {
+        for (const { reject } of this.frameReads) {
+            reject(new Error('Engine was Disposed before the Next Frame.'));
+        }
+
+        this.frameReads = [];
+        this.transitions.push(this.scope.release());
+        this.skinning.dispose();
+        this.arena.dispose();
+        this.gpuTimer.dispose();
+        this.post.dispose();
+        this.extrapolator.dispose();
+        this.multiResolution.dispose();
+        this.prepass.dispose();
+        this.simulation?.dispose();
+        this.archive?.then((archive) => archive?.dispose());
+        this.readback.dispose();
+        this.autoExposure.dispose();
+        this.streams.dispose();
+        this.heatmapOverlay?.dispose();
+        this.audio?.close();
+        this.materials = [];
+    }
+}
+
+export type { RenderPass };
+export default Engine;
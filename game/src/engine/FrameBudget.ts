@@ -0,0 +1,128 @@
+// Lower runs first, critical work runs every frame whatever the time left
+const Priority = {
+    critical: 0,
+    high: 1,
+    normal: 2,
+    low: 3
+} as const;
+
+type BudgetPriority = typeof Priority[keyof typeof Priority];
+
+// deadline is a performance.now() time, work that can be split should stop there and continue next frame
+type BudgetedWork = (deadline: number) => void;
+
+interface Subsystem {
+    readonly name: string;
+    readonly priority: BudgetPriority;
+    budgetMs: number;
+    // Frames in a row the work may be skipped before it runs regardless
+    maxDeferral: number;
+    work: BudgetedWork;
+    lastMs: number;
+    deferredFrames: number;
+    deferrals: number;
+    overruns: number;
+    worstMs: number;
+}
+
+// Overruns are logged at most this often per subsystem
+const LOG_INTERVAL = 5000;
+
+// Runs the engine's non essential per frame work in whatever time the frame has left
+//
+// Subsystems run by priority, each only when its budget still fits before the target frame time.
+// Whatever does not fit is deferred to a later frame, up to maxDeferral frames so nothing starves.
+// Work gets its own deadline and can amortise itself over several frames.
+class FrameBudget {
+    // CPU time a frame may take, including the rendering before run() is called
+    public targetMs: number = 1000 / 60;
+    public readonly subsystems: Subsystem[] = [];
+
+    private lastLog: Map<string, number> = new Map();
+    private loggedOverruns: Map<string, number> = new Map();
+
+    public register(name: string, priority: BudgetPriority, budgetMs: number, work: BudgetedWork, maxDeferral: number = 30): Subsystem {
+        if (this.subsystems.some((subsystem) => subsystem.name === name)) {
+            throw new Error(`Frame Budget Subsystem '${name}' is Already Registered.`);
+        }
+
+        const subsystem: Subsystem = {
+            name, priority, budgetMs, maxDeferral, work,
+            lastMs: 0, deferredFrames: 0, deferrals: 0, overruns: 0, worstMs: 0
+        };
+
+        this.subsystems.push(subsystem);
+        this.subsystems.sort((a, b) => a.priority - b.priority);
+
+        return subsystem;
+    }
+
+    public unregister(name: string): void {
+        const index = this.subsystems.findIndex((subsystem) => subsystem.name === name);
+
+        if (index >= 0) {
+            this.subsystems.splice(index, 1);
+        }
+    }
+
+    // frameStart is the performance.now() time the frame's work began
+    public run(frameStart: number): void {
+        const end = frameStart + this.targetMs;
+
+        for (const subsystem of this.subsystems) {
+            const start = performance.now();
+            const due = subsystem.priority === Priority.critical || subsystem.deferredFrames >= subsystem.maxDeferral;
+
+            if (!due && end - start < subsystem.budgetMs) {
+                subsystem.deferredFrames++;
+                subsystem.deferrals++;
+                continue;
+            }
+
+            subsystem.work(start + subsystem.budgetMs);
+
+            const ms = performance.now() - start;
+
+            subsystem.lastMs = ms;
+            subsystem.deferredFrames = 0;
+            subsystem.worstMs = Math.max(subsystem.worstMs, ms);
+
+            if (ms > subsystem.budgetMs) {
+                subsystem.overruns++;
+                this.logOverrun(subsystem, ms);
+            }
+        }
+    }
+
+    // Summed over every subsystem since startup
+    public get stats(): { deferrals: number; overruns: number } {
+        let deferrals = 0;
+        let overruns = 0;
+
+        for (const subsystem of this.subsystems) {
+            deferrals += subsystem.deferrals;
+            overruns += subsystem.overruns;
+        }
+
+        return { deferrals, overruns };
+    }
+
+    private logOverrun(subsystem: Subsystem, ms: number): void {
+        const now = performance.now();
+        const last = this.lastLog.get(subsystem.name) ?? -Infinity;
+
+        if (now - last < LOG_INTERVAL) {
+            return;
+        }
+
+        const since = subsystem.overruns - (this.loggedOverruns.get(subsystem.name) ?? 0);
+
+        console.warn(`${subsystem.name} ran ${ms.toFixed(2)}ms of a ${subsystem.budgetMs}ms budget (${since} overruns since the last report)`);
+        this.lastLog.set(subsystem.name, now);
+        this.loggedOverruns.set(subsystem.name, subsystem.overruns);
+    }
+}
+
+export type { BudgetPriority, BudgetedWork, Subsystem };
+export { Priority };
+export default FrameBudget;
@@ -0,0 +1,162 @@
+import Camera from './Camera';
+import RenderTarget from './RenderTarget';
+import Shader from './Shader';
+
+type ExtrapolationMode = 'off' | 'auto' | 'always';
+
+const WARP_FRAGMENT = `#version 300 es
+precision highp float;
+
+in vec2 uv;
+
+uniform sampler2D color;
+uniform sampler2D depth;
+uniform mat4 currentToSource;
+uniform mat4 sourceToCurrent;
+uniform vec2 texel;
+
+out vec4 outColor;
+
+vec2 project(mat4 m, vec2 ndc, float d) {
+    vec4 p = m * vec4(ndc, d, 1.0);
+    return p.xy / p.w;
+}
+
+void main() {
+    vec2 target = uv * 2.0 - 1.0;
+
+    // Near the far plane the mapping is exact for pure rotation, the loop then corrects for translation with the source depth
+    vec2 source = project(currentToSource, target, 0.999);
+    vec2 landed = target;
+
+    for (int i = 0; i < 3; i++) {
+        float d = texture(depth, source * 0.5 + 0.5).r * 2.0 - 1.0;
+
+        landed = project(sourceToCurrent, source, d);
+        source += target - landed;
+    }
+
+    vec2 at = clamp(source * 0.5 + 0.5, texel * 0.5, 1.0 - texel * 0.5);
+    vec2 error = (target - landed) * 0.5;
+
+    // Disocclusion, nothing in the old frame lands here, so stretch whatever background is nearby
+    if (length(error) > 2.0 * length(texel)) {
+        vec2 step = normalize(error) * 4.0 * texel;
+        float farthest = -1.0;
+
+        for (int i = -2; i <= 2; i++) {
+            vec2 probe = clamp(at + step * float(i), vec2(0.0), vec2(1.0));
+            float d = texture(depth, probe).r;
+
+            if (d > farthest) {
+                farthest = d;
+                at = probe;
+            }
+        }
+    }
+
+    outColor = texture(color, at);
+}`;
+
+// Re-presents the last full render warped to the newest camera when the GPU cannot hold the display rate
+class FrameExtrapolator {
+    public mode: ExtrapolationMode = 'off';
+    // Display interval the GPU has to fit into
+    public targetInterval: number = 1000 / 60;
+    public warpedFrames: number = 0;
+
+    private gl: WebGL2RenderingContext;
+    private shader: Shader;
+    private target: RenderTarget;
+    private sourceViewProjection: Float32Array = new Float32Array(16);
+    private sourceInverse: Float32Array = new Float32Array(16);
+    private currentToSource: Float32Array = new Float32Array(16);
+    private sourceToCurrent: Float32Array = new Float32Array(16);
+    private hasSource: boolean = false;
+    private lastWarped: boolean = false;
+    private gpuBound: boolean = false;
+    private fullFrameGpu: number = 0;
+    private emptyVao: WebGLVertexArrayObject;
+
+    constructor(gl: WebGL2RenderingContext) {
+        this.gl = gl;
+        this.shader = new Shader(gl, Shader.FULLSCREEN_VERTEX, WARP_FRAGMENT);
+        this.target = new RenderTarget(gl, [gl.RGBA8]);
+        this.emptyVao = gl.createVertexArray();
+    }
+
+    public get active(): boolean {
+        return this.mode === 'always' || (this.mode === 'auto' && this.gpuBound);
+    }
+
+    // Full renders and warps alternate while active, so full renders arrive at half the display rate
+    public shouldWarp(): boolean {
+        const warp = this.active && this.hasSource && !this.lastWarped;
+
+        this.lastWarped = warp;
+
+        return warp;
+    }
+
+    // GPU time of a full render, with hysteresis so the mode does not flicker at the edge
+    public sampleGpu(ms: number): void {
+        this.fullFrameGpu = this.fullFrameGpu === 0 ? ms : this.fullFrameGpu * 0.9 + ms * 0.1;
+
+        if (!this.gpuBound && this.fullFrameGpu > this.targetInterval * 0.95) {
+            this.gpuBound = true;
+        } else if (this.gpuBound && this.fullFrameGpu < this.targetInterval * 0.6) {
+            this.gpuBound = false;
+        }
+    }
+
+    // Called after a full render, the scene target now holds the frame later warps start from
+    public capture(camera: Camera): void {
+        this.sourceViewProjection.set(camera.viewProjection);
+        this.sourceInverse.set(camera.inverseViewProjection);
+        this.hasSource = true;
+    }
+
+    public warp(scene: RenderTarget, camera: Camera): RenderTarget {
+        const gl = this.gl;
+        const shader = this.shader;
+
+        Camera.multiply(this.currentToSource, this.sourceViewProjection, camera.inverseViewProjection);
+        Camera.multiply(this.sourceToCurrent, camera.viewProjection, this.sourceInverse);
+
+        this.target.resize(scene.width, scene.height);
+        this.target.bind();
+
+        gl.disable(gl.DEPTH_TEST);
+        gl.bindVertexArray(this.emptyVao);
+        shader.use();
+
+        gl.activeTexture(gl.TEXTURE0);
+        gl.bindTexture(gl.TEXTURE_2D, scene.texture);
+        gl.uniform1i(shader.uniform('color'), 0);
+        gl.activeTexture(gl.TEXTURE1);
+        gl.bindTexture(gl.TEXTURE_2D, scene.depth);
+        gl.uniform1i(shader.uniform('depth'), 1);
+
+        gl.uniformMatrix4fv(shader.uniform('currentToSource'), false, this.currentToSource);
+        gl.uniformMatrix4fv(shader.uniform('sourceToCurrent'), false, this.sourceToCurrent);
+        gl.uniform2f(shader.uniform('texel'), 1 / scene.width, 1 / scene.height);
+        gl.drawArrays(gl.TRIANGLES, 0, 3);
+
+        gl.bindVertexArray(null);
+        gl.activeTexture(gl.TEXTURE0);
+        gl.enable(gl.DEPTH_TEST);
+
+        this.warpedFrames++;
+
+        return this.target;
+    }
+
+    public dispose(): void {
+        this.shader.dispose();
+        this.target.dispose();
+        this.gl.deleteVertexArray(this.emptyVao);
+    }
+}
+
+export type { ExtrapolationMode };
+export default FrameExtrapolator;
@@ -0,0 +1,682 @@
+interface VertexAttribute {
+    location: number;
+    size: number;
+    type: number;
+    normalized: boolean;
+    offset: number;
+}
+
+interface VertexFormat {
+    name: string;
+    stride: number;
+    attributes: VertexAttribute[];
+}
+
+interface ArenaBlock {
+    offset: number;
+    size: number;
+}
+
+interface ArenaMesh {
+    pool: ArenaPool;
+    firstVertex: number;
+    vertexCount: number;
+    firstIndex: number;
+    indexCount: number;
+    // Middle of the bounds, the sort key for front to back ordering
+    center: Float32Array;
+    // Kept only when indices have to be rebased on the CPU (no base vertex extension)
+    localIndices: Uint32Array | null;
+}
+
+interface DrawList {
+    material: number;
+    count: number;
+    counts: Int32Array;
+    offsets: Int32Array;
+    instanceCounts: Int32Array;
+    baseVertices: Int32Array;
+    baseInstances: Uint32Array;
+    centers: Float32Array;
+    // Distance to the nearest queued draw, set by sort()
+    nearest: number;
+}
+
+interface PoolQueue {
+    lists: Map<number, DrawList>;
+    // Submission order, insertion order until sort() reorders it
+    order: DrawList[];
+}
+
+// Not part of lib.dom yet
+interface WEBGL_multi_draw_instanced_base_vertex_base_instance {
+    multiDrawElementsInstancedBaseVertexBaseInstanceWEBGL(
+        mode: GLenum,
+        counts: Int32Array, countsOffset: number,
+        type: GLenum,
+        offsets: Int32Array, offsetsOffset: number,
+        instanceCounts: Int32Array, instanceCountsOffset: number,
+        baseVertices: Int32Array, baseVerticesOffset: number,
+        baseInstances: Uint32Array, baseInstancesOffset: number,
+        drawCount: number
+    ): void;
+}
+
+const INDEX_BYTES = 4;
+const DEFAULT_VERTEX_CAPACITY = 1 << 16;
+const DEFAULT_INDEX_CAPACITY = 1 << 18;
+const DEFRAG_THRESHOLD = 0.25;
+
+class FreeList {
+    public capacity: number;
+    private blocks: ArenaBlock[];
+
+    constructor(capacity: number) {
+        this.capacity = capacity;
+        this.blocks = [{ offset: 0, size: capacity }];
+    }
+
+    // Empty ranges take no space and are never listed, a zero size block would stop neighbours from merging
+    public allocate(size: number): number {
+        if (size <= 0) {
+            return 0;
+        }
+
+        for (let i = 0; i < this.blocks.length; i++) {
+            const block = this.blocks[i];
+
+            if (block.size < size) {
+                continue;
+            }
+
+            const offset = block.offset;
+
+            if (block.size === size) {
+                this.blocks.splice(i, 1);
+            } else {
+                block.offset += size;
+                block.size -= size;
+            }
+
+            return offset;
+        }
+
+        return -1;
+    }
+
+    public release(offset: number, size: number): void {
+        if (size <= 0) {
+            return;
+        }
+
+        let i = 0;
+
+        while (i < this.blocks.length && this.blocks[i].offset < offset) {
+            i++;
+        }
+
+        this.blocks.splice(i, 0, { offset, size });
+
+        const next = this.blocks[i + 1];
+
+        if (next && offset + size === next.offset) {
+            this.blocks[i].size += next.size;
+            this.blocks.splice(i + 1, 1);
+        }
+
+        const prev = this.blocks[i - 1];
+
+        if (prev && prev.offset + prev.size === offset) {
+            prev.size += this.blocks[i].size;
+            this.blocks.splice(i, 1);
+        }
+    }
+
+    public grow(capacity: number): void {
+        const tail = this.blocks[this.blocks.length - 1];
+
+        if (tail && tail.offset + tail.size === this.capacity) {
+            tail.size += capacity - this.capacity;
+        } else {
+            this.blocks.push({ offset: this.capacity, size: capacity - this.capacity });
+        }
+
+        this.capacity = capacity;
+    }
+
+    public reset(used: number): void {
+        this.blocks = used < this.capacity ? [{ offset: used, size: this.capacity - used }] : [];
+    }
+
+    public get free(): number {
+        let total = 0;
+
+        for (const block of this.blocks) {
+            total += block.size;
+        }
+
+        return total;
+    }
+
+    public get largest(): number {
+        let largest = 0;
+
+        for (const block of this.blocks) {
+            largest = Math.max(largest, block.size);
+        }
+
+        return largest;
+    }
+
+    // Share of the capacity that is free but not part of the largest block
+    public get fragmentation(): number {
+        return (this.free - this.largest) / this.capacity;
+    }
+}
+
+class ArenaPool {
+    public readonly format: VertexFormat;
+    public vao: WebGLVertexArrayObject;
+    public vbo: WebGLBuffer;
+    public ibo: WebGLBuffer;
+    public readonly vertices: FreeList;
+    public readonly indices: FreeList;
+    public readonly meshes: Set<ArenaMesh> = new Set();
+
+    constructor(gl: WebGL2RenderingContext, format: VertexFormat, vertexCapacity: number, indexCapacity: number) {
+        this.format = format;
+        this.vertices = new FreeList(vertexCapacity);
+        this.indices = new FreeList(indexCapacity);
+        this.vao = gl.createVertexArray();
+        this.vbo = gl.createBuffer();
+        this.ibo = gl.createBuffer();
+        this.createStorage(gl, this.vbo, this.ibo, vertexCapacity, indexCapacity);
+    }
+
+    public createStorage(gl: WebGL2RenderingContext, vbo: WebGLBuffer, ibo: WebGLBuffer, vertexCapacity: number, indexCapacity: number): void {
+        gl.bindVertexArray(this.vao);
+
+        gl.bindBuffer(gl.ARRAY_BUFFER, vbo);
+        gl.bufferData(gl.ARRAY_BUFFER, vertexCapacity * this.format.stride, gl.STATIC_DRAW);
+
+        for (const attribute of this.format.attributes) {
+            gl.enableVertexAttribArray(attribute.location);
+
+            if (attribute.type === gl.FLOAT || attribute.type === gl.HALF_FLOAT || attribute.normalized) {
+                gl.vertexAttribPointer(attribute.location, attribute.size, attribute.type, attribute.normalized, this.format.stride, attribute.offset);
+            } else {
+                gl.vertexAttribIPointer(attribute.location, attribute.size, attribute.type, this.format.stride, attribute.offset);
+            }
+        }
+
+        gl.bindBuffer(gl.ELEMENT_ARRAY_BUFFER, ibo);
+        gl.bufferData(gl.ELEMENT_ARRAY_BUFFER, indexCapacity * INDEX_BYTES, gl.STATIC_DRAW);
+
+        gl.bindVertexArray(null);
+        gl.bindBuffer(gl.ARRAY_BUFFER, null);
+    }
+}
+
+class GeometryArena {
+    // Flushes that submitted anything, the difference between two frames is the passes over the arena
+    public flushes: number = 0;
+
+    private gl: WebGL2RenderingContext;
+    private multiDraw: WEBGL_multi_draw | null;
+    private baseVertex: WEBGL_multi_draw_instanced_base_vertex_base_instance | null;
+    private pools: Map<string, ArenaPool> = new Map();
+    private queue: Map<ArenaPool, PoolQueue> = new Map();
+    private sortKeys: Float32Array = new Float32Array(0);
+    private sortOrder: Uint32Array = new Uint32Array(0);
+    private sortScratch: DrawList = GeometryArena.createDrawList(-1, 0);
+
+    constructor(gl: WebGL2RenderingContext) {
+        this.gl = gl;
+        this.multiDraw = gl.getExtension('WEBGL_multi_draw');
+        this.baseVertex = gl.getExtension('WEBGL_multi_draw_instanced_base_vertex_base_instance') as WEBGL_multi_draw_instanced_base_vertex_base_instance | null;
+    }
+
+    public allocate(format: VertexFormat, vertices: ArrayBufferView, indices: Uint32Array): ArenaMesh {
+        const gl = this.gl;
+        const pool = this.getPool(format);
+        const vertexCount = vertices.byteLength / format.stride;
+
+        if (!Number.isInteger(vertexCount)) {
+            throw new Error(`Vertex Data does not match the Stride of Format '${format.name}'.`);
+        }
+
+        let firstVertex = pool.vertices.allocate(vertexCount);
+        let firstIndex = pool.indices.allocate(indices.length);
+
+        if (firstVertex < 0 || firstIndex < 0) {
+            if (firstVertex >= 0) {
+                pool.vertices.release(firstVertex, vertexCount);
+            }
+
+            if (firstIndex >= 0) {
+                pool.indices.release(firstIndex, indices.length);
+            }
+
+            this.grow(pool, vertexCount, indices.length);
+
+            firstVertex = pool.vertices.allocate(vertexCount);
+            firstIndex = pool.indices.allocate(indices.length);
+        }
+
+        const mesh: ArenaMesh = {
+            pool,
+            firstVertex,
+            vertexCount,
+            firstIndex,
+            indexCount: indices.length,
+            center: GeometryArena.centerOf(format, vertices),
+            localIndices: this.baseVertex ? null : indices.slice()
+        };
+
+        gl.bindBuffer(gl.COPY_WRITE_BUFFER, pool.vbo);
+        gl.bufferSubData(gl.COPY_WRITE_BUFFER, firstVertex * format.stride, vertices);
+        this.uploadIndices(mesh, indices);
+        gl.bindBuffer(gl.COPY_WRITE_BUFFER, null);
+
+        pool.meshes.add(mesh);
+
+        return mesh;
+    }
+
+    public release(mesh: ArenaMesh): void {
+        const pool = mesh.pool;
+
+        if (!pool.meshes.delete(mesh)) {
+            return;
+        }
+
+        pool.vertices.release(mesh.firstVertex, mesh.vertexCount);
+        pool.indices.release(mesh.firstIndex, mesh.indexCount);
+        mesh.localIndices = null;
+    }
+
+    public draw(mesh: ArenaMesh, material: number, instances: number = 1): void {
+        let pool = this.queue.get(mesh.pool);
+
+        if (!pool) {
+            pool = { lists: new Map(), order: [] };
+            this.queue.set(mesh.pool, pool);
+        }
+
+        let list = pool.lists.get(material);
+
+        if (!list) {
+            list = GeometryArena.createDrawList(material, 64);
+            pool.lists.set(material, list);
+            pool.order.push(list);
+        }
+
+        if (list.count === list.counts.length) {
+            GeometryArena.growDrawList(list);
+        }
+
+        const i = list.count++;
+
+        list.centers.set(mesh.center, i * 3);
+
+        list.counts[i] = mesh.indexCount;
+        list.offsets[i] = mesh.firstIndex * INDEX_BYTES;
+        list.instanceCounts[i] = instances;
+        list.baseVertices[i] = mesh.firstVertex;
+        list.baseInstances[i] = 0;
+    }
+
+    // Submits every queued draw, one call per pool and material when multi draw is available
+    // keep leaves the queue intact for another submission in the same frame, e.g. a second viewport
+    public flush(bindMaterial: (material: number) => void, keep: boolean = false): number {
+        const gl = this.gl;
+        let calls = 0;
+
+        for (const [pool, { order }] of this.queue) {
+            gl.bindVertexArray(pool.vao);
+
+            for (const list of order) {
+                if (list.count === 0) {
+                    continue;
+                }
+
+                bindMaterial(list.material);
+                calls += this.submit(list);
+
+                if (!keep) {
+                    list.count = 0;
+                }
+            }
+        }
+
+        gl.bindVertexArray(null);
+
+        if (calls > 0) {
+            this.flushes++;
+        }
+
+        return calls;
+    }
+
+    // Drops queued draws without submitting them, for frames that skip the scene render
+    public discard(): void {
+        for (const { order } of this.queue.values()) {
+            for (const list of order) {
+                list.count = 0;
+            }
+        }
+    }
+
+    // Orders the queued draws front to back from eye, so early depth rejects what is hidden
+    //
+    // Draws stay batched by material, so this is approximate: materials go by their nearest draw and
+    // the draws inside each multi draw go by distance.
+    public sort(eye: Float32Array): void {
+        for (const { order } of this.queue.values()) {
+            for (const list of order) {
+                if (list.count > 0) {
+                    this.sortList(list, eye);
+                }
+            }
+
+            order.sort((a, b) => a.nearest - b.nearest);
+        }
+    }
+
+    // Compacts pools whose free space has become too scattered to serve large meshes
+    // Stops at the deadline, the rest are looked at in a later call
+    public maintain(deadline: number = Infinity): void {
+        for (const pool of this.pools.values()) {
+            if (performance.now() > deadline) {
+                return;
+            }
+
+            if (pool.vertices.fragmentation > DEFRAG_THRESHOLD || pool.indices.fragmentation > DEFRAG_THRESHOLD) {
+                this.defragment(pool);
+            }
+        }
+    }
+
+    public defragment(pool: ArenaPool): void {
+        this.relocate(pool, pool.vertices.capacity, pool.indices.capacity);
+    }
+
+    public get stats(): { pools: number; meshes: number; vertexBytes: number; indexBytes: number } {
+        let meshes = 0;
+        let vertexBytes = 0;
+        let indexBytes = 0;
+
+        for (const pool of this.pools.values()) {
+            meshes += pool.meshes.size;
+            vertexBytes += pool.vertices.capacity * pool.format.stride;
+            indexBytes += pool.indices.capacity * INDEX_BYTES;
+        }
+
+        return { pools: this.pools.size, meshes, vertexBytes, indexBytes };
+    }
+
+    public dispose(): void {
+        const gl = this.gl;
+
+        for (const pool of this.pools.values()) {
+            gl.deleteVertexArray(pool.vao);
+            gl.deleteBuffer(pool.vbo);
+            gl.deleteBuffer(pool.ibo);
+        }
+
+        this.pools.clear();
+        this.queue.clear();
+    }
+
+    private submit(list: DrawList): number {
+        const gl = this.gl;
+
+        if (this.baseVertex) {
+            this.baseVertex.multiDrawElementsInstancedBaseVertexBaseInstanceWEBGL(
+                gl.TRIANGLES,
+                list.counts, 0,
+                gl.UNSIGNED_INT,
+                list.offsets, 0,
+                list.instanceCounts, 0,
+                list.baseVertices, 0,
+                list.baseInstances, 0,
+                list.count
+            );
+
+            return 1;
+        }
+
+        if (this.multiDraw) {
+            this.multiDraw.multiDrawElementsInstancedWEBGL(
+                gl.TRIANGLES,
+                list.counts, 0,
+                gl.UNSIGNED_INT,
+                list.offsets, 0,
+                list.instanceCounts, 0,
+                list.count
+            );
+
+            return 1;
+        }
+
+        for (let i = 0; i < list.count; i++) {
+            gl.drawElementsInstanced(gl.TRIANGLES, list.counts[i], gl.UNSIGNED_INT, list.offsets[i], list.instanceCounts[i]);
+        }
+
+        return list.count;
+    }
+
+    private sortList(list: DrawList, eye: Float32Array): void {
+        const count = list.count;
+
+        if (this.sortKeys.length < count) {
+            this.sortKeys = new Float32Array(list.counts.length);
+            this.sortOrder = new Uint32Array(list.counts.length);
+            this.sortScratch = GeometryArena.createDrawList(-1, list.counts.length);
+        }
+
+        const keys = this.sortKeys;
+        const order = this.sortOrder.subarray(0, count);
+        const centers = list.centers;
+
+        for (let i = 0; i < count; i++) {
+            const dx = centers[i * 3] - eye[0];
+            const dy = centers[i * 3 + 1] - eye[1];
+            const dz = centers[i * 3 + 2] - eye[2];
+
+            keys[i] = dx * dx + dy * dy + dz * dz;
+            order[i] = i;
+        }
+
+        order.sort((a, b) => keys[a] - keys[b]);
+        list.nearest = keys[order[0]];
+
+        // Permuted through a scratch list, every array of the entry moves together
+        const scratch = this.sortScratch;
+
+        for (let i = 0; i < count; i++) {
+            const from = order[i];
+
+            scratch.counts[i] = list.counts[from];
+            scratch.offsets[i] = list.offsets[from];
+            scratch.instanceCounts[i] = list.instanceCounts[from];
+            scratch.baseVertices[i] = list.baseVertices[from];
+            scratch.baseInstances[i] = list.baseInstances[from];
+            scratch.centers.set(list.centers.subarray(from * 3, from * 3 + 3), i * 3);
+        }
+
+        list.counts.set(scratch.counts.subarray(0, count));
+        list.offsets.set(scratch.offsets.subarray(0, count));
+        list.instanceCounts.set(scratch.instanceCounts.subarray(0, count));
+        list.baseVertices.set(scratch.baseVertices.subarray(0, count));
+        list.baseInstances.set(scratch.baseInstances.subarray(0, count));
+        list.centers.set(scratch.centers.subarray(0, count * 3));
+    }
+
+    private getPool(format: VertexFormat): ArenaPool {
+        let pool = this.pools.get(format.name);
+
+        if (!pool) {
+            pool = new ArenaPool(this.gl, format, DEFAULT_VERTEX_CAPACITY, DEFAULT_INDEX_CAPACITY);
+            this.pools.set(format.name, pool);
+        } else if (pool.format.stride !== format.stride) {
+            throw new Error(`Vertex Format '${format.name}' was Registered with a different Stride.`);
+        }
+
+        return pool;
+    }
+
+    private grow(pool: ArenaPool, vertexCount: number, indexCount: number): void {
+        let vertexCapacity = pool.vertices.capacity;
+        let indexCapacity = pool.indices.capacity;
+
+        while (vertexCapacity - (pool.vertices.capacity - pool.vertices.free) < vertexCount) {
+            vertexCapacity *= 2;
+        }
+
+        while (indexCapacity - (pool.indices.capacity - pool.indices.free) < indexCount) {
+            indexCapacity *= 2;
+        }
+
+        // Growing copies everything anyway, so pack the live meshes at the same time
+        this.relocate(pool, vertexCapacity, indexCapacity);
+    }
+
+    // Moves every live mesh of a pool into fresh, tightly packed buffers
+    private relocate(pool: ArenaPool, vertexCapacity: number, indexCapacity: number): void {
+        const gl = this.gl;
+        const stride = pool.format.stride;
+        const vbo = gl.createBuffer();
+        const ibo = gl.createBuffer();
+
+        pool.createStorage(gl, vbo, ibo, vertexCapacity, indexCapacity);
+
+        let vertexCursor = 0;
+        let indexCursor = 0;
+
+        gl.bindBuffer(gl.COPY_READ_BUFFER, pool.vbo);
+        gl.bindBuffer(gl.COPY_WRITE_BUFFER, vbo);
+
+        for (const mesh of pool.meshes) {
+            gl.copyBufferSubData(gl.COPY_READ_BUFFER, gl.COPY_WRITE_BUFFER, mesh.firstVertex * stride, vertexCursor * stride, mesh.vertexCount * stride);
+            mesh.firstVertex = vertexCursor;
+            vertexCursor += mesh.vertexCount;
+        }
+
+        gl.bindBuffer(gl.COPY_READ_BUFFER, pool.ibo);
+        gl.bindBuffer(gl.COPY_WRITE_BUFFER, ibo);
+
+        for (const mesh of pool.meshes) {
+            if (mesh.localIndices) {
+                mesh.firstIndex = indexCursor;
+                this.writeIndices(mesh, mesh.localIndices);
+            } else {
+                gl.copyBufferSubData(gl.COPY_READ_BUFFER, gl.COPY_WRITE_BUFFER, mesh.firstIndex * INDEX_BYTES, indexCursor * INDEX_BYTES, mesh.indexCount * INDEX_BYTES);
+                mesh.firstIndex = indexCursor;
+            }
+
+            indexCursor += mesh.indexCount;
+        }
+
+        gl.bindBuffer(gl.COPY_READ_BUFFER, null);
+        gl.bindBuffer(gl.COPY_WRITE_BUFFER, null);
+
+        gl.deleteBuffer(pool.vbo);
+        gl.deleteBuffer(pool.ibo);
+
+        pool.vbo = vbo;
+        pool.ibo = ibo;
+        pool.vertices.grow(vertexCapacity);
+        pool.indices.grow(indexCapacity);
+        pool.vertices.reset(vertexCursor);
+        pool.indices.reset(indexCursor);
+    }
+
+    private uploadIndices(mesh: ArenaMesh, indices: Uint32Array): void {
+        const gl = this.gl;
+
+        gl.bindBuffer(gl.COPY_WRITE_BUFFER, mesh.pool.ibo);
+        this.writeIndices(mesh, indices);
+    }
+
+    // Expects the destination index buffer bound to COPY_WRITE_BUFFER
+    private writeIndices(mesh: ArenaMesh, indices: Uint32Array): void {
+        const gl = this.gl;
+        let data = indices;
+
+        if (!this.baseVertex && mesh.firstVertex !== 0) {
+            data = new Uint32Array(indices.length);
+
+            for (let i = 0; i < indices.length; i++) {
+                data[i] = indices[i] + mesh.firstVertex;
+            }
+        }
+
+        gl.bufferSubData(gl.COPY_WRITE_BUFFER, mesh.firstIndex * INDEX_BYTES, data);
+    }
+
+    // Bounds centre from the float position at location 0, the origin for formats without one
+    private static centerOf(format: VertexFormat, vertices: ArrayBufferView): Float32Array {
+        const center = new Float32Array(3);
+        const position = format.attributes.find((attribute) => attribute.location === 0);
+
+        if (!position || position.type !== WebGL2RenderingContext.FLOAT || position.size < 3) {
+            return center;
+        }
+
+        const view = new DataView(vertices.buffer, vertices.byteOffset, vertices.byteLength);
+        const min = [Infinity, Infinity, Infinity];
+        const max = [-Infinity, -Infinity, -Infinity];
+
+        for (let at = position.offset; at + 12 <= vertices.byteLength; at += format.stride) {
+            for (let k = 0; k < 3; k++) {
+                const value = view.getFloat32(at + k * 4, true);
+
+                min[k] = Math.min(min[k], value);
+                max[k] = Math.max(max[k], value);
+            }
+        }
+
+        for (let k = 0; k < 3; k++) {
+            center[k] = min[k] <= max[k] ? (min[k] + max[k]) / 2 : 0;
+        }
+
+        return center;
+    }
+
+    private static createDrawList(material: number, capacity: number): DrawList {
+        return {
+            material,
+            count: 0,
+            counts: new Int32Array(capacity),
+            offsets: new Int32Array(capacity),
+            instanceCounts: new Int32Array(capacity),
+            baseVertices: new Int32Array(capacity),
+            baseInstances: new Uint32Array(capacity),
+            centers: new Float32Array(capacity * 3),
+            nearest: 0
+        };
+    }
+
+    // In place, the list stays where the queue and its submission order refer to it
+    private static growDrawList(list: DrawList): void {
+        const grown = GeometryArena.createDrawList(list.material, list.counts.length * 2);
+
+        grown.counts.set(list.counts);
+        grown.offsets.set(list.offsets);
+        grown.instanceCounts.set(list.instanceCounts);
+        grown.baseVertices.set(list.baseVertices);
+        grown.baseInstances.set(list.baseInstances);
+        grown.centers.set(list.centers);
+
+        list.counts = grown.counts;
+        list.offsets = grown.offsets;
+        list.instanceCounts = grown.instanceCounts;
+        list.baseVertices = grown.baseVertices;
+        list.baseInstances = grown.baseInstances;
+        list.centers = grown.centers;
+    }
+}
+
+export type { VertexFormat, VertexAttribute, ArenaMesh };
+export default GeometryArena;
@@ -0,0 +1,407 @@
+// Source level GLSL ES 3.00 optimizer, run on shader template literals at build time (see vite.config.ts)
+// and on captured shader sources by the replayer, which times both variants against each other
+//
+// Only rewrites that cannot change what the driver compiles: comments and whitespace go, literal
+// arithmetic is folded, and functions, uniforms and constants nothing reaches are dropped. Inlining
+// is left to the driver, which does it after linking anyway. Lowering precision is opt in, the
+// replayer measures it but the build never applies it on its own.
+
+interface GlslOptions {
+    // Names that stand for text spliced in later, e.g. template literal placeholders
+    // Their content is unknown, so nothing that code in them could reference is dropped
+    opaque?: string[];
+    // Rewrites precision highp float to mediump in fragment shaders
+    lowerPrecision?: boolean;
+}
+
+interface GlslResult {
+    source: string;
+    folded: number;
+    removedFunctions: string[];
+    removedGlobals: string[];
+}
+
+type TokenKind = 'word' | 'number' | 'symbol' | 'directive';
+
+interface Token {
+    kind: TokenKind;
+    text: string;
+}
+
+// Longest first, so the lexer takes <<= before << before <
+const OPERATORS = ['<<=', '>>=', '++', '--', '<=', '>=', '==', '!=', '&&', '||', '^^', '+=', '-=', '*=', '/=', '%=', '&=', '|=', '^=', '<<', '>>'];
+// A literal expression between these on both sides is a whole operand
+const OPEN = new Set(['(', ',', '=', '[', '?', ':', 'return']);
+const CLOSE = new Set([')', ',', ';', ']', ':']);
+
+const lex = (source: string): Token[] => {
+    const tokens: Token[] = [];
+    let i = 0;
+    let lineStart = true;
+
+    while (i < source.length) {
+        const c = source[i];
+
+        if (c === '\n') {
+            lineStart = true;
+            i++;
+        } else if (c === ' ' || c === '\t' || c === '\r') {
+            i++;
+        } else if (source.startsWith('//', i)) {
+            i = source.indexOf('\n', i);
+            i = i < 0 ? source.length : i;
+        } else if (source.startsWith('/*', i)) {
+            i = source.indexOf('*/', i + 2);
+            i = i < 0 ? source.length : i + 2;
+        } else if (c === '#' && lineStart) {
+            // Directives run to the end of the line, with backslash continuations
+            let end = i;
+
+            while (end < source.length && (source[end] !== '\n' || source[end - 1] === '\\')) {
+                end++;
+            }
+
+            tokens.push({ kind: 'directive', text: source.slice(i, end).replace(/\/\/.*$/, '').trim() });
+            i = end;
+        } else {
+            const word = /^[A-Za-z_]\w*/.exec(source.slice(i, i + 256));
+            const number = /^(?:0[xX][0-9a-fA-F]+[uU]?|(?:\d+\.\d*|\.\d+|\d+)(?:[eE][+-]?\d+)?[uU]?)/.exec(source.slice(i, i + 64));
+
+            if (word) {
+                tokens.push({ kind: 'word', text: word[0] });
+                i += word[0].length;
+            } else if (number) {
+                tokens.push({ kind: 'number', text: number[0] });
+                i += number[0].length;
+            } else {
+                const operator = OPERATORS.find((op) => source.startsWith(op, i)) ?? c;
+
+                tokens.push({ kind: 'symbol', text: operator });
+                i += operator.length;
+            }
+
+            lineStart = false;
+        }
+    }
+
+    return tokens;
+};
+
+const isFloat = (text: string): boolean => /[.eE]/.test(text) && !/^0[xX]/.test(text);
+
+// Shortest text that reads back as the same 32 bit float
+const formatFloat = (value: number): string => {
+    const single = Math.fround(value);
+    let text = String(single);
+
+    for (let digits = 1; digits <= 9; digits++) {
+        const candidate = single.toPrecision(digits);
+
+        if (Math.fround(Number(candidate)) === single) {
+            text = String(Number(candidate));
+            break;
+        }
+    }
+
+    return /[.e]/.test(text) ? text : `${text}.0`;
+};
+
+// a op b with literal operands, where the neighbours make it a whole operand, and (literal) outside calls
+const fold = (tokens: Token[]): number => {
+    let folded = 0;
+    let changed = true;
+
+    while (changed) {
+        changed = false;
+
+        for (let i = 1; i + 3 < tokens.length; i++) {
+            const [before, a, op, b, after] = tokens.slice(i - 1, i + 4);
+
+            if (a.kind !== 'number' || b.kind !== 'number' || !'+-*/'.includes(op.text) || op.text.length !== 1) {
+                continue;
+            }
+
+            if (!OPEN.has(before.text) || !CLOSE.has(after.text) || isFloat(a.text) !== isFloat(b.text) || /[uUxX]/.test(a.text + b.text)) {
+                continue;
+            }
+
+            const x = Number(a.text);
+            const y = Number(b.text);
+            const float = isFloat(a.text);
+
+            if (!float && op.text === '/' && y === 0) {
+                continue;
+            }
+
+            const value = op.text === '+' ? x + y : op.text === '-' ? x - y : op.text === '*' ? x * y : float ? x / y : Math.trunc(x / y);
+            const text = float ? formatFloat(value) : String(value | 0);
+
+            // A negative result after ( or = is fine, the sign joins the literal as unary minus
+            tokens.splice(i, 3, ...(value < 0 ? [{ kind: 'symbol' as const, text: '-' }, { kind: 'number' as const, text: text.slice(1) }] : [{ kind: 'number' as const, text }]));
+            folded++;
+            changed = true;
+        }
+
+        for (let i = 1; i + 2 < tokens.length; i++) {
+            const [before, open, value, close] = tokens.slice(i - 1, i + 3);
+
+            if (open.text === '(' && value.kind === 'number' && close.text === ')' && before.kind === 'symbol' && before.text !== ')' && before.text !== ']') {
+                tokens.splice(i, 3, value);
+                changed = true;
+            }
+        }
+    }
+
+    return folded;
+};
+
+interface Definition {
+    // Every declarator of the statement, it stays while any one of them is reached
+    names: string[];
+    start: number;
+    end: number;
+    kind: 'function' | 'global';
+    // Words used inside, for the reachability walk
+    uses: Set<string>;
+}
+
+// Function definitions and prototypes, plain uniform and const declarations, all at global scope
+const definitions = (tokens: Token[]): Definition[] => {
+    const found: Definition[] = [];
+    let depth = 0;
+    let statement = 0;
+
+    for (let i = 0; i < tokens.length; i++) {
+        const token = tokens[i];
+
+        if (token.kind === 'directive') {
+            statement = i + 1;
+            continue;
+        }
+
+        if (token.text === '{') {
+            // name ( ... ) { at global scope is a function body
+            if (depth === 0 && tokens[i - 1]?.text === ')') {
+                let open = i - 1;
+                let nesting = 0;
+
+                for (; open >= 0; open--) {
+                    nesting += tokens[open].text === ')' ? 1 : tokens[open].text === '(' ? -1 : 0;
+
+                    if (nesting === 0) {
+                        break;
+                    }
+                }
+
+                const name = tokens[open - 1];
+                let close = i;
+
+                for (let level = 0; close < tokens.length; close++) {
+                    level += tokens[close].text === '{' ? 1 : tokens[close].text === '}' ? -1 : 0;
+
+                    if (level === 0) {
+                        break;
+                    }
+                }
+
+                if (name?.kind === 'word') {
+                    found.push({ names: [name.text], start: statement, end: close + 1, kind: 'function', uses: wordsIn(tokens, open, close) });
+                }
+
+                i = close;
+                statement = close + 1;
+                continue;
+            }
+
+            depth++;
+        } else if (token.text === '}') {
+            depth--;
+        } else if (token.text === ';' && depth === 0) {
+            const words = tokens.slice(statement, i);
+            const first = words[0]?.text;
+            const last = words[words.length - 1];
+
+            if (first === 'uniform' && last?.kind === 'word' && !words.some((word) => word.text === '{' || word.text === '[')) {
+                // uniform float a, b; names the last word of each declarator
+                const names = declarators(words).map((declarator) => declarator[declarator.length - 1]);
+
+                if (names.every((name) => name?.kind === 'word')) {
+                    found.push({ names: names.map((name) => name.text), start: statement, end: i + 1, kind: 'global', uses: new Set() });
+                }
+            } else if (first === 'const' && words[2]?.kind === 'word' && words[3]?.text === '=') {
+                // const float A = 1.0, B = A; names the word before each declarator's =
+                const names = declarators(words).map((declarator) => declarator[declarator.findIndex((word) => word.text === '=') - 1]);
+
+                if (names.every((name) => name?.kind === 'word')) {
+                    found.push({ names: names.map((name) => name.text), start: statement, end: i + 1, kind: 'global', uses: wordsIn(tokens, statement + 3, i) });
+                }
+            } else if (last?.text === ')' && words.some((word) => word.text === '(')) {
+                // Prototype, dropped together with its function
+                const name = words[words.findIndex((word) => word.text === '(') - 1];
+
+                if (name?.kind === 'word') {
+                    found.push({ names: [name.text], start: statement, end: i + 1, kind: 'function', uses: new Set() });
+                }
+            }
+
+            statement = i + 1;
+        }
+    }
+
+    return found;
+};
+
+// Splits a declaration at its top level commas, commas inside constructor calls stay with their declarator
+const declarators = (words: Token[]): Token[][] => {
+    const parts: Token[][] = [[]];
+    let nesting = 0;
+
+    for (const word of words) {
+        nesting += word.text === '(' ? 1 : word.text === ')' ? -1 : 0;
+
+        if (word.text === ',' && nesting === 0) {
+            parts.push([]);
+        } else {
+            parts[parts.length - 1].push(word);
+        }
+    }
+
+    return parts;
+};
+
+const wordsIn = (tokens: Token[], start: number, end: number): Set<string> => {
+    const words = new Set<string>();
+
+    for (let i = start; i < end; i++) {
+        if (tokens[i].kind === 'word') {
+            words.add(tokens[i].text);
+        } else if (tokens[i].kind === 'directive') {
+            for (const word of tokens[i].text.match(/[A-Za-z_]\w*/g) ?? []) {
+                words.add(word);
+            }
+        }
+    }
+
+    return words;
+};
+
+// Walks from main and everything outside the removable definitions, drops what was never reached
+const eliminate = (tokens: Token[], result: GlslResult): Token[] => {
+    const found = definitions(tokens);
+    const inside = new Uint8Array(tokens.length);
+
+    for (const definition of found) {
+        inside.fill(1, definition.start, definition.end);
+    }
+
+    const roots = new Set<string>(['main']);
+
+    tokens.forEach((token, i) => {
+        if (!inside[i]) {
+            for (const word of wordsIn(tokens, i, i + 1)) {
+                roots.add(word);
+            }
+        }
+    });
+
+    const reached = new Set<string>();
+    const queue = [...roots];
+
+    while (queue.length > 0) {
+        const name = queue.pop()!;
+
+        if (reached.has(name)) {
+            continue;
+        }
+
+        reached.add(name);
+
+        for (const definition of found) {
+            if (definition.names.includes(name)) {
+                queue.push(...definition.uses);
+            }
+        }
+    }
+
+    const dropped = found.filter((definition) => !definition.names.some((name) => reached.has(name)));
+
+    for (const definition of dropped) {
+        (definition.kind === 'function' ? result.removedFunctions : result.removedGlobals).push(...definition.names);
+        inside.fill(2, definition.start, definition.end);
+    }
+
+    return tokens.filter((_, i) => inside[i] !== 2);
+};
+
+// Vertex shaders write gl_Position or read attributes, transform feedback ones may only do the latter
+const isFragment = (source: string): boolean => !/\bgl_(Position|PointSize|VertexID|InstanceID)\b|layout\s*\(\s*location\s*=\s*\d+\s*\)\s*in\b/.test(source);
+
+const lowerPrecision = (source: string, tokens: Token[]): void => {
+    if (!isFragment(source)) {
+        return;
+    }
+
+    tokens.forEach((token, i) => {
+        if (token.text === 'highp' && tokens[i - 1]?.text === 'precision' && tokens[i + 1]?.text === 'float') {
+            token.text = 'mediump';
+        }
+    });
+};
+
+// Spaces only where two tokens would otherwise run together, directives keep their own lines
+const print = (tokens: Token[]): string => {
+    let out = '';
+    let previous: Token | null = null;
+
+    for (const token of tokens) {
+        if (token.kind === 'directive') {
+            out += (out === '' || out.endsWith('\n') ? '' : '\n') + token.text + '\n';
+            previous = null;
+            continue;
+        }
+
+        if (previous) {
+            const words = previous.kind !== 'symbol' && token.kind !== 'symbol';
+            const pair = previous.text.slice(-1) + token.text[0];
+            const joined = previous.kind === 'symbol' && token.kind === 'symbol' && (pair === '//' || pair === '/*' || OPERATORS.some((op) => op.startsWith(pair)));
+            // 1.0 followed by .5 or e, or a sign after e, would read as one number
+            const numbers = previous.kind === 'number' && token.kind === 'symbol' && token.text === '.';
+
+            if (words || joined || numbers) {
+                out += ' ';
+            }
+        }
+
+        out += token.text;
+        previous = token;
+    }
+
+    return out;
+};
+
+const optimizeGlsl = (source: string, options: GlslOptions = {}): GlslResult => {
+    const result: GlslResult = { source, folded: 0, removedFunctions: [], removedGlobals: [] };
+    let tokens = lex(source);
+
+    if (tokens[0]?.kind !== 'directive' || !tokens[0].text.startsWith('#version')) {
+        return result;
+    }
+
+    result.folded = fold(tokens);
+
+    // Code spliced in later may call anything, only fold and print then
+    if (!(options.opaque ?? []).some((name) => tokens.some((token) => token.text === name))) {
+        tokens = eliminate(tokens, result);
+    }
+
+    if (options.lowerPrecision) {
+        lowerPrecision(source, tokens);
+    }
+
+    result.source = print(tokens);
+
+    return result;
+};
+
+export type { GlslOptions, GlslResult };
+export default optimizeGlsl;
@@ -0,0 +1,91 @@
+interface TimerQueryExtension {
+    readonly TIME_ELAPSED_EXT: GLenum;
+    readonly GPU_DISJOINT_EXT: GLenum;
+}
+
+interface PendingQuery {
+    query: WebGLQuery;
+    tag: number;
+}
+
+// GPU time through EXT_disjoint_timer_query_webgl2, results arrive a few frames late
+class GpuTimer {
+    private gl: WebGL2RenderingContext;
+    private ext: TimerQueryExtension | null;
+    private free: WebGLQuery[] = [];
+    private pending: PendingQuery[] = [];
+    private active: WebGLQuery | null = null;
+
+    constructor(gl: WebGL2RenderingContext) {
+        this.gl = gl;
+        this.ext = gl.getExtension('EXT_disjoint_timer_query_webgl2') as TimerQueryExtension | null;
+    }
+
+    public get supported(): boolean {
+        return this.ext !== null;
+    }
+
+    // Only one query can be open at a time, nested begin calls are ignored
+    public begin(): void {
+        if (!this.ext || this.active) {
+            return;
+        }
+
+        this.active = this.free.pop() ?? this.gl.createQuery();
+        this.gl.beginQuery(this.ext.TIME_ELAPSED_EXT, this.active);
+    }
+
+    public end(tag: number): void {
+        if (!this.ext || !this.active) {
+            return;
+        }
+
+        this.gl.endQuery(this.ext.TIME_ELAPSED_EXT);
+        this.pending.push({ query: this.active, tag });
+        this.active = null;
+    }
+
+    // Reports finished queries in submission order, stops at the first one still in flight
+    public poll(result: (tag: number, ms: number) => void): void {
+        const gl = this.gl;
+
+        if (!this.ext) {
+            return;
+        }
+
+        const disjoint = gl.getParameter(this.ext.GPU_DISJOINT_EXT) as boolean;
+        let done = 0;
+
+        for (const pending of this.pending) {
+            if (!gl.getQueryParameter(pending.query, gl.QUERY_RESULT_AVAILABLE)) {
+                break;
+            }
+
+            if (!disjoint) {
+                result(pending.tag, (gl.getQueryParameter(pending.query, gl.QUERY_RESULT) as number) / 1e6);
+            }
+
+            this.free.push(pending.query);
+            done++;
+        }
+
+        if (done > 0) {
+            this.pending.splice(0, done);
+        }
+    }
+
+    public dispose(): void {
+        for (const query of this.free) {
+            this.gl.deleteQuery(query);
+        }
+
+        for (const pending of this.pending) {
+            this.gl.deleteQuery(pending.query);
+        }
+
+        this.free = [];
+        this.pending = [];
+    }
+}
+
+export default GpuTimer;
@@ -0,0 +1,53 @@
+const WINDOW = 240;
+
+// Input to present latency, from the oldest input a frame consumed to the moment the frame is handed off
+class LatencyMeter {
+    private pending: number = -1;
+    private samples: Float64Array = new Float64Array(WINDOW);
+    private kinds: Uint8Array = new Uint8Array(WINDOW);
+    private count: number = 0;
+
+    // Event timestamps share the performance.now() clock
+    public input(timeStamp: number): void {
+        if (this.pending < 0) {
+            this.pending = timeStamp;
+        }
+    }
+
+    // kind tells frame types apart, e.g. full renders and reprojected frames
+    public present(kind: number = 0): void {
+        if (this.pending < 0) {
+            return;
+        }
+
+        const i = this.count++ % WINDOW;
+
+        this.samples[i] = performance.now() - this.pending;
+        this.kinds[i] = kind;
+        this.pending = -1;
+    }
+
+    public summary(kind: number = -1): { samples: number; mean: number; p95: number } {
+        const values: number[] = [];
+
+        for (let i = 0; i < Math.min(this.count, WINDOW); i++) {
+            if (kind < 0 || this.kinds[i] === kind) {
+                values.push(this.samples[i]);
+            }
+        }
+
+        if (values.length === 0) {
+            return { samples: 0, mean: 0, p95: 0 };
+        }
+
+        values.sort((a, b) => a - b);
+
+        return {
+            samples: values.length,
+            mean: values.reduce((sum, value) => sum + value, 0) / values.length,
+            p95: values[Math.min(values.length - 1, Math.floor(values.length * 0.95))]
+        };
+    }
+}
+
+export default LatencyMeter;
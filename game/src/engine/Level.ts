@@ -0,0 +1,169 @@
+// Binary level layout, written by scripts/export-level.mjs (keep both in sync)
+//
+// header   64 bytes  u32 magic 'SLVL', u16 version, u16 section count, u32 total bytes, rest reserved
+// table    16 bytes per section  u32 id, u32 byte offset, u32 byte length, u32 element count
+// sections 16 byte aligned, each one holds a single element type so it can be viewed in place
+import { TransformLayout } from './Components';
+
+const MAGIC = 0x4c564c53; // 'SLVL'
+const VERSION = 1;
+const HEADER_BYTES = 64;
+const SECTION_BYTES = 16;
+
+const fourCC = (id: string): number => id.charCodeAt(0) | id.charCodeAt(1) << 8 | id.charCodeAt(2) << 16 | id.charCodeAt(3) << 24;
+
+const Sections = {
+    entityKind: fourCC('EKND'),      // u16 per entity
+    entityFlags: fourCC('EFLG'),     // u16 per entity
+    entityRoom: fourCC('EROM'),      // u16 per entity
+    transforms: fourCC('XFRM'),      // f32 x10 per entity, position xyz, rotation xyzw, scale xyz
+    bvhBounds: fourCC('BVHB'),       // f32 x6 per node, min xyz, max xyz
+    bvhLinks: fourCC('BVHL'),        // u32 x2 per node, first child or first item, item count (0 for inner nodes)
+    bvhItems: fourCC('BVHI'),        // u32 entity index per leaf item
+    portalQuads: fourCC('PRTQ'),     // f32 x12 per portal, four corners
+    portalRooms: fourCC('PRTR'),     // u16 x2 per portal, front and back room
+    navVertices: fourCC('NAVV'),     // f32 x3 per vertex
+    navTriangles: fourCC('NAVT'),    // u32 x6 per triangle, three vertices, three neighbours (0xffffffff for none)
+    lights: fourCC('LITE'),          // f32 x12 per light, position xyz, range, colour rgb, intensity, direction xyz, cone cosine
+    roomLightStart: fourCC('RLST'),  // u32 per room plus one, offsets into roomLights
+    roomLights: fourCC('RLIT')       // u16 light index
+} as const;
+
+// components/transform.json, the exporter writes the same layout
+const TRANSFORM_STRIDE = TransformLayout.stride;
+const LIGHT_STRIDE = 12;
+
+class Level {
+    // Over shared memory when it came decoded from the asset archive, the buffer behind it can be larger
+    public readonly bytes: Uint8Array;
+    public readonly version: number;
+
+    public readonly entityCount: number;
+    public readonly entityKind: Uint16Array;
+    public readonly entityFlags: Uint16Array;
+    public readonly entityRoom: Uint16Array;
+    public readonly transforms: Float32Array;
+
+    public readonly bvhBounds: Float32Array;
+    public readonly bvhLinks: Uint32Array;
+    public readonly bvhItems: Uint32Array;
+
+    public readonly portalQuads: Float32Array;
+    public readonly portalRooms: Uint16Array;
+
+    public readonly navVertices: Float32Array;
+    public readonly navTriangles: Uint32Array;
+
+    public readonly lights: Float32Array;
+    public readonly roomLightStart: Uint32Array;
+    public readonly roomLights: Uint16Array;
+
+    // Only builds views over the data, nothing is parsed or copied
+    constructor(data: ArrayBufferLike | Uint8Array) {
+        const bytes = data instanceof Uint8Array ? data : new Uint8Array(data);
+        const buffer = bytes.buffer;
+        const base = bytes.byteOffset;
+        const header = new DataView(buffer, base, bytes.byteLength);
+
+        if (bytes.byteLength < HEADER_BYTES || header.getUint32(0, true) !== MAGIC) {
+            throw new Error('Level File is Corrupt or not a Level.');
+        }
+
+        this.version = header.getUint16(4, true);
+
+        if (this.version !== VERSION) {
+            throw new Error(`Level Format Version ${this.version} is not Supported, Expected ${VERSION}.`);
+        }
+
+        if (header.getUint32(8, true) !== bytes.byteLength) {
+            throw new Error('Level File is Truncated.');
+        }
+
+        const table = new Uint32Array(buffer, base + HEADER_BYTES, header.getUint16(6, true) * SECTION_BYTES / 4);
+        const section = <T>(id: number, View: new (buffer: ArrayBufferLike, offset: number, length: number) => T, width: number): T => {
+            for (let i = 0; i < table.length; i += 4) {
+                if (table[i] === id) {
+                    return new View(buffer, base + table[i + 1], table[i + 3] * width);
+                }
+            }
+
+            return new View(buffer, 0, 0);
+        };
+
+        this.bytes = bytes;
+
+        this.entityKind = section(Sections.entityKind, Uint16Array, 1);
+        this.entityFlags = section(Sections.entityFlags, Uint16Array, 1);
+        this.entityRoom = section(Sections.entityRoom, Uint16Array, 1);
+        this.transforms = section(Sections.transforms, Float32Array, TRANSFORM_STRIDE);
+        this.entityCount = this.entityKind.length;
+
+        this.bvhBounds = section(Sections.bvhBounds, Float32Array, 6);
+        this.bvhLinks = section(Sections.bvhLinks, Uint32Array, 2);
+        this.bvhItems = section(Sections.bvhItems, Uint32Array, 1);
+
+        this.portalQuads = section(Sections.portalQuads, Float32Array, 12);
+        this.portalRooms = section(Sections.portalRooms, Uint16Array, 2);
+
+        this.navVertices = section(Sections.navVertices, Float32Array, 3);
+        this.navTriangles = section(Sections.navTriangles, Uint32Array, 6);
+
+        this.lights = section(Sections.lights, Float32Array, LIGHT_STRIDE);
+        this.roomLightStart = section(Sections.roomLightStart, Uint32Array, 1);
+        this.roomLights = section(Sections.roomLights, Uint16Array, 1);
+    }
+
+    public get roomCount(): number {
+        return Math.max(0, this.roomLightStart.length - 1);
+    }
+
+    public get portalCount(): number {
+        return this.portalRooms.length / 2;
+    }
+
+    public get lightCount(): number {
+        return this.lights.length / LIGHT_STRIDE;
+    }
+
+    public static async load(url: string): Promise<Level> {
+        const response = await fetch(url);
+
+        if (!response.ok) {
+            throw new Error(`Could not Load Level '${url}' (${response.status}).`);
+        }
+
+        return new Level(await response.arrayBuffer());
+    }
+
+    // Dev helper, times the binary level against the JSON the exporter writes next to it with --json
+    public static async benchmark(name: string, runs: number = 20): Promise<{ binary: number; json: number }> {
+        const binary = await (await fetch(`/levels/${name}.lvl`)).arrayBuffer();
+        const json = await (await fetch(`/levels/${name}.json`)).text();
+
+        let start = performance.now();
+
+        for (let i = 0; i < runs; i++) {
+            new Level(binary);
+        }
+
+        const binaryMs = (performance.now() - start) / runs;
+
+        start = performance.now();
+
+        for (let i = 0; i < runs; i++) {
+            JSON.parse(json);
+        }
+
+        const jsonMs = (performance.now() - start) / runs;
+
+        console.table({
+            binary: { ms: binaryMs, bytes: binary.byteLength },
+            json: { ms: jsonMs, bytes: json.length }
+        });
+
+        return { binary: binaryMs, json: jsonMs };
+    }
+}
+
+export { Sections as LevelSections, TRANSFORM_STRIDE, LIGHT_STRIDE };
+export default Level;
@@ -0,0 +1,272 @@
+import type { Lz4Reply, Lz4Request } from './Lz4.worker';
+
+// WebAssembly opcodes the decoder uses
+const Op = {
+    block: 0x02,
+    loop: 0x03,
+    if: 0x04,
+    else: 0x05,
+    end: 0x0b,
+    br: 0x0c,
+    brIf: 0x0d,
+    localGet: 0x20,
+    localSet: 0x21,
+    localTee: 0x22,
+    load8: 0x2d,
+    store8: 0x3a,
+    const: 0x41,
+    eq: 0x46,
+    ltU: 0x49,
+    geU: 0x4f,
+    add: 0x6a,
+    sub: 0x6b,
+    and: 0x71,
+    or: 0x72,
+    shl: 0x74,
+    shrU: 0x76
+} as const;
+
+const VOID = 0x40;
+const I32 = 0x7f;
+// memory.copy, from the bulk memory proposal
+const MEMORY_COPY = [0xfc, 0x0a, 0x00, 0x00];
+
+// decode(source, end, destination) locals, the three parameters come first
+const Local = { source: 0, end: 1, destination: 2, token: 3, length: 4, byte: 5, match: 6, offset: 7 } as const;
+
+const get = (local: number): number[] => [Op.localGet, local];
+const set = (local: number): number[] => [Op.localSet, local];
+// Small constants only, every one used here fits a single signed LEB128 byte or two
+const constant = (value: number): number[] => (value < 64 ? [Op.const, value] : [Op.const, (value & 0x7f) | 0x80, value >> 7]);
+const increment = (local: number, by: number[]): number[] => [...get(local), ...by, Op.add, ...set(local)];
+const readByte = (into: number): number[] => [...get(Local.source), Op.load8, 0, 0, ...set(into), ...increment(Local.source, constant(1))];
+
+// A length nibble of 15 continues in the following bytes, each added until one is not 255
+const extendLength = (): number[] => [
+    ...get(Local.length), ...constant(15), Op.eq,
+    Op.if, VOID,
+    Op.loop, VOID,
+    ...readByte(Local.byte),
+    ...increment(Local.length, get(Local.byte)),
+    ...get(Local.byte), ...constant(255), Op.eq, Op.brIf, 0,
+    Op.end,
+    Op.end
+];
+
+// LZ4 block format, one sequence per loop: token, literals, then a match unless the block ends
+const decodeBody = (): number[] => [
+    Op.block, VOID,
+    Op.loop, VOID,
+    ...readByte(Local.token),
+    ...get(Local.token), ...constant(4), Op.shrU, ...set(Local.length),
+    ...extendLength(),
+    ...get(Local.destination), ...get(Local.source), ...get(Local.length), ...MEMORY_COPY,
+    ...increment(Local.source, get(Local.length)),
+    ...increment(Local.destination, get(Local.length)),
+    // The last sequence is literals only
+    ...get(Local.source), ...get(Local.end), Op.geU, Op.brIf, 1,
+    ...get(Local.source), Op.load8, 0, 0, ...get(Local.source), Op.load8, 0, 1, ...constant(8), Op.shl, Op.or, ...set(Local.offset),
+    ...increment(Local.source, constant(2)),
+    ...get(Local.token), ...constant(15), Op.and, ...set(Local.length),
+    ...extendLength(),
+    ...increment(Local.length, constant(4)),
+    ...get(Local.destination), ...get(Local.offset), Op.sub, ...set(Local.match),
+    // A match closer than its length repeats the bytes it is still writing, so it goes one byte at a time
+    ...get(Local.offset), ...get(Local.length), Op.ltU,
+    Op.if, VOID,
+    Op.loop, VOID,
+    ...get(Local.destination), ...get(Local.match), Op.load8, 0, 0, Op.store8, 0, 0,
+    ...increment(Local.destination, constant(1)),
+    ...increment(Local.match, constant(1)),
+    ...get(Local.length), ...constant(1), Op.sub, Op.localTee, Local.length, Op.brIf, 0,
+    Op.end,
+    Op.else,
+    ...get(Local.destination), ...get(Local.match), ...get(Local.length), ...MEMORY_COPY,
+    ...increment(Local.destination, get(Local.length)),
+    Op.end,
+    Op.br, 0,
+    Op.end,
+    Op.end,
+    ...get(Local.destination),
+    Op.end
+];
+
+const leb = (value: number): number[] => {
+    const bytes: number[] = [];
+
+    do {
+        bytes.push((value & 0x7f) | (value > 0x7f ? 0x80 : 0));
+        value >>>= 7;
+    } while (value > 0);
+
+    return bytes;
+};
+
+const section = (id: number, content: number[]): number[] => [id, ...leb(content.length), ...content];
+const name = (text: string): number[] => [text.length, ...Array.from(text, (char) => char.charCodeAt(0))];
+
+// Exports decode(source, end, destination) -> end of the decoded bytes
+//
+// Assembled here from the opcodes above, so the build needs no WebAssembly toolchain. The module
+// either exports a memory of its own, or with shared set imports env.memory, a shared memory that
+// holds the destination, so blocks decode straight into place.
+const lz4ModuleBytes = (shared: boolean = false): Uint8Array<ArrayBuffer> => {
+    const body = [1, 5, I32, ...decodeBody()];
+    // Shared memories need a maximum, 65536 pages is the whole 32 bit address space
+    const memory = shared ? section(2, [1, ...name('env'), ...name('memory'), 0x02, 0x03, 1, ...leb(65536)]) : [];
+
+    return new Uint8Array([
+        0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,
+        ...section(1, [1, 0x60, 3, I32, I32, I32, 1, I32]),
+        ...memory,
+        ...section(3, [1, 0]),
+        ...(shared ? [] : section(5, [1, 0x00, 1])),
+        ...section(7, shared ? [1, ...name('decode'), 0x00, 0] : [2, ...name('decode'), 0x00, 0, ...name('memory'), 0x02, 0]),
+        ...section(10, [1, ...leb(body.length), ...body])
+    ]);
+};
+
+// Decoded output in a shared WebAssembly memory: raw bytes from 0, then one scratch slot per worker
+// for the compressed block it is decoding
+interface Lz4Target {
+    memory: WebAssembly.Memory;
+    scratch: number;
+    slot: number;
+}
+
+interface DecodeTask {
+    id: number;
+    source: Uint8Array;
+    rawBytes: number;
+    destination: Lz4Target | ArrayBuffer;
+    offset: number;
+    resolve: () => void;
+    reject: (error: Error) => void;
+}
+
+// Decodes LZ4 blocks on worker threads, one WebAssembly instance per worker
+//
+// With shared memory the destination is itself a WebAssembly memory and the workers decode straight
+// into it, otherwise each worker decodes into its own memory and the block is transferred back and
+// copied in place here.
+class Lz4Pool {
+    public readonly size: number;
+    // Raw bytes one worker decodes per millisecond, measured
+    public bytesPerMs: number = 500000;
+
+    private workers: Worker[] = [];
+    private idle: Worker[] = [];
+    private queue: DecodeTask[] = [];
+    private running: Map<number, DecodeTask> = new Map();
+    private nextId: number = 0;
+
+    // Null without cross origin isolation, targets are then plain buffers
+    private sharedModule: WebAssembly.Module | null;
+
+    constructor(module: WebAssembly.Module, sharedModule: WebAssembly.Module | null, size: number) {
+        this.size = size;
+        this.sharedModule = sharedModule;
+
+        for (let i = 0; i < size; i++) {
+            const worker = new Worker(new URL('./Lz4.worker.ts', import.meta.url), { type: 'module' });
+
+            worker.addEventListener('message', (event: MessageEvent<Lz4Reply>) => this.finish(worker, event.data));
+            this.post(worker, { type: 'init', module, sharedModule });
+            this.workers.push(worker);
+            this.idle.push(worker);
+        }
+    }
+
+    // One worker per spare core, the main thread keeps one
+    public static async create(size: number = Math.max(1, Math.min(4, (navigator.hardwareConcurrency ?? 2) - 1))): Promise<Lz4Pool> {
+        const [module, sharedModule] = await Promise.all([
+            WebAssembly.compile(lz4ModuleBytes()),
+            crossOriginIsolated ? WebAssembly.compile(lz4ModuleBytes(true)) : null
+        ]);
+
+        return new Lz4Pool(module, sharedModule, size);
+    }
+
+    // Room for rawBytes of output decoded in place from blocks of up to blockSize, null without shared memory
+    // The memory's buffer is the decoded data, padded to whole pages
+    public createTarget(rawBytes: number, blockSize: number): Lz4Target | null {
+        if (!this.sharedModule) {
+            return null;
+        }
+
+        const scratch = Math.ceil(rawBytes / 16) * 16;
+        const pages = Math.max(1, Math.ceil((scratch + this.size * blockSize) / 65536));
+
+        return { memory: new WebAssembly.Memory({ initial: pages, maximum: pages, shared: true }), scratch, slot: blockSize };
+    }
+
+    // Decodes source into destination[offset, offset + rawBytes), a target's memory or a plain buffer
+    public decode(source: Uint8Array, rawBytes: number, destination: Lz4Target | ArrayBuffer, offset: number): Promise<void> {
+        return new Promise((resolve, reject) => {
+            this.queue.push({ id: this.nextId++, source, rawBytes, destination, offset, resolve, reject });
+            this.dispatch();
+        });
+    }
+
+    public dispose(): void {
+        for (const worker of this.workers) {
+            worker.terminate();
+        }
+
+        for (const task of [...this.queue, ...this.running.values()]) {
+            task.reject(new Error('LZ4 Decoder Pool was Disposed.'));
+        }
+
+        this.workers = [];
+        this.idle = [];
+        this.queue = [];
+        this.running.clear();
+    }
+
+    private dispatch(): void {
+        while (this.idle.length > 0 && this.queue.length > 0) {
+            const worker = this.idle.pop()!;
+            const task = this.queue.shift()!;
+            const source = task.source.slice().buffer;
+            const destination = task.destination;
+            const target = destination instanceof ArrayBuffer ? null : {
+                memory: destination.memory,
+                scratch: destination.scratch + this.workers.indexOf(worker) * destination.slot
+            };
+
+            this.running.set(task.id, task);
+            this.post(worker, { type: 'decode', id: task.id, source, rawBytes: task.rawBytes, target, offset: task.offset }, [source]);
+        }
+    }
+
+    private finish(worker: Worker, reply: Lz4Reply): void {
+        const task = this.running.get(reply.id);
+
+        this.idle.push(worker);
+
+        if (task) {
+            this.running.delete(reply.id);
+
+            if ('error' in reply) {
+                task.reject(new Error(reply.error));
+            } else {
+                if (reply.data && task.destination instanceof ArrayBuffer) {
+                    new Uint8Array(task.destination, task.offset, task.rawBytes).set(new Uint8Array(reply.data));
+                }
+
+                this.bytesPerMs += (task.rawBytes / Math.max(0.01, reply.ms) - this.bytesPerMs) * 0.2;
+                task.resolve();
+            }
+        }
+
+        this.dispatch();
+    }
+
+    private post(worker: Worker, message: Lz4Request, transfer: Transferable[] = []): void {
+        worker.postMessage(message, transfer);
+    }
+}
+
+export type { Lz4Target };
+export { lz4ModuleBytes };
+export default Lz4Pool;
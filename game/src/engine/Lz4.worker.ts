@@ -0,0 +1,105 @@
+type Lz4Request =
+    | { type: 'init'; module: WebAssembly.Module; sharedModule: WebAssembly.Module | null }
+    | { type: 'decode'; id: number; source: ArrayBuffer; rawBytes: number; target: { memory: WebAssembly.Memory; scratch: number } | null; offset: number };
+
+// data is null when the block was decoded in place into the target memory
+type Lz4Reply =
+    | { id: number; ms: number; data: ArrayBuffer | null }
+    | { id: number; error: string };
+
+type Decode = (source: number, end: number, destination: number) => number;
+
+const PAGE_BYTES = 65536;
+// The project's DOM lib types self as a Window, the worker scope posts and listens like a Worker does
+const scope = self as unknown as Pick<Worker, 'postMessage' | 'addEventListener'>;
+
+let memory: WebAssembly.Memory | null = null;
+let decode: Decode | null = null;
+let sharedModule: WebAssembly.Module | null = null;
+// Instance for the latest target memory
+let target: { memory: WebAssembly.Memory; decode: Decode } | null = null;
+
+// Instances are per memory, a read decodes all of its blocks into the same one
+const decoderFor = (shared: WebAssembly.Memory, module: WebAssembly.Module): Decode => {
+    if (target && target.memory === shared) {
+        return target.decode;
+    }
+
+    const instance = new WebAssembly.Instance(module, { env: { memory: shared } });
+
+    target = { memory: shared, decode: instance.exports.decode as Decode };
+
+    return target.decode;
+};
+
+// Without a target the block is copied to the start of the worker's memory and decoded right behind itself
+const run = (message: Extract<Lz4Request, { type: 'decode' }>): Lz4Reply => {
+    const start = performance.now();
+    const sourceBytes = message.source.byteLength;
+
+    if (message.target) {
+        const { memory: shared, scratch } = message.target;
+
+        if (!sharedModule) {
+            return { id: message.id, error: 'LZ4 Decoder has No Shared Memory Module.' };
+        }
+
+        const decodeInPlace = decoderFor(shared, sharedModule);
+
+        new Uint8Array(shared.buffer, scratch, sourceBytes).set(new Uint8Array(message.source));
+
+        if (decodeInPlace(scratch, scratch + sourceBytes, message.offset) - message.offset !== message.rawBytes) {
+            return { id: message.id, error: 'LZ4 Block is Corrupt.' };
+        }
+
+        return { id: message.id, ms: performance.now() - start, data: null };
+    }
+
+    const needed = sourceBytes + message.rawBytes;
+
+    if (!memory || !decode) {
+        return { id: message.id, error: 'LZ4 Decoder is Not Initialized.' };
+    }
+
+    if (memory.buffer.byteLength < needed) {
+        memory.grow(Math.ceil((needed - memory.buffer.byteLength) / PAGE_BYTES));
+    }
+
+    new Uint8Array(memory.buffer, 0, sourceBytes).set(new Uint8Array(message.source));
+
+    if (decode(0, sourceBytes, sourceBytes) - sourceBytes !== message.rawBytes) {
+        return { id: message.id, error: 'LZ4 Block is Corrupt.' };
+    }
+
+    return { id: message.id, ms: performance.now() - start, data: memory.buffer.slice(sourceBytes, sourceBytes + message.rawBytes) };
+};
+
+scope.addEventListener('message', (event: MessageEvent<Lz4Request>) => {
+    const message = event.data;
+
+    switch (message.type) {
+        case 'init': {
+            const instance = new WebAssembly.Instance(message.module);
+
+            memory = instance.exports.memory as WebAssembly.Memory;
+            decode = instance.exports.decode as Decode;
+            sharedModule = message.sharedModule;
+            break;
+        }
+        case 'decode': {
+            let reply: Lz4Reply;
+
+            // A corrupt block can run the decoder out of bounds, which traps
+            try {
+                reply = run(message);
+            } catch (error) {
+                reply = { id: message.id, error: `LZ4 Block is Corrupt (${(error as Error).message}).` };
+            }
+
+            scope.postMessage(reply, 'data' in reply && reply.data ? [reply.data] : []);
+            break;
+        }
+    }
+});
+
+export type { Lz4Reply, Lz4Request };
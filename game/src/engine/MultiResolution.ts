@@ -0,0 +1,161 @@
+import type { VignetteSettings } from './PostChain';
+import RenderTarget from './RenderTarget';
+import Shader from './Shader';
+
+interface Region {
+    x0: number;
+    y0: number;
+    x1: number;
+    y1: number;
+}
+
+const RESOLVE_FRAGMENT = `#version 300 es
+precision highp float;
+
+in vec2 uv;
+
+uniform sampler2D color;
+uniform sampler2D depth;
+uniform vec4 region;
+uniform float margin;
+
+out vec4 outColor;
+
+void main() {
+    // Distance inside the full resolution region, negative outside it
+    float inside = min(min(uv.x - region.x, region.z - uv.x), min(uv.y - region.y, region.w - uv.y));
+
+    if (inside > margin) {
+        discard;
+    }
+
+    outColor = vec4(texture(color, uv).rgb, 1.0 - clamp(inside / margin, 0.0, 1.0));
+    gl_FragDepth = texture(depth, uv).r;
+}`;
+
+// Shades the vignetted periphery at reduced resolution
+//
+// The centre region renders into the scene target and the whole view renders into a low resolution
+// target, each with depth cleared to 0 where the other one is responsible so early depth rejects
+// those fragments. A resolve pass then fills the periphery of the scene target, blending over a
+// small margin so the resolution change is not visible.
+class MultiResolution {
+    public enabled: boolean = false;
+    // Periphery resolution relative to the scene target
+    public scale: number = 0.5;
+    // How much the vignette has to darken the picture before the periphery drops to low resolution
+    // 0.5 hides the lost detail under half the light. A soft vignette only gets that dark near the
+    // corners, savings() then comes out negative and the engine keeps rendering at full resolution.
+    public darkening: number = 0.5;
+    // Width of the blend band, in uv
+    public margin: number = 0.03;
+
+    private gl: WebGL2RenderingContext;
+    private low: RenderTarget;
+    private shader: Shader;
+    private emptyVao: WebGLVertexArrayObject;
+
+    constructor(gl: WebGL2RenderingContext) {
+        this.gl = gl;
+        this.low = new RenderTarget(gl, [gl.RGBA8], true);
+        this.shader = new Shader(gl, Shader.FULLSCREEN_VERTEX, RESOLVE_FRAGMENT);
+        this.emptyVao = gl.createVertexArray();
+    }
+
+    // The blend band starts where the vignette reaches darkening, the square's edge is a margin further out
+    public region(vignette: VignetteSettings): Region {
+        // The composite scales colour by mix(1, smoothstep(outer, inner, d), strength), solved for d
+        const factor = 1 - this.darkening / vignette.strength;
+        const t = factor > 0 ? 0.5 - Math.sin(Math.asin(1 - 2 * Math.min(1, factor)) / 3) : 0;
+        const distance = vignette.outer - (vignette.outer - vignette.inner) * t;
+        const radius = Math.min(0.5, distance + this.margin);
+
+        return { x0: 0.5 - radius, y0: 0.5 - radius, x1: 0.5 + radius, y1: 0.5 + radius };
+    }
+
+    // Fraction of scene pixels that are no longer shaded, compared to a plain full resolution render
+    public savings(vignette: VignetteSettings): number {
+        const r = this.region(vignette);
+        const centre = (r.x1 - r.x0) * (r.y1 - r.y0);
+        const lowCoverage = 1 - Math.max(0, r.x1 - r.x0 - this.margin * 2) * Math.max(0, r.y1 - r.y0 - this.margin * 2);
+
+        return 1 - centre - lowCoverage * this.scale * this.scale;
+    }
+
+    // Expects the scene target bound, draw() is called once per resolution with the matching viewport set
+    public render(scene: RenderTarget, vignette: VignetteSettings, draw: () => number): number {
+        const gl = this.gl;
+        const r = this.region(vignette);
+        const m = this.margin;
+        let calls = 0;
+
+        this.low.resize(scene.width * this.scale, scene.height * this.scale);
+
+        this.low.bind();
+        gl.clear(gl.COLOR_BUFFER_BIT | gl.DEPTH_BUFFER_BIT);
+        this.clearDepth(this.low, [{ x0: r.x0 + m, y0: r.y0 + m, x1: r.x1 - m, y1: r.y1 - m }]);
+        calls += draw();
+
+        scene.bind();
+        gl.clear(gl.COLOR_BUFFER_BIT | gl.DEPTH_BUFFER_BIT);
+        this.clearDepth(scene, [
+            { x0: 0, y0: 0, x1: 1, y1: r.y0 },
+            { x0: 0, y0: r.y1, x1: 1, y1: 1 },
+            { x0: 0, y0: r.y0, x1: r.x0, y1: r.y1 },
+            { x0: r.x1, y0: r.y0, x1: 1, y1: r.y1 }
+        ]);
+        calls += draw();
+
+        const shader = this.shader;
+
+        gl.depthFunc(gl.ALWAYS);
+        gl.enable(gl.BLEND);
+        gl.blendFunc(gl.SRC_ALPHA, gl.ONE_MINUS_SRC_ALPHA);
+        gl.bindVertexArray(this.emptyVao);
+
+        shader.use();
+        gl.activeTexture(gl.TEXTURE0);
+        gl.bindTexture(gl.TEXTURE_2D, this.low.texture);
+        gl.uniform1i(shader.uniform('color'), 0);
+        gl.activeTexture(gl.TEXTURE1);
+        gl.bindTexture(gl.TEXTURE_2D, this.low.depth);
+        gl.uniform1i(shader.uniform('depth'), 1);
+        gl.uniform4f(shader.uniform('region'), r.x0, r.y0, r.x1, r.y1);
+        gl.uniform1f(shader.uniform('margin'), m);
+        gl.drawArrays(gl.TRIANGLES, 0, 3);
+
+        gl.bindVertexArray(null);
+        gl.activeTexture(gl.TEXTURE0);
+        gl.disable(gl.BLEND);
+        gl.depthFunc(gl.LESS);
+
+        return calls + 1;
+    }
+
+    public dispose(): void {
+        this.low.dispose();
+        this.shader.dispose();
+        this.gl.deleteVertexArray(this.emptyVao);
+    }
+
+    // Depth 0 makes every later fragment in these rectangles fail the depth test before shading
+    private clearDepth(target: RenderTarget, rects: Region[]): void {
+        const gl = this.gl;
+
+        gl.enable(gl.SCISSOR_TEST);
+        gl.clearDepth(0);
+
+        for (const rect of rects) {
+            const x = Math.round(rect.x0 * target.width);
+            const y = Math.round(rect.y0 * target.height);
+
+            gl.scissor(x, y, Math.max(0, Math.round(rect.x1 * target.width) - x), Math.max(0, Math.round(rect.y1 * target.height) - y));
+            gl.clear(gl.DEPTH_BUFFER_BIT);
+        }
+
+        gl.clearDepth(1);
+        gl.disable(gl.SCISSOR_TEST);
+    }
+}
+
+export default MultiResolution;
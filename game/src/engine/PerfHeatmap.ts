@@ -0,0 +1,276 @@
+import Shader from './Shader';
+
+type HeatmapMetric = 'frame' | 'gpu' | 'draws';
+
+const MAGIC = 0x54414548; // 'HEAT'
+const VERSION = 1;
+const HEADER_BYTES = 16;
+const BUCKET_BYTES = 32;
+const TAU = Math.PI * 2;
+
+// Frame cost bucketed by floor cell and view direction, so heavy spots show up instead of one session average
+class PerfHeatmap {
+    public readonly cellSize: number;
+    public readonly sectors: number;
+    public count: number = 0;
+
+    public cellX: Int16Array = new Int16Array(256);
+    public cellZ: Int16Array = new Int16Array(256);
+    public sector: Uint8Array = new Uint8Array(256);
+    public frames: Uint32Array = new Uint32Array(256);
+    public frameSum: Float64Array = new Float64Array(256);
+    public frameMax: Float32Array = new Float32Array(256);
+    public drawSum: Float64Array = new Float64Array(256);
+    public gpuSum: Float64Array = new Float64Array(256);
+    public gpuSamples: Uint32Array = new Uint32Array(256);
+
+    private lookup: Map<number, number> = new Map();
+
+    constructor(cellSize: number = 4, sectors: number = 8) {
+        this.cellSize = cellSize;
+        this.sectors = sectors;
+    }
+
+    // Returns the bucket index, GPU time for the same frame is attributed to it once it resolves
+    public record(x: number, z: number, yaw: number, frameMs: number, draws: number): number {
+        const heading = ((yaw % TAU) + TAU) % TAU;
+        const bucket = this.bucket(
+            Math.floor(x / this.cellSize),
+            Math.floor(z / this.cellSize),
+            Math.floor(heading / TAU * this.sectors) % this.sectors
+        );
+
+        this.frames[bucket]++;
+        this.frameSum[bucket] += frameMs;
+        this.frameMax[bucket] = Math.max(this.frameMax[bucket], frameMs);
+        this.drawSum[bucket] += draws;
+
+        return bucket;
+    }
+
+    public addGpuTime(bucket: number, ms: number): void {
+        this.gpuSum[bucket] += ms;
+        this.gpuSamples[bucket]++;
+    }
+
+    public average(bucket: number, metric: HeatmapMetric): number {
+        switch (metric) {
+            case 'frame':
+                return this.frameSum[bucket] / Math.max(1, this.frames[bucket]);
+            case 'gpu':
+                return this.gpuSum[bucket] / Math.max(1, this.gpuSamples[bucket]);
+            case 'draws':
+                return this.drawSum[bucket] / Math.max(1, this.frames[bucket]);
+        }
+    }
+
+    public serialize(): ArrayBuffer {
+        const buffer = new ArrayBuffer(HEADER_BYTES + this.count * BUCKET_BYTES);
+        const view = new DataView(buffer);
+
+        view.setUint32(0, MAGIC, true);
+        view.setUint16(4, VERSION, true);
+        view.setUint8(6, this.sectors);
+        view.setFloat32(8, this.cellSize, true);
+        view.setUint32(12, this.count, true);
+
+        for (let i = 0; i < this.count; i++) {
+            const at = HEADER_BYTES + i * BUCKET_BYTES;
+
+            view.setInt16(at, this.cellX[i], true);
+            view.setInt16(at + 2, this.cellZ[i], true);
+            view.setUint8(at + 4, this.sector[i]);
+            view.setUint32(at + 8, this.frames[i], true);
+            view.setFloat32(at + 12, this.frameSum[i], true);
+            view.setFloat32(at + 16, this.frameMax[i], true);
+            view.setFloat32(at + 20, this.drawSum[i], true);
+            view.setFloat32(at + 24, this.gpuSum[i], true);
+            view.setUint32(at + 28, this.gpuSamples[i], true);
+        }
+
+        return buffer;
+    }
+
+    // Adds a serialized session, sessions recorded with another grid layout are skipped
+    public merge(buffer: ArrayBuffer): boolean {
+        const view = new DataView(buffer);
+
+        if (buffer.byteLength < HEADER_BYTES || view.getUint32(0, true) !== MAGIC || view.getUint16(4, true) !== VERSION) {
+            return false;
+        }
+
+        if (view.getUint8(6) !== this.sectors || view.getFloat32(8, true) !== this.cellSize) {
+            return false;
+        }
+
+        const count = Math.min(view.getUint32(12, true), (buffer.byteLength - HEADER_BYTES) / BUCKET_BYTES);
+
+        for (let i = 0; i < count; i++) {
+            const at = HEADER_BYTES + i * BUCKET_BYTES;
+            const bucket = this.bucket(view.getInt16(at, true), view.getInt16(at + 2, true), view.getUint8(at + 4));
+
+            this.frames[bucket] += view.getUint32(at + 8, true);
+            this.frameSum[bucket] += view.getFloat32(at + 12, true);
+            this.frameMax[bucket] = Math.max(this.frameMax[bucket], view.getFloat32(at + 16, true));
+            this.drawSum[bucket] += view.getFloat32(at + 20, true);
+            this.gpuSum[bucket] += view.getFloat32(at + 24, true);
+            this.gpuSamples[bucket] += view.getUint32(at + 28, true);
+        }
+
+        return true;
+    }
+
+    private bucket(cx: number, cz: number, sector: number): number {
+        cx = Math.max(-32768, Math.min(32767, cx));
+        cz = Math.max(-32768, Math.min(32767, cz));
+
+        const key = ((cx + 32768) * 65536 + (cz + 32768)) * this.sectors + sector;
+        let bucket = this.lookup.get(key);
+
+        if (bucket === undefined) {
+            if (this.count === this.frames.length) {
+                this.grow();
+            }
+
+            bucket = this.count++;
+            this.cellX[bucket] = cx;
+            this.cellZ[bucket] = cz;
+            this.sector[bucket] = sector;
+            this.lookup.set(key, bucket);
+        }
+
+        return bucket;
+    }
+
+    private grow(): void {
+        const size = this.frames.length * 2;
+        const resize = <T extends Int16Array | Uint8Array | Uint32Array | Float32Array | Float64Array>(from: T, to: T): T => {
+            to.set(from);
+
+            return to;
+        };
+
+        this.cellX = resize(this.cellX, new Int16Array(size));
+        this.cellZ = resize(this.cellZ, new Int16Array(size));
+        this.sector = resize(this.sector, new Uint8Array(size));
+        this.frames = resize(this.frames, new Uint32Array(size));
+        this.frameSum = resize(this.frameSum, new Float64Array(size));
+        this.frameMax = resize(this.frameMax, new Float32Array(size));
+        this.drawSum = resize(this.drawSum, new Float64Array(size));
+        this.gpuSum = resize(this.gpuSum, new Float64Array(size));
+        this.gpuSamples = resize(this.gpuSamples, new Uint32Array(size));
+    }
+}
+
+const OVERLAY_VERTEX = `#version 300 es
+layout(location = 0) in vec4 bucket;
+
+uniform mat4 viewProjection;
+uniform float cellSize;
+uniform float sectors;
+
+out float heat;
+
+void main() {
+    vec2 center = (bucket.xy + 0.5) * cellSize;
+    float angle = (bucket.z + (gl_VertexID == 2 ? 1.0 : 0.0)) / sectors * 6.2831853;
+    vec2 corner = gl_VertexID == 0 ? center : center + vec2(-sin(angle), -cos(angle)) * cellSize * 0.48;
+
+    heat = bucket.w;
+    gl_Position = viewProjection * vec4(corner.x, 0.05, corner.y, 1.0);
+}`;
+
+const OVERLAY_FRAGMENT = `#version 300 es
+precision mediump float;
+
+in float heat;
+out vec4 color;
+
+void main() {
+    vec3 cold = vec3(0.1, 0.8, 0.2);
+    vec3 warm = vec3(1.0, 0.85, 0.1);
+    vec3 hot = vec3(1.0, 0.1, 0.05);
+
+    color = vec4(heat < 0.5 ? mix(cold, warm, heat * 2.0) : mix(warm, hot, heat * 2.0 - 1.0), 0.45);
+}`;
+
+// Dev view, draws one wedge per bucket on the floor plane pointing the way the player was looking
+class HeatmapOverlay {
+    public metric: HeatmapMetric = 'frame';
+
+    private gl: WebGL2RenderingContext;
+    private shader: Shader;
+    private vao: WebGLVertexArrayObject;
+    private instances: WebGLBuffer;
+    private count: number = 0;
+
+    constructor(gl: WebGL2RenderingContext) {
+        this.gl = gl;
+        this.shader = new Shader(gl, OVERLAY_VERTEX, OVERLAY_FRAGMENT);
+        this.vao = gl.createVertexArray();
+        this.instances = gl.createBuffer();
+
+        gl.bindVertexArray(this.vao);
+        gl.bindBuffer(gl.ARRAY_BUFFER, this.instances);
+        gl.enableVertexAttribArray(0);
+        gl.vertexAttribPointer(0, 4, gl.FLOAT, false, 16, 0);
+        gl.vertexAttribDivisor(0, 1);
+        gl.bindVertexArray(null);
+        gl.bindBuffer(gl.ARRAY_BUFFER, null);
+    }
+
+    // Budget in ms (or draws) that maps to full red
+    public update(heatmap: PerfHeatmap, budget: number = 33.3): void {
+        const gl = this.gl;
+        const data = new Float32Array(heatmap.count * 4);
+
+        for (let i = 0; i < heatmap.count; i++) {
+            data[i * 4] = heatmap.cellX[i];
+            data[i * 4 + 1] = heatmap.cellZ[i];
+            data[i * 4 + 2] = heatmap.sector[i];
+            data[i * 4 + 3] = Math.min(1, heatmap.average(i, this.metric) / budget);
+        }
+
+        gl.bindBuffer(gl.ARRAY_BUFFER, this.instances);
+        gl.bufferData(gl.ARRAY_BUFFER, data, gl.DYNAMIC_DRAW);
+        gl.bindBuffer(gl.ARRAY_BUFFER, null);
+
+        this.count = heatmap.count;
+        this.shader.use();
+        gl.uniform1f(this.shader.uniform('cellSize'), heatmap.cellSize);
+        gl.uniform1f(this.shader.uniform('sectors'), heatmap.sectors);
+    }
+
+    public draw(viewProjection: Float32Array): void {
+        const gl = this.gl;
+
+        if (this.count === 0) {
+            return;
+        }
+
+        this.shader.use();
+        gl.uniformMatrix4fv(this.shader.uniform('viewProjection'), false, viewProjection);
+
+        gl.enable(gl.BLEND);
+        gl.blendFunc(gl.SRC_ALPHA, gl.ONE_MINUS_SRC_ALPHA);
+        gl.depthMask(false);
+        gl.disable(gl.CULL_FACE);
+
+        gl.bindVertexArray(this.vao);
+        gl.drawArraysInstanced(gl.TRIANGLES, 0, 3, this.count);
+        gl.bindVertexArray(null);
+
+        gl.depthMask(true);
+        gl.disable(gl.BLEND);
+    }
+
+    public dispose(): void {
+        this.shader.dispose();
+        this.gl.deleteVertexArray(this.vao);
+        this.gl.deleteBuffer(this.instances);
+    }
+}
+
+export type { HeatmapMetric };
+export { HeatmapOverlay };
+export default PerfHeatmap;
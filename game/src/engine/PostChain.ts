@@ -0,0 +1,426 @@
+import Camera from './Camera';
+import RenderTarget from './RenderTarget';
+import Shader from './Shader';
+import type { StaticSettings } from './StaticNoise';
+
+interface MotionBlurSettings {
+    enabled: boolean;
+    // Fraction of the frame the virtual shutter stays open, 0.5 is a 180 degree shutter
+    shutter: number;
+}
+
+interface DepthOfFieldSettings {
+    enabled: boolean;
+    focusDistance: number;
+    focusRange: number;
+    // Largest blur radius in effect resolution pixels
+    maxRadius: number;
+}
+
+interface VignetteSettings {
+    // Distance from the screen centre (in uv) where darkening starts and where it is strongest
+    inner: number;
+    outer: number;
+    strength: number;
+}
+
+// Tile edge in effect resolution pixels
+const TILE = 16;
+// Velocity or CoC (in effect pixels) below which a tile counts as sharp
+const THRESHOLD = 0.5;
+
+const PREPARE_FRAGMENT = `#version 300 es
+precision highp float;
+
+in vec2 uv;
+
+uniform sampler2D scene;
+uniform sampler2D depth;
+uniform mat4 reprojection;
+uniform vec2 resolution;
+uniform float shutter;
+uniform vec2 clipRange;
+uniform vec3 focus;
+
+layout(location = 0) out vec4 outColor;
+layout(location = 1) out vec4 outMotion;
+
+void main() {
+    float d = texture(depth, uv).r * 2.0 - 1.0;
+    vec2 ndc = uv * 2.0 - 1.0;
+    vec4 previous = reprojection * vec4(ndc, d, 1.0);
+    vec2 velocity = (ndc - previous.xy / previous.w) * 0.5 * resolution * shutter;
+
+    float near = clipRange.x;
+    float far = clipRange.y;
+    float linear = 2.0 * near * far / (far + near - d * (far - near));
+    float coc = clamp(abs(linear - focus.x) / focus.y, 0.0, 1.0) * focus.z;
+
+    outColor = texture(scene, uv);
+    outMotion = vec4(velocity, coc, linear);
+}`;
+
+const TILE_FRAGMENT = `#version 300 es
+precision highp float;
+
+#define TILE ${TILE}
+
+uniform sampler2D motion;
+
+out vec4 outTile;
+
+void main() {
+    ivec2 base = ivec2(gl_FragCoord.xy) * TILE;
+    ivec2 last = textureSize(motion, 0) - 1;
+    vec2 velocity = vec2(0.0);
+    float speed = 0.0;
+    float coc = 0.0;
+
+    for (int y = 0; y < TILE; y++) {
+        for (int x = 0; x < TILE; x++) {
+            vec4 m = texelFetch(motion, min(base + ivec2(x, y), last), 0);
+            float s = dot(m.xy, m.xy);
+
+            if (s > speed) {
+                speed = s;
+                velocity = m.xy;
+            }
+
+            coc = max(coc, m.z);
+        }
+    }
+
+    outTile = vec4(velocity, coc, 0.0);
+}`;
+
+const NEIGHBOUR_FRAGMENT = `#version 300 es
+precision highp float;
+
+uniform sampler2D tiles;
+
+out vec4 outTile;
+
+void main() {
+    ivec2 center = ivec2(gl_FragCoord.xy);
+    ivec2 last = textureSize(tiles, 0) - 1;
+    vec4 best = vec4(0.0);
+
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            vec4 t = texelFetch(tiles, clamp(center + ivec2(x, y), ivec2(0), last), 0);
+
+            if (dot(t.xy, t.xy) > dot(best.xy, best.xy)) {
+                best.xy = t.xy;
+            }
+
+            best.z = max(best.z, t.z);
+        }
+    }
+
+    outTile = best;
+}`;
+
+// One quad per tile, quiet tiles are collapsed in the vertex shader so they never rasterize
+const EFFECT_VERTEX = `#version 300 es
+precision highp float;
+
+uniform sampler2D tiles;
+uniform vec2 tileSize;
+uniform int tilesPerRow;
+uniform float threshold;
+
+flat out vec4 tile;
+out vec2 uv;
+
+void main() {
+    ivec2 id = ivec2(gl_InstanceID % tilesPerRow, gl_InstanceID / tilesPerRow);
+    int v = gl_VertexID;
+    vec2 corner = vec2(v == 1 || v == 2 || v == 4 ? 1.0 : 0.0, v == 2 || v == 4 || v == 5 ? 1.0 : 0.0);
+
+    tile = texelFetch(tiles, id, 0);
+    uv = (vec2(id) + corner) * tileSize;
+
+    bool active = length(tile.xy) > threshold || tile.z > threshold;
+
+    gl_Position = active ? vec4(uv * 2.0 - 1.0, 0.0, 1.0) : vec4(2.0, 2.0, 2.0, 1.0);
+}`;
+
+const EFFECT_FRAGMENT = `#version 300 es
+precision highp float;
+
+#define DOF_SAMPLES 24
+#define BLUR_SAMPLES 10
+
+uniform sampler2D color;
+uniform sampler2D motion;
+uniform vec2 texel;
+uniform float threshold;
+
+flat in vec4 tile;
+in vec2 uv;
+
+out vec4 outColor;
+
+void main() {
+    vec4 center = texture(motion, uv);
+    vec3 result = texture(color, uv).rgb;
+    float weight = 0.0;
+
+    // Bokeh as a gather, a sample counts when its own blur disc reaches this pixel
+    if (tile.z > threshold) {
+        vec3 sum = result;
+        float total = 1.0;
+
+        for (int i = 1; i < DOF_SAMPLES; i++) {
+            float radius = sqrt(float(i) / float(DOF_SAMPLES)) * tile.z;
+            float angle = float(i) * 2.39996323;
+            vec2 at = uv + vec2(cos(angle), sin(angle)) * radius * texel;
+            float w = clamp(texture(motion, at).z - radius + 1.0, 0.0, 1.0);
+
+            sum += texture(color, at).rgb * w;
+            total += w;
+        }
+
+        result = sum / total;
+        weight = smoothstep(threshold, threshold * 4.0, center.z);
+    }
+
+    if (length(tile.xy) > threshold) {
+        vec3 sum = vec3(0.0);
+
+        for (int i = 0; i < BLUR_SAMPLES; i++) {
+            float t = (float(i) + 0.5) / float(BLUR_SAMPLES) - 0.5;
+
+            sum += texture(color, uv + tile.xy * t * texel).rgb;
+        }
+
+        float blur = smoothstep(threshold, threshold * 4.0, length(center.xy));
+
+        result = mix(result, sum / float(BLUR_SAMPLES), blur);
+        weight = max(weight, blur);
+    }
+
+    outColor = vec4(result, weight);
+}`;
+
+const COMPOSITE_FRAGMENT = `#version 300 es
+precision mediump float;
+
+in vec2 uv;
+
+uniform sampler2D scene;
+uniform sampler2D effect;
+uniform bool useEffect;
+uniform vec3 vignette;
+uniform float exposure;
+// intensity, flicker, dropout, seed, the audio static is driven by the same values
+uniform vec4 staticNoise;
+
+out vec4 outColor;
+
+void main() {
+    vec3 color = texture(scene, uv).rgb;
+
+    if (useEffect) {
+        vec4 fx = texture(effect, uv);
+        color = mix(color, fx.rgb, fx.a);
+    }
+
+    color *= exposure;
+
+    if (staticNoise.x > 0.0 || staticNoise.z > 0.0) {
+        highp vec2 p = gl_FragCoord.xy + staticNoise.yw * vec2(317.0, 1013.0);
+        highp float snow = fract(sin(dot(p, vec2(12.9898, 78.233))) * 43758.5453);
+
+        color *= 1.0 - 0.2 * staticNoise.x * staticNoise.y;
+        color = mix(color, vec3(snow), max(staticNoise.x * 0.35, staticNoise.z));
+    }
+    color *= mix(1.0, smoothstep(vignette.y, vignette.x, length(uv - 0.5)), vignette.z);
+
+    outColor = vec4(color, 1.0);
+}`;
+
+// Owns the scene target and everything between it and the screen
+class PostChain {
+    public readonly scene: RenderTarget;
+    public readonly motionBlur: MotionBlurSettings = { enabled: false, shutter: 0.5 };
+    public readonly depthOfField: DepthOfFieldSettings = { enabled: false, focusDistance: 4, focusRange: 6, maxRadius: 12 };
+    public readonly vignette: VignetteSettings = { inner: 0.3, outer: 0.85, strength: 0.9 };
+    // Scales the scene before the vignette, driven by AutoExposure when it is enabled
+    public exposure: number = 1;
+    // Snow over the picture, written from the simulation every frame, see StaticNoise
+    public readonly staticNoise: StaticSettings = { intensity: 0, flicker: 0, dropout: 0, seed: 0 };
+    // Motion blur and depth of field run at 1/2 or 1/4 of the scene resolution
+    public divisor: 2 | 4 = 2;
+    // False when half float targets cannot be rendered to, effects are skipped then
+    public readonly supported: boolean;
+
+    private gl: WebGL2RenderingContext;
+    private half: RenderTarget | null = null;
+    private tiles: RenderTarget | null = null;
+    private neighbours: RenderTarget | null = null;
+    private effect: RenderTarget | null = null;
+    private shaders: Record<'prepare' | 'tile' | 'neighbour' | 'effect' | 'composite', Shader>;
+    private reprojection: Float32Array = new Float32Array(16);
+    private emptyVao: WebGLVertexArrayObject;
+
+    constructor(gl: WebGL2RenderingContext) {
+        this.gl = gl;
+        this.scene = new RenderTarget(gl, [gl.RGBA8], true);
+        this.supported = gl.getExtension('EXT_color_buffer_float') !== null;
+        this.emptyVao = gl.createVertexArray();
+
+        this.shaders = {
+            prepare: new Shader(gl, Shader.FULLSCREEN_VERTEX, PREPARE_FRAGMENT),
+            tile: new Shader(gl, Shader.FULLSCREEN_VERTEX, TILE_FRAGMENT),
+            neighbour: new Shader(gl, Shader.FULLSCREEN_VERTEX, NEIGHBOUR_FRAGMENT),
+            effect: new Shader(gl, EFFECT_VERTEX, EFFECT_FRAGMENT),
+            composite: new Shader(gl, Shader.FULLSCREEN_VERTEX, COMPOSITE_FRAGMENT)
+        };
+
+        if (this.supported) {
+            this.half = new RenderTarget(gl, [gl.RGBA16F, gl.RGBA16F]);
+            this.tiles = new RenderTarget(gl, [gl.RGBA16F], false, gl.NEAREST);
+            this.neighbours = new RenderTarget(gl, [gl.RGBA16F], false, gl.NEAREST);
+            this.effect = new RenderTarget(gl, [gl.RGBA16F]);
+        }
+    }
+
+    // Binds the scene target, everything drawn until end() lands in it
+    public begin(width: number, height: number): void {
+        this.scene.resize(width, height);
+        this.scene.bind();
+    }
+
+    // source replaces the scene target for frames that were not rendered, e.g. reprojected ones
+    public end(camera: Camera, source: RenderTarget = this.scene): void {
+        const gl = this.gl;
+        const active = source === this.scene && this.supported && (this.moving(camera) || this.depthOfField.enabled);
+
+        gl.disable(gl.DEPTH_TEST);
+        gl.disable(gl.BLEND);
+        gl.bindVertexArray(this.emptyVao);
+
+        if (active) {
+            this.runEffects(camera);
+        }
+
+        const composite = this.shaders.composite;
+
+        gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+        gl.viewport(0, 0, gl.drawingBufferWidth, gl.drawingBufferHeight);
+        composite.use();
+        this.bindTexture(0, source.texture, composite, 'scene');
+
+        if (active) {
+            this.bindTexture(1, this.effect!.texture, composite, 'effect');
+        }
+
+        gl.uniform1i(composite.uniform('useEffect'), active ? 1 : 0);
+        gl.uniform1f(composite.uniform('exposure'), this.exposure);
+        gl.uniform3f(composite.uniform('vignette'), this.vignette.inner, this.vignette.outer, this.vignette.strength);
+        gl.uniform4f(composite.uniform('staticNoise'), this.staticNoise.intensity, this.staticNoise.flicker, this.staticNoise.dropout, this.staticNoise.seed);
+        gl.drawArrays(gl.TRIANGLES, 0, 3);
+
+        gl.bindVertexArray(null);
+        gl.activeTexture(gl.TEXTURE0);
+        gl.enable(gl.DEPTH_TEST);
+    }
+
+    public dispose(): void {
+        for (const shader of Object.values(this.shaders)) {
+            shader.dispose();
+        }
+
+        for (const target of [this.scene, this.half, this.tiles, this.neighbours, this.effect]) {
+            target?.dispose();
+        }
+
+        this.gl.deleteVertexArray(this.emptyVao);
+    }
+
+    // A still camera with depth of field off skips every effect pass, only the composite runs
+    private moving(camera: Camera): boolean {
+        if (!this.motionBlur.enabled) {
+            return false;
+        }
+
+        for (let i = 0; i < 16; i++) {
+            if (Math.abs(camera.viewProjection[i] - camera.previousViewProjection[i]) > 1e-6) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    private runEffects(camera: Camera): void {
+        const gl = this.gl;
+        const half = this.half!;
+        const tiles = this.tiles!;
+        const neighbours = this.neighbours!;
+        const effect = this.effect!;
+        const width = Math.ceil(this.scene.width / this.divisor);
+        const height = Math.ceil(this.scene.height / this.divisor);
+        const tilesX = Math.ceil(width / TILE);
+        const tilesY = Math.ceil(height / TILE);
+        const dof = this.depthOfField;
+
+        half.resize(width, height);
+        effect.resize(width, height);
+        tiles.resize(tilesX, tilesY);
+        neighbours.resize(tilesX, tilesY);
+
+        Camera.multiply(this.reprojection, camera.previousViewProjection, camera.inverseViewProjection);
+
+        const prepare = this.shaders.prepare;
+
+        half.bind();
+        prepare.use();
+        this.bindTexture(0, this.scene.texture, prepare, 'scene');
+        this.bindTexture(1, this.scene.depth!, prepare, 'depth');
+        gl.uniformMatrix4fv(prepare.uniform('reprojection'), false, this.reprojection);
+        gl.uniform2f(prepare.uniform('resolution'), width, height);
+        gl.uniform1f(prepare.uniform('shutter'), this.motionBlur.enabled ? this.motionBlur.shutter : 0);
+        gl.uniform2f(prepare.uniform('clipRange'), camera.near, camera.far);
+        gl.uniform3f(prepare.uniform('focus'), dof.focusDistance, Math.max(1e-3, dof.focusRange), dof.enabled ? dof.maxRadius : 0);
+        gl.drawArrays(gl.TRIANGLES, 0, 3);
+
+        tiles.bind();
+        this.shaders.tile.use();
+        this.bindTexture(0, half.textures[1], this.shaders.tile, 'motion');
+        gl.drawArrays(gl.TRIANGLES, 0, 3);
+
+        neighbours.bind();
+        this.shaders.neighbour.use();
+        this.bindTexture(0, tiles.texture, this.shaders.neighbour, 'tiles');
+        gl.drawArrays(gl.TRIANGLES, 0, 3);
+
+        const shader = this.shaders.effect;
+
+        effect.bind();
+        gl.clearColor(0, 0, 0, 0);
+        gl.clear(gl.COLOR_BUFFER_BIT);
+
+        shader.use();
+        this.bindTexture(0, neighbours.texture, shader, 'tiles');
+        this.bindTexture(1, half.textures[0], shader, 'color');
+        this.bindTexture(2, half.textures[1], shader, 'motion');
+        gl.uniform2f(shader.uniform('tileSize'), TILE / width, TILE / height);
+        gl.uniform1i(shader.uniform('tilesPerRow'), tilesX);
+        gl.uniform1f(shader.uniform('threshold'), THRESHOLD);
+        gl.uniform2f(shader.uniform('texel'), 1 / width, 1 / height);
+        gl.drawArraysInstanced(gl.TRIANGLES, 0, 6, tilesX * tilesY);
+    }
+
+    private bindTexture(unit: number, texture: WebGLTexture, shader: Shader, name: string): void {
+        const gl = this.gl;
+
+        gl.activeTexture(gl.TEXTURE0 + unit);
+        gl.bindTexture(gl.TEXTURE_2D, texture);
+        gl.uniform1i(shader.uniform(name), unit);
+    }
+}
+
+export type { MotionBlurSettings, DepthOfFieldSettings, VignetteSettings };
+export default PostChain;
@@ -0,0 +1,312 @@
+import type Camera from './Camera';
+import type GeometryArena from './GeometryArena';
+import type { ArenaMesh } from './GeometryArena';
+import Primitives from './Primitives';
+import Shader from './Shader';
+
+const MAX_JOINTS = 32;
+const JOINT_BYTES = MAX_JOINTS * 64;
+// Bounds follow the root joint, the margin covers limbs bending away from it
+const BOUNDS_MARGIN = 1.5;
+
+// Linear blend skinning, captured as the arena's position normal layout
+const SKIN_VERTEX = `#version 300 es
+#define MAX_JOINTS ${MAX_JOINTS}
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in uvec4 joints;
+layout(location = 3) in vec4 weights;
+
+layout(std140) uniform Joints {
+    mat4 jointMatrices[MAX_JOINTS];
+};
+
+out vec3 skinnedPosition;
+out vec3 skinnedNormal;
+
+void main() {
+    mat4 skin = jointMatrices[joints.x] * weights.x
+        + jointMatrices[joints.y] * weights.y
+        + jointMatrices[joints.z] * weights.z
+        + jointMatrices[joints.w] * weights.w;
+
+    skinnedPosition = (skin * vec4(position, 1.0)).xyz;
+    skinnedNormal = normalize(mat3(skin) * normal);
+}`;
+
+const DISCARD_FRAGMENT = `#version 300 es
+precision lowp float;
+
+out vec4 outColor;
+
+void main() {
+    outColor = vec4(0.0);
+}`;
+
+interface SkinnedMesh {
+    // Skinned output, drawn through the arena like any static mesh
+    readonly target: ArenaMesh;
+    material: number;
+    // Column major bind pose to world matrix per joint, written by whatever animates the character
+    readonly joints: Float32Array;
+    // Set by update(), false when the bounds were outside the view and the mesh was neither skinned nor drawn
+    visible: boolean;
+    source: WebGLBuffer;
+    vao: WebGLVertexArrayObject;
+    // Bind pose bounding sphere
+    center: Float32Array;
+    radius: number;
+}
+
+interface SkinningStats {
+    characters: number;
+    visible: number;
+    // Vertices run through the skinning shader this frame, once each
+    skinnedVertices: number;
+    // Arena flushes in the previous frame, each one would have skinned every vertex again
+    passes: number;
+    // Skinning vertex shader runs saved per frame compared to skinning in every pass
+    savedVertices: number;
+}
+
+// Skins every visible character once per frame, before any pass draws
+//
+// Transform feedback writes the skinned vertices straight into the character's own arena mesh, so the
+// depth prepass, the material pass, both multi-resolution viewports and the overdraw probe all draw
+// plain static geometry. Skinning cost no longer grows with the number of passes, and skinned
+// characters batch with static meshes of the same material.
+class PreSkinning {
+    private gl: WebGL2RenderingContext;
+    private arena: GeometryArena;
+    private shader: Shader;
+    private feedback: WebGLTransformFeedback;
+    private jointBuffer: WebGLBuffer;
+    private jointData: Float32Array = new Float32Array(0);
+    private jointStride: number;
+    private meshes: Set<SkinnedMesh> = new Set();
+    private lastFlushes: number = 0;
+    private current: SkinningStats = { characters: 0, visible: 0, skinnedVertices: 0, passes: 0, savedVertices: 0 };
+
+    constructor(gl: WebGL2RenderingContext, arena: GeometryArena) {
+        const alignment = gl.getParameter(gl.UNIFORM_BUFFER_OFFSET_ALIGNMENT) as number;
+
+        this.gl = gl;
+        this.arena = arena;
+        this.shader = new Shader(gl, SKIN_VERTEX, DISCARD_FRAGMENT, ['skinnedPosition', 'skinnedNormal']);
+        this.feedback = gl.createTransformFeedback();
+        this.jointBuffer = gl.createBuffer();
+        this.jointStride = Math.ceil(JOINT_BYTES / alignment) * alignment;
+
+        gl.uniformBlockBinding(this.shader.program, gl.getUniformBlockIndex(this.shader.program, 'Joints'), 0);
+    }
+
+    // vertices in the Primitives.Skinned layout, the arena mesh starts out in the bind pose
+    public create(vertices: ArrayBuffer, indices: Uint32Array, jointCount: number, material: number): SkinnedMesh {
+        const gl = this.gl;
+        const format = Primitives.Skinned;
+        const vertexCount = vertices.byteLength / format.stride;
+
+        if (jointCount > MAX_JOINTS) {
+            throw new Error(`Skinned Mesh has ${jointCount} Joints, at most ${MAX_JOINTS} are Supported.`);
+        }
+
+        const floats = new Float32Array(vertices);
+        const bindPose = new Float32Array(vertexCount * 6);
+        const center = new Float32Array(3);
+        let radius = 0;
+
+        for (let i = 0; i < vertexCount; i++) {
+            bindPose.set(floats.subarray(i * format.stride / 4, i * format.stride / 4 + 6), i * 6);
+
+            for (let k = 0; k < 3; k++) {
+                center[k] += bindPose[i * 6 + k] / vertexCount;
+            }
+        }
+
+        for (let i = 0; i < vertexCount; i++) {
+            radius = Math.max(radius, Math.hypot(bindPose[i * 6] - center[0], bindPose[i * 6 + 1] - center[1], bindPose[i * 6 + 2] - center[2]));
+        }
+
+        const source = gl.createBuffer();
+        const vao = gl.createVertexArray();
+
+        gl.bindVertexArray(vao);
+        gl.bindBuffer(gl.ARRAY_BUFFER, source);
+        gl.bufferData(gl.ARRAY_BUFFER, vertices, gl.STATIC_DRAW);
+
+        for (const attribute of format.attributes) {
+            gl.enableVertexAttribArray(attribute.location);
+
+            if (attribute.normalized || attribute.type === gl.FLOAT) {
+                gl.vertexAttribPointer(attribute.location, attribute.size, attribute.type, attribute.normalized, format.stride, attribute.offset);
+            } else {
+                gl.vertexAttribIPointer(attribute.location, attribute.size, attribute.type, format.stride, attribute.offset);
+            }
+        }
+
+        gl.bindVertexArray(null);
+        gl.bindBuffer(gl.ARRAY_BUFFER, null);
+
+        const joints = new Float32Array(jointCount * 16);
+
+        for (let j = 0; j < jointCount; j++) {
+            joints.set([1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1], j * 16);
+        }
+
+        const mesh: SkinnedMesh = {
+            target: this.arena.allocate(Primitives.PositionNormal, bindPose, indices),
+            material,
+            joints,
+            visible: false,
+            source,
+            vao,
+            center,
+            radius
+        };
+
+        this.meshes.add(mesh);
+
+        return mesh;
+    }
+
+    public release(mesh: SkinnedMesh): void {
+        if (!this.meshes.delete(mesh)) {
+            return;
+        }
+
+        this.arena.release(mesh.target);
+        this.gl.deleteBuffer(mesh.source);
+        this.gl.deleteVertexArray(mesh.vao);
+    }
+
+    // Culls, skins what is left in one transform feedback draw per character and queues it in the arena
+    public update(camera: Camera): void {
+        const stats = this.current;
+
+        stats.passes = this.arena.flushes - this.lastFlushes;
+        stats.characters = this.meshes.size;
+        stats.visible = 0;
+        stats.skinnedVertices = 0;
+        this.lastFlushes = this.arena.flushes;
+
+        if (this.meshes.size === 0) {
+            stats.savedVertices = 0;
+            return;
+        }
+
+        const visible: SkinnedMesh[] = [];
+
+        for (const mesh of this.meshes) {
+            mesh.visible = this.cull(mesh, camera.viewProjection);
+
+            if (mesh.visible) {
+                visible.push(mesh);
+            }
+        }
+
+        if (visible.length > 0) {
+            this.uploadJoints(visible);
+            this.skin(visible);
+        }
+
+        for (const mesh of visible) {
+            this.arena.draw(mesh.target, mesh.material);
+            stats.skinnedVertices += mesh.target.vertexCount;
+        }
+
+        stats.visible = visible.length;
+        stats.savedVertices = stats.skinnedVertices * Math.max(0, stats.passes - 1);
+    }
+
+    public get stats(): SkinningStats {
+        return { ...this.current };
+    }
+
+    public dispose(): void {
+        for (const mesh of [...this.meshes]) {
+            this.release(mesh);
+        }
+
+        this.shader.dispose();
+        this.gl.deleteTransformFeedback(this.feedback);
+        this.gl.deleteBuffer(this.jointBuffer);
+    }
+
+    // Sphere against the six planes of viewProjection, rows combined as in Gribb and Hartmann
+    // The world center goes through the root joint, which also moves the arena's sort key along
+    private cull(mesh: SkinnedMesh, m: Float32Array): boolean {
+        const j = mesh.joints;
+        const [cx, cy, cz] = mesh.center;
+        const x = j[0] * cx + j[4] * cy + j[8] * cz + j[12];
+        const y = j[1] * cx + j[5] * cy + j[9] * cz + j[13];
+        const z = j[2] * cx + j[6] * cy + j[10] * cz + j[14];
+        const radius = mesh.radius * BOUNDS_MARGIN;
+
+        mesh.target.center[0] = x;
+        mesh.target.center[1] = y;
+        mesh.target.center[2] = z;
+
+        for (let plane = 0; plane < 6; plane++) {
+            const row = plane >> 1;
+            const sign = plane & 1 ? -1 : 1;
+            const a = m[3] + sign * m[row];
+            const b = m[7] + sign * m[4 + row];
+            const c = m[11] + sign * m[8 + row];
+            const d = m[15] + sign * m[12 + row];
+
+            if (a * x + b * y + c * z + d < -radius * Math.hypot(a, b, c)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // One upload for every visible character, each binds its own aligned range
+    private uploadJoints(visible: SkinnedMesh[]): void {
+        const gl = this.gl;
+        const floats = visible.length * this.jointStride / 4;
+
+        if (this.jointData.length < floats) {
+            this.jointData = new Float32Array(floats * 2);
+        }
+
+        visible.forEach((mesh, i) => this.jointData.set(mesh.joints, i * this.jointStride / 4));
+
+        gl.bindBuffer(gl.UNIFORM_BUFFER, this.jointBuffer);
+        gl.bufferData(gl.UNIFORM_BUFFER, this.jointData.subarray(0, floats), gl.DYNAMIC_DRAW);
+        gl.bindBuffer(gl.UNIFORM_BUFFER, null);
+    }
+
+    // The arena's vertex buffer is only attached to its own vertex array, free to capture into here
+    private skin(visible: SkinnedMesh[]): void {
+        const gl = this.gl;
+        const stride = Primitives.PositionNormal.stride;
+
+        this.shader.use();
+        gl.enable(gl.RASTERIZER_DISCARD);
+        gl.bindTransformFeedback(gl.TRANSFORM_FEEDBACK, this.feedback);
+
+        visible.forEach((mesh, i) => {
+            const target = mesh.target;
+
+            gl.bindBufferRange(gl.UNIFORM_BUFFER, 0, this.jointBuffer, i * this.jointStride, JOINT_BYTES);
+            gl.bindBufferRange(gl.TRANSFORM_FEEDBACK_BUFFER, 0, target.pool.vbo, target.firstVertex * stride, target.vertexCount * stride);
+            gl.bindVertexArray(mesh.vao);
+            gl.beginTransformFeedback(gl.POINTS);
+            gl.drawArrays(gl.POINTS, 0, target.vertexCount);
+            gl.endTransformFeedback();
+        });
+
+        // A buffer still bound for capture cannot be drawn from
+        gl.bindBufferBase(gl.TRANSFORM_FEEDBACK_BUFFER, 0, null);
+        gl.bindTransformFeedback(gl.TRANSFORM_FEEDBACK, null);
+        gl.bindBufferBase(gl.UNIFORM_BUFFER, 0, null);
+        gl.bindVertexArray(null);
+        gl.disable(gl.RASTERIZER_DISCARD);
+    }
+}
+
+export type { SkinnedMesh, SkinningStats };
+export default PreSkinning;
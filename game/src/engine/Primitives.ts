@@ -0,0 +1,102 @@
+import type { VertexFormat } from './GeometryArena';
+
+// position xyz, normal xyz
+const PositionNormal: VertexFormat = {
+    name: 'p3n3',
+    stride: 24,
+    attributes: [
+        { location: 0, size: 3, type: WebGL2RenderingContext.FLOAT, normalized: false, offset: 0 },
+        { location: 1, size: 3, type: WebGL2RenderingContext.FLOAT, normalized: false, offset: 12 }
+    ]
+};
+
+// Bind pose position xyz, normal xyz, 4 joint indices, 4 joint weights (unorm8, summing to 255)
+// Input of PreSkinning, the arena only ever holds its skinned PositionNormal output
+const Skinned: VertexFormat = {
+    name: 'p3n3j4w4',
+    stride: 32,
+    attributes: [
+        { location: 0, size: 3, type: WebGL2RenderingContext.FLOAT, normalized: false, offset: 0 },
+        { location: 1, size: 3, type: WebGL2RenderingContext.FLOAT, normalized: false, offset: 12 },
+        { location: 2, size: 4, type: WebGL2RenderingContext.UNSIGNED_BYTE, normalized: false, offset: 24 },
+        { location: 3, size: 4, type: WebGL2RenderingContext.UNSIGNED_BYTE, normalized: true, offset: 28 }
+    ]
+};
+
+const FACES = [
+    [0, 0, 1], [0, 0, -1], [1, 0, 0], [-1, 0, 0], [0, 1, 0], [0, -1, 0]
+];
+
+// Axis aligned box baked into world space, static meshes carry no transform of their own
+const box = (x: number, y: number, z: number, sx: number, sy: number, sz: number): { vertices: Float32Array; indices: Uint32Array } => {
+    const vertices = new Float32Array(24 * 6);
+    const indices = new Uint32Array(36);
+
+    FACES.forEach(([nx, ny, nz], face) => {
+        // Two axes spanning the face, chosen so the winding is counter clockwise from outside
+        const u = nx !== 0 ? [0, nx, 0] : ny !== 0 ? [0, 0, ny] : [nz, 0, 0];
+        const v = [ny * u[2] - nz * u[1], nz * u[0] - nx * u[2], nx * u[1] - ny * u[0]];
+
+        for (let corner = 0; corner < 4; corner++) {
+            const a = corner === 1 || corner === 2 ? 1 : -1;
+            const b = corner >= 2 ? 1 : -1;
+            const at = (face * 4 + corner) * 6;
+
+            vertices[at] = x + (nx + u[0] * a + v[0] * b) * sx / 2;
+            vertices[at + 1] = y + (ny + u[1] * a + v[1] * b) * sy / 2;
+            vertices[at + 2] = z + (nz + u[2] * a + v[2] * b) * sz / 2;
+            vertices[at + 3] = nx;
+            vertices[at + 4] = ny;
+            vertices[at + 5] = nz;
+        }
+
+        indices.set([0, 1, 2, 0, 2, 3].map((i) => face * 4 + i), face * 6);
+    });
+
+    return { vertices, indices };
+};
+
+// Open cylinder standing on the origin, split into joints segments of equal height along +y
+// Rings blend between the two nearest joints, joint j's bind pose pivot is at y = j * height / joints
+const tube = (radius: number, height: number, joints: number, sides: number = 12, ringsPerJoint: number = 4): { vertices: ArrayBuffer; indices: Uint32Array } => {
+    const rings = joints * ringsPerJoint + 1;
+    const vertices = new ArrayBuffer(rings * sides * Skinned.stride);
+    const floats = new Float32Array(vertices);
+    const bytes = new Uint8Array(vertices);
+    const indices = new Uint32Array((rings - 1) * sides * 6);
+    const segment = height / joints;
+
+    for (let ring = 0; ring < rings; ring++) {
+        const y = ring / (rings - 1) * height;
+        // Weight shifts from joint to joint + 1 over the upper half of each segment
+        const along = Math.min(joints - 1, y / segment);
+        const joint = Math.min(joints - 1, Math.floor(along));
+        const blend = joint + 1 < joints ? Math.max(0, (along - joint - 0.5) * 2) : 0;
+
+        for (let side = 0; side < sides; side++) {
+            const angle = side / sides * Math.PI * 2;
+            const at = (ring * sides + side) * Skinned.stride;
+            const nx = Math.cos(angle);
+            const nz = Math.sin(angle);
+
+            floats.set([nx * radius, y, nz * radius, nx, 0, nz], at / 4);
+            bytes.set([joint, Math.min(joints - 1, joint + 1), 0, 0], at + 24);
+            bytes.set([255 - Math.round(blend * 255), Math.round(blend * 255), 0, 0], at + 28);
+        }
+    }
+
+    for (let ring = 0; ring + 1 < rings; ring++) {
+        for (let side = 0; side < sides; side++) {
+            const a = ring * sides + side;
+            const b = ring * sides + (side + 1) % sides;
+
+            indices.set([a, a + sides, b, b, a + sides, b + sides], (ring * sides + side) * 6);
+        }
+    }
+
+    return { vertices, indices };
+};
+
+const Primitives = { PositionNormal, Skinned, box, tube };
+
+export default Primitives;
@@ -0,0 +1,17 @@
+// Seeded generator (mulberry32), the same seed always rebuilds the same scene
+const createRandom = (seed: number): (() => number) => {
+    let state = seed >>> 0;
+
+    return () => {
+        state = (state + 0x6d2b79f5) >>> 0;
+
+        let t = state;
+
+        t = Math.imul(t ^ (t >>> 15), t | 1);
+        t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+
+        return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+    };
+};
+
+export default createRandom;
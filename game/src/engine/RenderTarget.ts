@@ -0,0 +1,132 @@
+interface TextureFormat {
+    format: number;
+    type: number;
+}
+
+const formatOf = (gl: WebGL2RenderingContext, internalFormat: number): TextureFormat => {
+    switch (internalFormat) {
+        case gl.RGBA8:
+            return { format: gl.RGBA, type: gl.UNSIGNED_BYTE };
+        case gl.RGBA16F:
+            return { format: gl.RGBA, type: gl.HALF_FLOAT };
+        case gl.RG16F:
+            return { format: gl.RG, type: gl.HALF_FLOAT };
+        case gl.R8:
+            return { format: gl.RED, type: gl.UNSIGNED_BYTE };
+        case gl.R16F:
+            return { format: gl.RED, type: gl.HALF_FLOAT };
+        case gl.DEPTH_COMPONENT24:
+            return { format: gl.DEPTH_COMPONENT, type: gl.UNSIGNED_INT };
+        default:
+            throw new Error(`Render Target Format ${internalFormat} is not Supported.`);
+    }
+};
+
+// Framebuffer with texture attachments that can be sampled by later passes
+class RenderTarget {
+    public readonly framebuffer: WebGLFramebuffer;
+    public textures: WebGLTexture[] = [];
+    public depth: WebGLTexture | null = null;
+    public width: number = 0;
+    public height: number = 0;
+
+    private gl: WebGL2RenderingContext;
+    private formats: number[];
+    private hasDepth: boolean;
+    private filter: number;
+
+    constructor(gl: WebGL2RenderingContext, formats: number[], depth: boolean = false, filter: number = gl.LINEAR) {
+        this.gl = gl;
+        this.framebuffer = gl.createFramebuffer();
+        this.formats = formats;
+        this.hasDepth = depth;
+        this.filter = filter;
+    }
+
+    public get texture(): WebGLTexture {
+        return this.textures[0];
+    }
+
+    public resize(width: number, height: number): void {
+        const gl = this.gl;
+
+        width = Math.max(1, Math.floor(width));
+        height = Math.max(1, Math.floor(height));
+
+        if (width === this.width && height === this.height) {
+            return;
+        }
+
+        this.release();
+
+        gl.bindFramebuffer(gl.FRAMEBUFFER, this.framebuffer);
+
+        this.textures = this.formats.map((internalFormat, i) => {
+            const texture = this.createTexture(internalFormat, width, height, this.filter);
+
+            gl.framebufferTexture2D(gl.FRAMEBUFFER, gl.COLOR_ATTACHMENT0 + i, gl.TEXTURE_2D, texture, 0);
+
+            return texture;
+        });
+
+        gl.drawBuffers(this.formats.map((_, i) => gl.COLOR_ATTACHMENT0 + i));
+
+        if (this.hasDepth) {
+            // Depth textures are not filterable
+            this.depth = this.createTexture(gl.DEPTH_COMPONENT24, width, height, gl.NEAREST);
+            gl.framebufferTexture2D(gl.FRAMEBUFFER, gl.DEPTH_ATTACHMENT, gl.TEXTURE_2D, this.depth, 0);
+        }
+
+        if (gl.checkFramebufferStatus(gl.FRAMEBUFFER) !== gl.FRAMEBUFFER_COMPLETE) {
+            throw new Error('Render Target is Incomplete, the Format may not be Renderable on this System.');
+        }
+
+        gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+        gl.bindTexture(gl.TEXTURE_2D, null);
+
+        this.width = width;
+        this.height = height;
+    }
+
+    public bind(): void {
+        this.gl.bindFramebuffer(this.gl.FRAMEBUFFER, this.framebuffer);
+        this.gl.viewport(0, 0, this.width, this.height);
+    }
+
+    public dispose(): void {
+        this.release();
+        this.gl.deleteFramebuffer(this.framebuffer);
+    }
+
+    private createTexture(internalFormat: number, width: number, height: number, filter: number): WebGLTexture {
+        const gl = this.gl;
+        const { format, type } = formatOf(gl, internalFormat);
+        const texture = gl.createTexture();
+
+        gl.bindTexture(gl.TEXTURE_2D, texture);
+        gl.texImage2D(gl.TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, null);
+        gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MIN_FILTER, filter);
+        gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MAG_FILTER, filter);
+        gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
+        gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
+
+        return texture;
+    }
+
+    private release(): void {
+        for (const texture of this.textures) {
+            this.gl.deleteTexture(texture);
+        }
+
+        if (this.depth) {
+            this.gl.deleteTexture(this.depth);
+        }
+
+        this.textures = [];
+        this.depth = null;
+        this.width = 0;
+        this.height = 0;
+    }
+}
+
+export default RenderTarget;
@@ -0,0 +1,130 @@
+type ResourceKind = 'gpu' | 'audio' | 'video' | 'dom' | 'data';
+
+interface ScopeReport {
+    scope: string;
+    resources: number;
+    // Estimated bytes per kind, GPU and decoder memory is not observable from script
+    bytes: Record<ResourceKind, number>;
+    total: number;
+    releaseMs: number;
+}
+
+interface Entry {
+    kind: ResourceKind;
+    resource: unknown;
+    release: (resource: unknown) => void;
+    bytes: number;
+}
+
+// Chromium keeps a small pool of decoded frames per playing video, in NV12 at 1.5 bytes per pixel
+const DECODED_FRAMES = 4;
+const DECODED_BYTES_PER_PIXEL = 1.5;
+
+// Everything one game state allocated, released together when the state ends
+class ResourceScope {
+    public readonly name: string;
+
+    private entries: Entry[] = [];
+    private released: boolean = false;
+
+    constructor(name: string) {
+        this.name = name;
+    }
+
+    public get bytes(): number {
+        return this.entries.reduce((sum, entry) => sum + entry.bytes, 0);
+    }
+
+    public track<T>(kind: ResourceKind, resource: T, release: (resource: T) => void, bytes: number = 0): T {
+        if (this.released) {
+            throw new Error(`Resource Scope ${this.name} has Already been Released.`);
+        }
+
+        this.entries.push({ kind, resource, release: release as (resource: unknown) => void, bytes });
+
+        return resource;
+    }
+
+    public texture(gl: WebGL2RenderingContext, texture: WebGLTexture, bytes: number): WebGLTexture {
+        return this.track('gpu', texture, (t) => gl.deleteTexture(t), bytes);
+    }
+
+    public buffer(gl: WebGL2RenderingContext, buffer: WebGLBuffer, bytes: number): WebGLBuffer {
+        return this.track('gpu', buffer, (b) => gl.deleteBuffer(b), bytes);
+    }
+
+    public disposable<T extends { dispose(): void }>(kind: ResourceKind, object: T, bytes: number = 0): T {
+        return this.track(kind, object, (o) => o.dispose(), bytes);
+    }
+
+    public audio(context: AudioContext): AudioContext {
+        return this.track('audio', context, (c) => c.close());
+    }
+
+    // Removes the element on release, videos inside it also drop their decoder instead of waiting for GC
+    public element<T extends Element>(element: T): T {
+        this.track('dom', element, (e) => e.remove());
+
+        for (const video of element.querySelectorAll('video')) {
+            this.video(video);
+        }
+
+        return element;
+    }
+
+    public video(video: HTMLVideoElement): HTMLVideoElement {
+        const decoded = (): number => video.videoWidth * video.videoHeight * DECODED_BYTES_PER_PIXEL * DECODED_FRAMES;
+
+        this.track('video', video, (v) => {
+            v.pause();
+            v.removeAttribute('src');
+
+            for (const source of v.querySelectorAll('source')) {
+                source.remove();
+            }
+
+            // Loading with no source is what actually tears down the media pipeline
+            v.load();
+        }, decoded());
+
+        // The size is unknown until metadata arrives, which is usually after the menu was set up
+        if (video.readyState < HTMLMediaElement.HAVE_METADATA) {
+            const entry = this.entries[this.entries.length - 1];
+
+            video.addEventListener('loadedmetadata', () => {
+                entry.bytes = decoded();
+            }, { once: true });
+        }
+
+        return video;
+    }
+
+    // Releases in reverse order so later resources that depend on earlier ones go first
+    public release(): ScopeReport {
+        const start = performance.now();
+        const bytes: Record<ResourceKind, number> = { gpu: 0, audio: 0, video: 0, dom: 0, data: 0 };
+
+        for (let i = this.entries.length - 1; i >= 0; i--) {
+            const entry = this.entries[i];
+
+            entry.release(entry.resource);
+            bytes[entry.kind] += entry.bytes;
+        }
+
+        const report: ScopeReport = {
+            scope: this.name,
+            resources: this.entries.length,
+            bytes,
+            total: Object.values(bytes).reduce((sum, value) => sum + value, 0),
+            releaseMs: performance.now() - start
+        };
+
+        this.entries = [];
+        this.released = true;
+
+        return report;
+    }
+}
+
+export type { ResourceKind, ScopeReport };
+export default ResourceScope;
@@ -0,0 +1,81 @@
+class Shader {
+    // Single triangle covering the screen, draw with drawArrays(TRIANGLES, 0, 3) and no attributes
+    public static readonly FULLSCREEN_VERTEX = `#version 300 es
+out vec2 uv;
+
+void main() {
+    uv = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+}`;
+
+    public readonly program: WebGLProgram;
+    private gl: WebGL2RenderingContext;
+    private uniforms: Map<string, WebGLUniformLocation | null> = new Map();
+
+    // feedback names vertex outputs captured by transform feedback, interleaved in the order given
+    constructor(gl: WebGL2RenderingContext, vertex: string, fragment: string, feedback: string[] = []) {
+        this.gl = gl;
+        this.program = gl.createProgram();
+
+        const vs = Shader.compile(gl, gl.VERTEX_SHADER, vertex);
+        const fs = Shader.compile(gl, gl.FRAGMENT_SHADER, fragment);
+
+        gl.attachShader(this.program, vs);
+        gl.attachShader(this.program, fs);
+
+        if (feedback.length > 0) {
+            gl.transformFeedbackVaryings(this.program, feedback, gl.INTERLEAVED_ATTRIBS);
+        }
+
+        gl.linkProgram(this.program);
+        gl.deleteShader(vs);
+        gl.deleteShader(fs);
+
+        if (!gl.getProgramParameter(this.program, gl.LINK_STATUS)) {
+            throw new Error(`Shader Program Failed to Link: ${gl.getProgramInfoLog(this.program)}`);
+        }
+    }
+
+    public use(): void {
+        this.gl.useProgram(this.program);
+    }
+
+    public uniform(name: string): WebGLUniformLocation | null {
+        let location = this.uniforms.get(name);
+
+        if (location === undefined) {
+            location = this.gl.getUniformLocation(this.program, name);
+            this.uniforms.set(name, location);
+        }
+
+        return location;
+    }
+
+    public dispose(): void {
+        this.gl.deleteProgram(this.program);
+        this.uniforms.clear();
+    }
+
+    private static compile(gl: WebGL2RenderingContext, type: number, source: string): WebGLShader {
+        const shader = gl.createShader(type);
+
+        if (!shader) {
+            throw new Error('Could not Create a Shader Object.');
+        }
+
+        gl.shaderSource(shader, source);
+        gl.compileShader(shader);
+
+        if (!gl.getShaderParameter(shader, gl.COMPILE_STATUS)) {
+            const log = gl.getShaderInfoLog(shader);
+
+            gl.deleteShader(shader);
+
+            throw new Error(`Shader Failed to Compile: ${log}`);
+        }
+
+        return shader;
+    }
+}
+
+export default Shader;
@@ -0,0 +1,173 @@
+import type Level from './Level';
+import { TRANSFORM_STRIDE } from './Level';
+import SimulationState from './SimulationState';
+import SnapshotBuffer, { ANIMATION_STRIDE, EFFECT_COUNT, MAX_ENTITIES } from './SnapshotBuffer';
+import type { SimulationMessage } from './Simulation.worker';
+
+// Metres the player moves before the worker hears about it, the LOD does not need every frame
+const FOCUS_STEP = 0.5;
+
+// Render side of the simulation, interpolates between the two newest published ticks
+//
+// The fixed tick runs in a worker and never waits for a frame, frames never wait for a tick either.
+// Rendering one tick in the past keeps both snapshots of the interpolation in hand.
+class Simulation {
+    // Interpolated state for this frame, same layout as the snapshots
+    public readonly transforms: Float32Array = new Float32Array(MAX_ENTITIES * TRANSFORM_STRIDE);
+    public readonly animation: Float32Array = new Float32Array(MAX_ENTITIES * ANIMATION_STRIDE);
+    public readonly effects: Float32Array = new Float32Array(EFFECT_COUNT);
+    public count: number = 0;
+    // Seeds the simulation's random stream and everything that has to stay in step with it
+    public readonly seed: number;
+    // False when there is no shared memory, the ticks then run on this thread before each frame
+    public readonly threaded: boolean = false;
+
+    private snapshots: SnapshotBuffer;
+    private worker: Worker | null = null;
+    private local: SimulationState | null = null;
+    private tickMs: number;
+    private focusX: number = Infinity;
+    private focusZ: number = Infinity;
+
+    constructor(tickRate: number = 30, seed: number = 1) {
+        this.tickMs = 1000 / tickRate;
+        this.seed = seed;
+        this.snapshots = SnapshotBuffer.create(typeof SharedArrayBuffer !== 'undefined');
+
+        if (this.snapshots.buffer instanceof SharedArrayBuffer) {
+            this.worker = new Worker(new URL('./Simulation.worker.ts', import.meta.url), { type: 'module' });
+
+            // Posting shared memory throws when the page is not cross origin isolated
+            try {
+                this.post({ type: 'start', buffer: this.snapshots.buffer, tickRate, seed });
+                this.threaded = true;
+            } catch {
+                this.worker.terminate();
+                this.worker = null;
+                this.snapshots = SnapshotBuffer.create(false);
+            }
+        }
+
+        if (!this.threaded) {
+            this.local = new SimulationState(tickRate, seed);
+        }
+    }
+
+    public get tornReads(): number {
+        return this.snapshots.tornReads;
+    }
+
+    // The worker gets its own copy, the render side keeps reading the original
+    public load(level: Level): void {
+        if (this.local) {
+            this.local.load(level);
+
+            return;
+        }
+
+        // Nothing writes to a level, a shared one is handed over as it is
+        if (level.bytes.buffer instanceof SharedArrayBuffer) {
+            this.post({ type: 'level', bytes: level.bytes });
+
+            return;
+        }
+
+        const copy = level.bytes.slice();
+
+        this.post({ type: 'level', bytes: copy }, [copy.buffer]);
+    }
+
+    // Player position for the simulation LOD
+    public focus(position: Float32Array): void {
+        const x = position[0];
+        const z = position[2];
+
+        if (Math.abs(x - this.focusX) < FOCUS_STEP && Math.abs(z - this.focusZ) < FOCUS_STEP) {
+            return;
+        }
+
+        this.focusX = x;
+        this.focusZ = z;
+
+        if (this.local) {
+            this.local.lod.focus(x, z);
+        } else {
+            this.post({ type: 'focus', x, z });
+        }
+    }
+
+    // Returns false until two ticks have been published, the outputs keep their last values then
+    public sample(): boolean {
+        this.local?.advance(this.snapshots);
+
+        if (!this.snapshots.update()) {
+            return false;
+        }
+
+        const { previous, latest } = this.snapshots;
+        const span = latest.time - previous.time;
+        const t = span > 0 ? Math.min(1, Math.max(0, (SimulationState.now() - this.tickMs - previous.time) / span)) : 1;
+        const shared = Math.min(previous.count, latest.count);
+
+        this.count = latest.count;
+
+        for (let i = 0; i < shared; i++) {
+            this.blendTransform(i, previous.transforms, latest.transforms, t);
+
+            // Phases wrap at 1, blend along the shorter way round
+            const a = previous.animation[i * ANIMATION_STRIDE + 1];
+            let delta = latest.animation[i * ANIMATION_STRIDE + 1] - a;
+
+            delta -= Math.round(delta);
+
+            this.animation[i * ANIMATION_STRIDE] = latest.animation[i * ANIMATION_STRIDE];
+            this.animation[i * ANIMATION_STRIDE + 1] = a + delta * t - Math.floor(a + delta * t);
+        }
+
+        // Entities that only exist in the newest tick appear without blending
+        this.transforms.set(latest.transforms.subarray(shared * TRANSFORM_STRIDE, this.count * TRANSFORM_STRIDE), shared * TRANSFORM_STRIDE);
+        this.animation.set(latest.animation.subarray(shared * ANIMATION_STRIDE, this.count * ANIMATION_STRIDE), shared * ANIMATION_STRIDE);
+
+        for (let i = 0; i < EFFECT_COUNT; i++) {
+            this.effects[i] = previous.effects[i] + (latest.effects[i] - previous.effects[i]) * t;
+        }
+
+        return true;
+    }
+
+    public dispose(): void {
+        this.worker?.terminate();
+        this.worker = null;
+    }
+
+    private post(message: SimulationMessage, transfer: Transferable[] = []): void {
+        this.worker!.postMessage(message, transfer);
+    }
+
+    // Position and scale blend linearly, rotation is a normalised lerp along the shorter arc
+    private blendTransform(i: number, a: Float32Array, b: Float32Array, t: number): void {
+        const o = i * TRANSFORM_STRIDE;
+        const out = this.transforms;
+
+        for (let k = 0; k < 3; k++) {
+            out[o + k] = a[o + k] + (b[o + k] - a[o + k]) * t;
+            out[o + 7 + k] = a[o + 7 + k] + (b[o + 7 + k] - a[o + 7 + k]) * t;
+        }
+
+        const sign = a[o + 3] * b[o + 3] + a[o + 4] * b[o + 4] + a[o + 5] * b[o + 5] + a[o + 6] * b[o + 6] < 0 ? -1 : 1;
+        let length = 0;
+
+        for (let k = 3; k < 7; k++) {
+            out[o + k] = a[o + k] + (b[o + k] * sign - a[o + k]) * t;
+            length += out[o + k] * out[o + k];
+        }
+
+        length = Math.sqrt(length) || 1;
+
+        for (let k = 3; k < 7; k++) {
+            out[o + k] /= length;
+        }
+    }
+}
+
+export default Simulation;
@@ -0,0 +1,38 @@
+import Level from './Level';
+import SimulationState from './SimulationState';
+import SnapshotBuffer from './SnapshotBuffer';
+
+type SimulationMessage =
+    | { type: 'start'; buffer: SharedArrayBuffer; tickRate: number; seed: number }
+    | { type: 'level'; bytes: Uint8Array }
+    | { type: 'focus'; x: number; z: number };
+
+let state: SimulationState | null = null;
+let snapshots: SnapshotBuffer | null = null;
+
+// A timer per tick instead of an interval, so a slow tick delays the next one instead of queueing more
+const loop = (): void => {
+    if (state && snapshots) {
+        setTimeout(loop, Math.max(0, state.advance(snapshots)));
+    }
+};
+
+self.addEventListener('message', (event: MessageEvent<SimulationMessage>) => {
+    const message = event.data;
+
+    switch (message.type) {
+        case 'start':
+            state = new SimulationState(message.tickRate, message.seed);
+            snapshots = new SnapshotBuffer(message.buffer);
+            loop();
+            break;
+        case 'level':
+            state?.load(new Level(message.bytes));
+            break;
+        case 'focus':
+            state?.lod.focus(message.x, message.z);
+            break;
+    }
+});
+
+export type { SimulationMessage };
@@ -0,0 +1,315 @@
+import type Level from './Level';
+import { TRANSFORM_STRIDE } from './Level';
+import type SpatialHash from './SpatialHash';
+import { SpatialQuery } from './SpatialHash';
+
+// Ticks between updates for each tier, entities further down only get coarse catch up steps
+const Tiers = {
+    full: 0,
+    reduced: 1,
+    offscreen: 2
+} as const;
+
+const INTERVALS = [1, 4, 16];
+// Schedule wheel, one slot per tick, must be longer than the largest interval
+const WHEEL = 32;
+// Every entity is reclassified once per this many ticks, a slice at a time
+const SWEEP_TICKS = 8;
+const NO_ROOM = 0xffff;
+const EMPTY = -1;
+
+// Decides which entities are updated on a tick, and by how much time
+//
+// Entities sit in a wheel of per tick lists, so a tick only touches the entities due on it. An entity
+// that is skipped for a while gets the whole elapsed time on its next update, which keeps phases and
+// timers continuous when it is promoted back. Systems that work per entity walk active[0..activeCount)
+// and read their time step from elapsed[entity].
+class SimulationLod {
+    public enabled: boolean = true;
+    // Metres from the focus
+    public nearDistance: number = 16;
+    public farDistance: number = 48;
+    // Rooms more portals away than this from the focus room run the offscreen tier
+    public portalDepth: number = 2;
+
+    public readonly tiers: Uint8Array;
+    public readonly active: Uint32Array;
+    public activeCount: number = 0;
+    // Seconds since the entity's previous update, valid for the active entities
+    public readonly elapsed: Float32Array;
+    public readonly tierCounts: Uint32Array = new Uint32Array(INTERVALS.length);
+
+    private count: number = 0;
+    private lastTick: Int32Array;
+    private heads: Int32Array = new Int32Array(WHEEL).fill(EMPTY);
+    private next: Int32Array;
+    private previous: Int32Array;
+    private slot: Int32Array;
+    private cursor: number = 0;
+
+    private rooms: Uint16Array;
+    private roomStart: Uint32Array = new Uint32Array(1);
+    private roomNeighbours: Uint16Array = new Uint16Array(0);
+    private hops: Uint16Array = new Uint16Array(0);
+    private queue: Uint16Array = new Uint16Array(0);
+
+    private focusX: number = 0;
+    private focusZ: number = 0;
+    private focusRoom: number = NO_ROOM;
+    private nearby: SpatialQuery = new SpatialQuery();
+
+    constructor(capacity: number) {
+        this.tiers = new Uint8Array(capacity);
+        this.active = new Uint32Array(capacity);
+        this.elapsed = new Float32Array(capacity);
+        this.lastTick = new Int32Array(capacity);
+        this.next = new Int32Array(capacity);
+        this.previous = new Int32Array(capacity);
+        this.slot = new Int32Array(capacity);
+        this.rooms = new Uint16Array(capacity).fill(NO_ROOM);
+    }
+
+    // Everything starts at full rate and is due on the first tick, the first sweep spreads it out
+    public load(level: Level, count: number, tick: number): void {
+        this.count = count;
+        this.cursor = 0;
+        this.focusRoom = NO_ROOM;
+        this.heads.fill(EMPTY);
+        this.rooms.fill(NO_ROOM);
+        this.rooms.set(level.entityRoom.subarray(0, Math.min(count, level.entityRoom.length)));
+        this.buildRoomGraph(level);
+
+        for (let i = 0; i < count; i++) {
+            this.tiers[i] = Tiers.full;
+            this.lastTick[i] = tick - 1;
+            this.slot[i] = EMPTY;
+            this.schedule(i, tick);
+        }
+
+        this.countTiers();
+    }
+
+    // Where the player is, set from the render side
+    public focus(x: number, z: number): void {
+        this.focusX = x;
+        this.focusZ = z;
+    }
+
+    public begin(spatial: SpatialHash, transforms: Float32Array, tick: number, dt: number): void {
+        if (!this.enabled) {
+            this.activateAll(tick, dt);
+
+            return;
+        }
+
+        this.locateFocus(spatial);
+
+        // Whatever the player walks up to is promoted on this tick, not when the sweep comes round
+        for (const entity of spatial.query(this.focusX, this.focusZ, this.nearDistance, this.nearby)) {
+            this.reclassify(entity, transforms, tick);
+        }
+
+        const slice = Math.ceil(this.count / SWEEP_TICKS);
+
+        for (let i = 0; i < slice && this.count > 0; i++) {
+            this.reclassify(this.cursor, transforms, tick);
+            this.cursor = (this.cursor + 1) % this.count;
+        }
+
+        this.collect(tick, dt);
+    }
+
+    // Every entity every tick, each moves out of its old slot so the wheel resumes without repeats
+    private activateAll(tick: number, dt: number): void {
+        for (let i = 0; i < this.count; i++) {
+            this.active[i] = i;
+            this.elapsed[i] = dt;
+            this.lastTick[i] = tick;
+            this.unlink(i);
+            this.schedule(i, tick + INTERVALS[this.tiers[i]]);
+        }
+
+        this.activeCount = this.count;
+    }
+
+    // Unlinks the due slot and relinks every entity in it one interval further on
+    private collect(tick: number, dt: number): void {
+        const index = tick % WHEEL;
+        let entity = this.heads[index];
+
+        this.heads[index] = EMPTY;
+        this.activeCount = 0;
+
+        while (entity !== EMPTY) {
+            const following = this.next[entity];
+
+            this.active[this.activeCount++] = entity;
+            this.elapsed[entity] = (tick - this.lastTick[entity]) * dt;
+            this.lastTick[entity] = tick;
+            this.slot[entity] = EMPTY;
+            this.schedule(entity, tick + INTERVALS[this.tiers[entity]]);
+            entity = following;
+        }
+    }
+
+    private reclassify(entity: number, transforms: Float32Array, tick: number): void {
+        const dx = transforms[entity * TRANSFORM_STRIDE] - this.focusX;
+        const dz = transforms[entity * TRANSFORM_STRIDE + 2] - this.focusZ;
+        const distanceSquared = dx * dx + dz * dz;
+        let tier: number = distanceSquared <= this.nearDistance * this.nearDistance ? Tiers.full
+            : distanceSquared <= this.farDistance * this.farDistance ? Tiers.reduced : Tiers.offscreen;
+
+        const room = this.rooms[entity];
+
+        if (this.focusRoom !== NO_ROOM && room !== NO_ROOM && room < this.hops.length && this.hops[room] > this.portalDepth) {
+            tier = Tiers.offscreen;
+        }
+
+        const previous = this.tiers[entity];
+
+        if (tier === previous) {
+            return;
+        }
+
+        this.tierCounts[previous]--;
+        this.tierCounts[tier]++;
+        this.tiers[entity] = tier;
+
+        // A promoted entity catches up on the next tick, a demoted one keeps its slot and slows down after it
+        if (tier < previous) {
+            this.unlink(entity);
+            this.schedule(entity, tick);
+        }
+    }
+
+    // The focus room is the room of the nearest entity, kept as is when nothing is close
+    private locateFocus(spatial: SpatialHash): void {
+        let room = NO_ROOM;
+        let best = Infinity;
+
+        for (const entity of spatial.query(this.focusX, this.focusZ, spatial.cellSize * 2, this.nearby)) {
+            const distance = spatial.distanceSquared(entity, this.focusX, this.focusZ);
+
+            if (this.rooms[entity] !== NO_ROOM && distance < best) {
+                best = distance;
+                room = this.rooms[entity];
+            }
+        }
+
+        if (room !== NO_ROOM && room !== this.focusRoom) {
+            this.focusRoom = room;
+            this.walkPortals(room);
+        }
+    }
+
+    // Breadth first over the portal graph, hops[room] is the number of portals between it and the focus
+    private walkPortals(start: number): void {
+        const hops = this.hops;
+        const queue = this.queue;
+        let read = 0;
+        let write = 0;
+
+        if (start >= hops.length) {
+            return;
+        }
+
+        hops.fill(NO_ROOM);
+        hops[start] = 0;
+        queue[write++] = start;
+
+        while (read < write) {
+            const room = queue[read++];
+
+            for (let i = this.roomStart[room]; i < this.roomStart[room + 1]; i++) {
+                const neighbour = this.roomNeighbours[i];
+
+                if (hops[neighbour] === NO_ROOM) {
+                    hops[neighbour] = hops[room] + 1;
+                    queue[write++] = neighbour;
+                }
+            }
+        }
+    }
+
+    // Portals list room pairs, flattened here into per room neighbour ranges
+    private buildRoomGraph(level: Level): void {
+        const portals = level.portalRooms;
+        let rooms = level.roomCount;
+
+        for (let i = 0; i < portals.length; i++) {
+            rooms = Math.max(rooms, portals[i] + 1);
+        }
+
+        const start = new Uint32Array(rooms + 1);
+        const neighbours = new Uint16Array(portals.length);
+
+        for (let i = 0; i < portals.length; i++) {
+            start[portals[i] + 1]++;
+        }
+
+        for (let i = 0; i < rooms; i++) {
+            start[i + 1] += start[i];
+        }
+
+        const fill = start.slice(0, rooms);
+
+        for (let i = 0; i < portals.length; i += 2) {
+            neighbours[fill[portals[i]]++] = portals[i + 1];
+            neighbours[fill[portals[i + 1]]++] = portals[i];
+        }
+
+        this.roomStart = start;
+        this.roomNeighbours = neighbours;
+        this.hops = new Uint16Array(rooms).fill(NO_ROOM);
+        this.queue = new Uint16Array(rooms);
+    }
+
+    private countTiers(): void {
+        this.tierCounts.fill(0);
+
+        for (let i = 0; i < this.count; i++) {
+            this.tierCounts[this.tiers[i]]++;
+        }
+    }
+
+    private schedule(entity: number, tick: number): void {
+        const index = tick % WHEEL;
+        const head = this.heads[index];
+
+        this.slot[entity] = index;
+        this.previous[entity] = EMPTY;
+        this.next[entity] = head;
+
+        if (head !== EMPTY) {
+            this.previous[head] = entity;
+        }
+
+        this.heads[index] = entity;
+    }
+
+    private unlink(entity: number): void {
+        const index = this.slot[entity];
+
+        if (index === EMPTY) {
+            return;
+        }
+
+        const next = this.next[entity];
+        const previous = this.previous[entity];
+
+        if (previous === EMPTY) {
+            this.heads[index] = next;
+        } else {
+            this.next[previous] = next;
+        }
+
+        if (next !== EMPTY) {
+            this.previous[next] = previous;
+        }
+
+        this.slot[entity] = EMPTY;
+    }
+}
+
+export { Tiers as SimulationTiers };
+export default SimulationLod;
@@ -0,0 +1,168 @@
+import { AnimationColumns, TransformColumns } from './Components';
+import Level, { TRANSFORM_STRIDE } from './Level';
+import createRandom from './Random';
+import SimulationLod from './SimulationLod';
+import SpatialHash from './SpatialHash';
+import { ANIMATION_STRIDE, EFFECT_COUNT, Effects, MAX_ENTITIES } from './SnapshotBuffer';
+import type SnapshotBuffer from './SnapshotBuffer';
+
+// Entity flag bits, as authored in the level files
+const EntityFlags = {
+    animated: 1
+} as const;
+
+// One cycle per second at rate 1
+const ANIMATION_RATE = 1;
+// Ticks the simulation may run back to back after a stall before it drops time instead
+const MAX_CATCH_UP = 5;
+
+type System = (state: SimulationState, dt: number) => void;
+
+// Per entity systems only visit the entities the LOD made due, with their own time step
+const animate: System = (state) => {
+    const { active, activeCount, elapsed } = state.lod;
+    const animation = state.animationColumns;
+
+    for (let k = 0; k < activeCount; k++) {
+        const i = active[k];
+
+        if (state.flags[i] & EntityFlags.animated) {
+            const phase = animation.phase(i) + elapsed[i] * ANIMATION_RATE;
+
+            animation.setPhase(i, phase - Math.floor(phase));
+        }
+    }
+};
+
+// Static drifts towards a new random target every few seconds, flicker is fresh noise every tick
+const effects: System = (state, dt) => {
+    const intensity = state.effects[Effects.staticIntensity];
+
+    if (Math.abs(intensity - state.staticTarget) < 0.01) {
+        state.staticTarget = state.random() * 0.6;
+    }
+
+    state.effects[Effects.staticIntensity] = intensity + (state.staticTarget - intensity) * Math.min(1, dt * 0.5);
+    state.effects[Effects.flicker] = state.random();
+};
+
+// Game state owned by the simulation, stepped at a fixed rate and published as snapshots
+//
+// Runs inside the simulation worker, or on the main thread when shared memory is unavailable.
+class SimulationState {
+    public readonly tickMs: number;
+    public readonly systems: System[] = [animate, effects];
+
+    public count: number = 0;
+    public flags: Uint16Array = new Uint16Array(MAX_ENTITIES);
+    public readonly transforms: Float32Array = new Float32Array(MAX_ENTITIES * TRANSFORM_STRIDE);
+    public readonly animation: Float32Array = new Float32Array(MAX_ENTITIES * ANIMATION_STRIDE);
+    public effects: Float32Array = new Float32Array(EFFECT_COUNT);
+    // Generated from components/*.json, systems go through these so every access has one shape
+    public readonly transformColumns: TransformColumns = new TransformColumns(this.transforms);
+    public readonly animationColumns: AnimationColumns = new AnimationColumns(this.animation);
+    public staticTarget: number = 0;
+    public random: () => number;
+    // Floor plane index over entity positions, for triggers, hearing radii and other proximity checks
+    public readonly spatial: SpatialHash = new SpatialHash(MAX_ENTITIES);
+    // Update rates by distance and portal depth from the player
+    public readonly lod: SimulationLod = new SimulationLod(MAX_ENTITIES);
+    public ticks: number = 0;
+    public slowestTickMs: number = 0;
+
+    // Entities a system moved this tick, only these are reindexed
+    private moved: Uint32Array = new Uint32Array(MAX_ENTITIES);
+    private movedCount: number = 0;
+    private movedFlags: Uint8Array = new Uint8Array(MAX_ENTITIES);
+
+    // Clock shared with the render side, performance.now() has a different origin in every worker
+    private nextTick: number = -1;
+
+    constructor(tickRate: number, seed: number) {
+        this.tickMs = 1000 / tickRate;
+        this.random = createRandom(seed);
+    }
+
+    public static now(): number {
+        return performance.timeOrigin + performance.now();
+    }
+
+    public load(level: Level): void {
+        this.count = Math.min(level.entityCount, MAX_ENTITIES);
+        this.flags.set(level.entityFlags.subarray(0, this.count));
+        this.transforms.set(level.transforms.subarray(0, this.count * TRANSFORM_STRIDE));
+        this.animation.fill(0);
+        this.spatial.clear();
+
+        for (let i = 0; i < this.count; i++) {
+            this.spatial.insert(i, this.transformColumns.positionX(i), this.transformColumns.positionZ(i));
+        }
+
+        this.lod.load(level, this.count, this.ticks);
+    }
+
+    // Systems call this after writing an entity's position
+    public markMoved(entity: number): void {
+        if (this.movedFlags[entity] === 0) {
+            this.movedFlags[entity] = 1;
+            this.moved[this.movedCount++] = entity;
+        }
+    }
+
+    // Runs every tick that is due and publishes each one, returns the time until the next tick
+    public advance(snapshots: SnapshotBuffer): number {
+        const now = SimulationState.now();
+
+        if (this.nextTick < 0) {
+            this.nextTick = now;
+        }
+
+        if (now - this.nextTick > this.tickMs * MAX_CATCH_UP) {
+            this.nextTick = now - this.tickMs * MAX_CATCH_UP;
+        }
+
+        while (this.nextTick <= now) {
+            const start = performance.now();
+
+            this.lod.begin(this.spatial, this.transforms, this.ticks, this.tickMs / 1000);
+
+            for (const system of this.systems) {
+                system(this, this.tickMs / 1000);
+            }
+
+            this.reindex();
+
+            this.write(snapshots);
+            this.nextTick += this.tickMs;
+            this.ticks++;
+            this.slowestTickMs = Math.max(this.slowestTickMs, performance.now() - start);
+        }
+
+        return this.nextTick - SimulationState.now();
+    }
+
+    private reindex(): void {
+        for (let i = 0; i < this.movedCount; i++) {
+            const entity = this.moved[i];
+
+            this.spatial.update(entity, this.transformColumns.positionX(entity), this.transformColumns.positionZ(entity));
+            this.movedFlags[entity] = 0;
+        }
+
+        this.movedCount = 0;
+    }
+
+    private write(snapshots: SnapshotBuffer): void {
+        const slot = snapshots.acquire();
+
+        slot.transforms.set(this.transforms.subarray(0, this.count * TRANSFORM_STRIDE));
+        slot.animation.set(this.animation.subarray(0, this.count * ANIMATION_STRIDE));
+        slot.effects.set(this.effects);
+
+        snapshots.publish(this.nextTick, this.count);
+    }
+}
+
+export type { System };
+export { EntityFlags };
+export default SimulationState;
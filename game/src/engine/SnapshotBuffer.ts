@@ -0,0 +1,162 @@
+import { AnimationLayout } from './Components';
+import { TRANSFORM_STRIDE } from './Level';
+
+// Snapshot slots shared between the simulation worker and the renderer
+//
+// header  i32 published snapshot count, then one i32 stamp per slot (snapshot number it holds, -1 while written)
+// slot    f64 time, f64 entity count, then f32 transforms, animation and effect parameters
+//
+// Snapshot n lives in slot n % SLOTS. With three slots the writer fills the slot after the newest one,
+// while the reader copies the newest two, so they only collide when the reader falls two ticks behind,
+// which the stamps detect.
+const SLOTS = 3;
+const MAX_ENTITIES = 4096;
+// Clip index and phase in [0, 1)
+const ANIMATION_STRIDE = AnimationLayout.stride;
+const EFFECT_COUNT = 8;
+
+const Effects = {
+    staticIntensity: 0,
+    flicker: 1
+} as const;
+
+const HEADER_BYTES = 16;
+const META_BYTES = 16;
+const SLOT_BYTES = META_BYTES + (MAX_ENTITIES * (TRANSFORM_STRIDE + ANIMATION_STRIDE) + EFFECT_COUNT) * 4;
+
+class Snapshot {
+    public readonly meta: Float64Array;
+    public readonly transforms: Float32Array;
+    public readonly animation: Float32Array;
+    public readonly effects: Float32Array;
+    // Number of the snapshot last copied in, only meaningful for reader side copies
+    public sequence: number = -1;
+
+    constructor(buffer: ArrayBufferLike, offset: number) {
+        this.meta = new Float64Array(buffer, offset, 2);
+        this.transforms = new Float32Array(buffer, offset + META_BYTES, MAX_ENTITIES * TRANSFORM_STRIDE);
+        this.animation = new Float32Array(buffer, this.transforms.byteOffset + this.transforms.byteLength, MAX_ENTITIES * ANIMATION_STRIDE);
+        this.effects = new Float32Array(buffer, this.animation.byteOffset + this.animation.byteLength, EFFECT_COUNT);
+    }
+
+    public get time(): number {
+        return this.meta[0];
+    }
+
+    public get count(): number {
+        return this.meta[1];
+    }
+
+    // Copies only the entities in use
+    public copyFrom(source: Snapshot): void {
+        const count = source.count;
+
+        this.meta.set(source.meta);
+        this.transforms.set(source.transforms.subarray(0, count * TRANSFORM_STRIDE));
+        this.animation.set(source.animation.subarray(0, count * ANIMATION_STRIDE));
+        this.effects.set(source.effects);
+    }
+}
+
+class SnapshotBuffer {
+    public readonly buffer: SharedArrayBuffer | ArrayBuffer;
+    // Reader side copies of the two newest snapshots, previous is older
+    public previous: Snapshot;
+    public latest: Snapshot;
+    public tornReads: number = 0;
+
+    private header: Int32Array;
+    private slots: Snapshot[] = [];
+
+    // Without cross origin isolation there is no SharedArrayBuffer, the simulation then runs on this thread
+    public static create(shared: boolean): SnapshotBuffer {
+        const bytes = HEADER_BYTES + SLOT_BYTES * SLOTS;
+        const buffer = shared ? new SharedArrayBuffer(bytes) : new ArrayBuffer(bytes);
+
+        new Int32Array(buffer, 0, 1 + SLOTS).fill(-1, 1);
+
+        return new SnapshotBuffer(buffer);
+    }
+
+    constructor(buffer: SharedArrayBuffer | ArrayBuffer) {
+        this.buffer = buffer;
+        this.header = new Int32Array(buffer, 0, 1 + SLOTS);
+
+        for (let i = 0; i < SLOTS; i++) {
+            this.slots.push(new Snapshot(buffer, HEADER_BYTES + SLOT_BYTES * i));
+        }
+
+        this.previous = new Snapshot(new ArrayBuffer(SLOT_BYTES), 0);
+        this.latest = new Snapshot(new ArrayBuffer(SLOT_BYTES), 0);
+    }
+
+    // Writer side, the returned slot may be filled until publish()
+    public acquire(): Snapshot {
+        const sequence = Atomics.load(this.header, 0);
+
+        Atomics.store(this.header, 1 + sequence % SLOTS, -1);
+
+        return this.slots[sequence % SLOTS];
+    }
+
+    public publish(time: number, count: number): void {
+        const sequence = Atomics.load(this.header, 0);
+        const slot = this.slots[sequence % SLOTS];
+
+        slot.meta[0] = time;
+        slot.meta[1] = count;
+
+        // The stamp store orders every slot write before it, the count store makes the slot visible
+        Atomics.store(this.header, 1 + sequence % SLOTS, sequence);
+        Atomics.store(this.header, 0, sequence + 1);
+    }
+
+    // Reader side, brings previous and latest up to the two newest snapshots, false until two exist
+    public update(): boolean {
+        for (let attempt = 0; attempt < 4; attempt++) {
+            const published = Atomics.load(this.header, 0);
+
+            if (published < 2) {
+                return false;
+            }
+
+            if (this.latest.sequence === published - 1) {
+                return true;
+            }
+
+            // One tick ahead is the common case, the old latest becomes previous without a copy
+            if (this.latest.sequence === published - 2) {
+                [this.previous, this.latest] = [this.latest, this.previous];
+            } else if (this.previous.sequence !== published - 2 && !this.copy(published - 2, this.previous)) {
+                this.tornReads++;
+                continue;
+            }
+
+            if (this.copy(published - 1, this.latest)) {
+                return true;
+            }
+
+            this.tornReads++;
+        }
+
+        return false;
+    }
+
+    private copy(sequence: number, into: Snapshot): boolean {
+        const stamp = 1 + sequence % SLOTS;
+
+        if (Atomics.load(this.header, stamp) !== sequence) {
+            return false;
+        }
+
+        into.copyFrom(this.slots[sequence % SLOTS]);
+
+        // The writer restamps before touching the slot, an unchanged stamp means the copy is whole
+        into.sequence = Atomics.load(this.header, stamp) === sequence ? sequence : -1;
+
+        return into.sequence === sequence;
+    }
+}
+
+export { Snapshot, Effects, MAX_ENTITIES, ANIMATION_STRIDE, EFFECT_COUNT };
+export default SnapshotBuffer;
@@ -0,0 +1,113 @@
+// Sound bank layout, written by scripts/pack-sounds.mjs (keep both in sync)
+//
+// header  16 bytes  u32 magic 'SBNK', u16 version, u16 sound count, u32 sample rate, u32 audio byte offset
+// table   per sound u32 first sample, u32 sample count, u8 name length, ascii name
+// audio   MP3 frames of every sound back to back
+//
+// Regions are in samples of the decoded bank, already past the decoder delay and each sound's
+// encoder delay and padding, so a region plays and loops exactly the sound that was encoded.
+const MAGIC = 0x4b4e4253;
+const VERSION = 1;
+const HEADER_BYTES = 16;
+
+interface SoundRegion {
+    // Seconds into the bank's buffer
+    offset: number;
+    duration: number;
+}
+
+interface PlayOptions {
+    destination?: AudioNode;
+    when?: number;
+    loop?: boolean;
+    playbackRate?: number;
+}
+
+// Related sounds decoded once into a single AudioBuffer and played by region
+class SoundBank {
+    public readonly buffer: AudioBuffer;
+    public readonly regions: Map<string, SoundRegion>;
+
+    private context: BaseAudioContext;
+
+    constructor(context: BaseAudioContext, buffer: AudioBuffer, regions: Map<string, SoundRegion>) {
+        this.context = context;
+        this.buffer = buffer;
+        this.regions = regions;
+    }
+
+    // One request and one decode for the whole bank
+    public static async load(context: BaseAudioContext, url: string): Promise<SoundBank> {
+        const response = await fetch(url);
+
+        if (!response.ok) {
+            throw new Error(`Could not Load Sound Bank ${url}, the Server Responded with ${response.status}.`);
+        }
+
+        const data = await response.arrayBuffer();
+        const header = new DataView(data);
+
+        if (data.byteLength < HEADER_BYTES || header.getUint32(0, true) !== MAGIC) {
+            throw new Error(`${url} is Not a Sound Bank.`);
+        }
+
+        if (header.getUint16(4, true) !== VERSION) {
+            throw new Error(`Sound Bank Version ${header.getUint16(4, true)} is not Supported, Expected ${VERSION}.`);
+        }
+
+        const sampleRate = header.getUint32(8, true);
+        const audioOffset = header.getUint32(12, true);
+        const regions = new Map<string, SoundRegion>();
+        let at = HEADER_BYTES;
+
+        // Offsets are in samples of the source rate, decodeAudioData resamples to the context rate so keep seconds
+        for (let i = header.getUint16(6, true); i > 0; i--) {
+            const length = header.getUint8(at + 8);
+            const name = String.fromCharCode(...new Uint8Array(data, at + 9, length));
+
+            regions.set(name, {
+                offset: header.getUint32(at, true) / sampleRate,
+                duration: header.getUint32(at + 4, true) / sampleRate
+            });
+            at += 9 + length;
+        }
+
+        // decodeAudioData detaches what it is given, the table was read above
+        const buffer = await context.decodeAudioData(data.slice(audioOffset));
+
+        return new SoundBank(context, buffer, regions);
+    }
+
+    public has(name: string): boolean {
+        return this.regions.has(name);
+    }
+
+    public play(name: string, options: PlayOptions = {}): AudioBufferSourceNode {
+        const region = this.regions.get(name);
+
+        if (!region) {
+            throw new Error(`Sound ${name} is not in this Bank, Expected one of ${[...this.regions.keys()].join(', ')}.`);
+        }
+
+        const source = this.context.createBufferSource();
+
+        source.buffer = this.buffer;
+        source.playbackRate.value = options.playbackRate ?? 1;
+        source.connect(options.destination ?? this.context.destination);
+
+        // A looping region wraps inside itself, the duration argument would stop it after one pass
+        if (options.loop) {
+            source.loop = true;
+            source.loopStart = region.offset;
+            source.loopEnd = region.offset + region.duration;
+            source.start(options.when ?? 0, region.offset);
+        } else {
+            source.start(options.when ?? 0, region.offset, region.duration);
+        }
+
+        return source;
+    }
+}
+
+export type { SoundRegion, PlayOptions };
+export default SoundBank;
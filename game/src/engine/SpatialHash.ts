@@ -0,0 +1,217 @@
+// Uniform grid over the floor plane (x, z), hashed into a fixed bucket table
+//
+// Every entity sits in one intrusive doubly linked list per bucket, so inserting, moving and removing
+// are O(1) and nothing is allocated after construction. Distinct cells can share a bucket, entries
+// remember their cell so a query never reports an entity from a colliding cell.
+const EMPTY = -1;
+
+class SpatialHash {
+    public readonly cellSize: number;
+
+    private mask: number;
+    private heads: Int32Array;
+    private next: Int32Array;
+    private previous: Int32Array;
+    private cellX: Int32Array;
+    private cellZ: Int32Array;
+    private bucket: Int32Array;
+    private positions: Float32Array;
+    private defaultQuery: SpatialQuery = new SpatialQuery();
+
+    // buckets is rounded up to a power of two
+    constructor(capacity: number, cellSize: number = 4, buckets: number = 4096) {
+        const size = 1 << Math.ceil(Math.log2(buckets));
+
+        this.cellSize = cellSize;
+        this.mask = size - 1;
+        this.heads = new Int32Array(size).fill(EMPTY);
+        this.next = new Int32Array(capacity).fill(EMPTY);
+        this.previous = new Int32Array(capacity).fill(EMPTY);
+        this.cellX = new Int32Array(capacity);
+        this.cellZ = new Int32Array(capacity);
+        this.bucket = new Int32Array(capacity).fill(EMPTY);
+        this.positions = new Float32Array(capacity * 2);
+    }
+
+    public contains(entity: number): boolean {
+        return this.bucket[entity] !== EMPTY;
+    }
+
+    public insert(entity: number, x: number, z: number): void {
+        const cx = Math.floor(x / this.cellSize);
+        const cz = Math.floor(z / this.cellSize);
+
+        this.positions[entity * 2] = x;
+        this.positions[entity * 2 + 1] = z;
+        this.link(entity, cx, cz);
+    }
+
+    // Only relinks when the entity crossed into another cell
+    public update(entity: number, x: number, z: number): void {
+        const cx = Math.floor(x / this.cellSize);
+        const cz = Math.floor(z / this.cellSize);
+
+        this.positions[entity * 2] = x;
+        this.positions[entity * 2 + 1] = z;
+
+        if (this.bucket[entity] !== EMPTY && cx === this.cellX[entity] && cz === this.cellZ[entity]) {
+            return;
+        }
+
+        this.remove(entity);
+        this.link(entity, cx, cz);
+    }
+
+    public remove(entity: number): void {
+        const bucket = this.bucket[entity];
+
+        if (bucket === EMPTY) {
+            return;
+        }
+
+        const next = this.next[entity];
+        const previous = this.previous[entity];
+
+        if (previous === EMPTY) {
+            this.heads[bucket] = next;
+        } else {
+            this.next[previous] = next;
+        }
+
+        if (next !== EMPTY) {
+            this.previous[next] = previous;
+        }
+
+        this.bucket[entity] = EMPTY;
+        this.next[entity] = EMPTY;
+        this.previous[entity] = EMPTY;
+    }
+
+    public clear(): void {
+        this.heads.fill(EMPTY);
+        this.next.fill(EMPTY);
+        this.previous.fill(EMPTY);
+        this.bucket.fill(EMPTY);
+    }
+
+    // Entities within radius of (x, z), the iterator is reused so pass your own when queries nest
+    public query(x: number, z: number, radius: number, into: SpatialQuery = this.defaultQuery): SpatialQuery {
+        into.start(this, x, z, radius);
+
+        return into;
+    }
+
+    public bucketOf(cx: number, cz: number): number {
+        return (Math.imul(cx, 73856093) ^ Math.imul(cz, 19349663)) & this.mask;
+    }
+
+    // Accessors for SpatialQuery, kept as plain reads so the iteration stays monomorphic
+    public head(bucket: number): number {
+        return this.heads[bucket];
+    }
+
+    public following(entity: number): number {
+        return this.next[entity];
+    }
+
+    public inCell(entity: number, cx: number, cz: number): boolean {
+        return this.cellX[entity] === cx && this.cellZ[entity] === cz;
+    }
+
+    public distanceSquared(entity: number, x: number, z: number): number {
+        const dx = this.positions[entity * 2] - x;
+        const dz = this.positions[entity * 2 + 1] - z;
+
+        return dx * dx + dz * dz;
+    }
+
+    private link(entity: number, cx: number, cz: number): void {
+        const bucket = this.bucketOf(cx, cz);
+        const head = this.heads[bucket];
+
+        this.cellX[entity] = cx;
+        this.cellZ[entity] = cz;
+        this.bucket[entity] = bucket;
+        this.previous[entity] = EMPTY;
+        this.next[entity] = head;
+
+        if (head !== EMPTY) {
+            this.previous[head] = entity;
+        }
+
+        this.heads[bucket] = entity;
+    }
+}
+
+// Walks the cells overlapping a circle, works with for...of without allocating per step
+class SpatialQuery implements IterableIterator<number> {
+    private hash: SpatialHash | null = null;
+    // Handed out on every step, IteratorResult itself is a union that cannot be written to in place
+    private result: { value: number | undefined; done: boolean } = { value: 0, done: false };
+    private x: number = 0;
+    private z: number = 0;
+    private radiusSquared: number = 0;
+    private minX: number = 0;
+    private maxX: number = 0;
+    private minZ: number = 0;
+    private maxZ: number = 0;
+    private cx: number = 0;
+    private cz: number = 0;
+    private entity: number = EMPTY;
+
+    public start(hash: SpatialHash, x: number, z: number, radius: number): void {
+        const size = hash.cellSize;
+
+        this.hash = hash;
+        this.x = x;
+        this.z = z;
+        this.radiusSquared = radius * radius;
+        this.minX = Math.floor((x - radius) / size);
+        this.maxX = Math.floor((x + radius) / size);
+        this.minZ = Math.floor((z - radius) / size);
+        this.maxZ = Math.floor((z + radius) / size);
+        this.cx = this.minX;
+        this.cz = this.minZ;
+        this.entity = hash.head(hash.bucketOf(this.cx, this.cz));
+    }
+
+    public next(): IteratorResult<number> {
+        const hash = this.hash!;
+        const result = this.result;
+
+        while (true) {
+            while (this.entity !== EMPTY) {
+                const entity = this.entity;
+
+                this.entity = hash.following(entity);
+
+                if (hash.inCell(entity, this.cx, this.cz) && hash.distanceSquared(entity, this.x, this.z) <= this.radiusSquared) {
+                    result.done = false;
+                    result.value = entity;
+
+                    return result as IteratorResult<number>;
+                }
+            }
+
+            if (++this.cx > this.maxX) {
+                this.cx = this.minX;
+
+                if (++this.cz > this.maxZ) {
+                    result.done = true;
+                    result.value = undefined;
+
+                    return result as IteratorResult<number>;
+                }
+            }
+
+            this.entity = hash.head(hash.bucketOf(this.cx, this.cz));
+        }
+    }
+
+    public [Symbol.iterator](): SpatialQuery {
+        return this;
+    }
+}
+
+export { SpatialQuery };
+export default SpatialHash;
@@ -0,0 +1,75 @@
+import workletUrl from './StaticNoise.worklet.ts?worker&url';
+import { Effects } from './SnapshotBuffer';
+
+// Shared by the composite shader and the audio worklet, so picture and sound break up together
+interface StaticSettings {
+    // 0 to 1, how far the signal has broken up
+    intensity: number;
+    // Fresh random value every simulation tick
+    flicker: number;
+    // 1 while the signal is lost, the picture turns to snow and the hiss to full level
+    dropout: number;
+    seed: number;
+}
+
+// A tick drops out when its flicker roll lands under this share of the intensity
+const DROPOUT_CHANCE = 0.12;
+// Seconds, intensity follows the simulation smoothly instead of stepping every frame
+const SMOOTHING = 0.05;
+
+// Both sides read the settings this writes, from the simulation's seeded effects
+const updateStatic = (settings: StaticSettings, effects: Float32Array, seed: number): void => {
+    settings.intensity = effects[Effects.staticIntensity];
+    settings.flicker = effects[Effects.flicker];
+    settings.dropout = settings.flicker < settings.intensity * DROPOUT_CHANCE ? 1 : 0;
+    settings.seed = seed;
+};
+
+// Procedural radio static, synthesized on the audio thread instead of looping a decoded recording
+class StaticNoise {
+    public readonly node: AudioWorkletNode;
+
+    private context: AudioContext;
+    private intensity: AudioParam;
+    private flicker: AudioParam;
+    private dropout: AudioParam;
+
+    constructor(context: AudioContext, node: AudioWorkletNode) {
+        this.context = context;
+        this.node = node;
+        this.intensity = node.parameters.get('intensity')!;
+        this.flicker = node.parameters.get('flicker')!;
+        this.dropout = node.parameters.get('dropout')!;
+    }
+
+    public static async create(context: AudioContext, seed: number, destination: AudioNode = context.destination): Promise<StaticNoise> {
+        await context.audioWorklet.addModule(workletUrl);
+
+        const node = new AudioWorkletNode(context, 'static-noise', {
+            numberOfInputs: 0,
+            outputChannelCount: [2],
+            processorOptions: { seed }
+        });
+
+        node.connect(destination);
+
+        return new StaticNoise(context, node);
+    }
+
+    // Once a frame, with the settings the frame was composited with
+    public update(settings: StaticSettings): void {
+        const time = this.context.currentTime;
+
+        this.intensity.setTargetAtTime(settings.intensity, time, SMOOTHING);
+        this.flicker.setValueAtTime(settings.flicker, time);
+        this.dropout.setValueAtTime(settings.dropout, time);
+    }
+
+    public dispose(): void {
+        this.node.disconnect();
+    }
+}
+
+export type { StaticSettings };
+export { updateStatic };
+export default StaticNoise;
@@ -0,0 +1,104 @@
+// AudioWorkletGlobalScope, not part of the DOM typings
+declare const sampleRate: number;
+declare class AudioWorkletProcessor {
+    constructor(options?: AudioWorkletNodeOptions);
+}
+declare function registerProcessor(name: string, processor: new (options: AudioWorkletNodeOptions) => AudioWorkletProcessor): void;
+
+// Mains hum, the third harmonic gives it the buzz
+const HUM_HZ = 50;
+// Crackles per second at full intensity
+const CRACKLE_RATE = 40;
+const CRACKLE_DECAY = 0.9;
+// Seconds for the level to follow a dropout starting or ending
+const GATE_TIME = 0.005;
+const OUTPUT_GAIN = 0.25;
+
+// White, pink and brown noise mixed by flicker, band limited by intensity, with crackle and hum on top
+//
+// Every value comes from a xorshift generator seeded like the simulation, nothing is decoded or looped.
+class StaticNoiseProcessor extends AudioWorkletProcessor {
+    public static get parameterDescriptors(): AudioParamDescriptor[] {
+        return [
+            { name: 'intensity', defaultValue: 0, minValue: 0, maxValue: 1, automationRate: 'k-rate' },
+            { name: 'flicker', defaultValue: 0, minValue: 0, maxValue: 1, automationRate: 'k-rate' },
+            { name: 'dropout', defaultValue: 0, minValue: 0, maxValue: 1, automationRate: 'k-rate' }
+        ];
+    }
+
+    private state: number;
+    // Paul Kellet's economy pink filter
+    private pink0: number = 0;
+    private pink1: number = 0;
+    private pink2: number = 0;
+    private brown: number = 0;
+    private lowpass: number = 0;
+    private crackle: number = 0;
+    private humPhase: number = 0;
+    private level: number = 0;
+
+    constructor(options: AudioWorkletNodeOptions) {
+        super(options);
+
+        this.state = (Math.imul((options.processorOptions?.seed ?? 1) | 0, 2654435761) | 1) >>> 0;
+    }
+
+    public process(_inputs: Float32Array[][], outputs: Float32Array[][], parameters: Record<string, Float32Array>): boolean {
+        const output = outputs[0];
+        const left = output[0];
+        const intensity = parameters.intensity[0];
+        const flicker = parameters.flicker[0];
+        const dropout = parameters.dropout[0];
+        // A lost signal is nothing but hiss
+        const target = Math.max(intensity, dropout);
+        const whiteWeight = 0.2 + 0.3 * flicker;
+        const cutoff = 1 - Math.exp(-2 * Math.PI * (2000 + 10000 * target) / sampleRate);
+        const crackleChance = intensity * intensity * CRACKLE_RATE / sampleRate;
+        const gate = 1 - Math.exp(-1 / (GATE_TIME * sampleRate));
+        const humStep = 2 * Math.PI * HUM_HZ / sampleRate;
+        const humLevel = 0.04 + 0.06 * intensity;
+
+        for (let i = 0; i < left.length; i++) {
+            const white = this.random() * 2 - 1;
+
+            this.pink0 = 0.99765 * this.pink0 + white * 0.0990460;
+            this.pink1 = 0.96300 * this.pink1 + white * 0.2965164;
+            this.pink2 = 0.57000 * this.pink2 + white * 1.0526913;
+            this.brown = (this.brown + 0.02 * white) / 1.02;
+
+            const pink = (this.pink0 + this.pink1 + this.pink2 + white * 0.1848) * 0.25;
+            const noise = white * whiteWeight + pink * 0.45 + this.brown * 3.5 * (0.55 - whiteWeight);
+
+            this.lowpass += (noise - this.lowpass) * cutoff;
+
+            if (this.random() < crackleChance) {
+                this.crackle = (this.random() < 0.5 ? -1 : 1) * (0.5 + 0.5 * this.random());
+            }
+
+            this.crackle *= CRACKLE_DECAY;
+            this.humPhase = (this.humPhase + humStep) % (2 * Math.PI);
+            this.level += (target - this.level) * gate;
+
+            left[i] = OUTPUT_GAIN * (this.level * (this.lowpass + this.crackle) + humLevel * this.level * (Math.sin(this.humPhase) * 0.6 + Math.sin(3 * this.humPhase) * 0.25));
+        }
+
+        for (let channel = 1; channel < output.length; channel++) {
+            output[channel].set(left);
+        }
+
+        return true;
+    }
+
+    private random(): number {
+        let x = this.state;
+
+        x ^= x << 13;
+        x ^= x >>> 17;
+        x ^= x << 5;
+        this.state = x >>> 0;
+
+        return this.state / 4294967296;
+    }
+}
+
+registerProcessor('static-noise', StaticNoiseProcessor);
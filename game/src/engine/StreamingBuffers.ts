@@ -0,0 +1,189 @@
+// Buffers rewritten by the CPU every frame, e.g. particles, sprite batches, debug lines and UI
+//
+// Each buffer is split into one segment per frame in flight and a frame only writes into its own
+// segment. A fence per frame tells when the GPU is done with a segment. When the ring comes round
+// to a segment the GPU still reads, the storage is orphaned (respecified with bufferData) instead of
+// waiting, so an upload never blocks on the GPU.
+const FRAMES_IN_FLIGHT = 3;
+
+interface StreamingStats {
+    // Frames whose segment was still in use and would have stalled a bufferSubData
+    avoidedStalls: number;
+    orphans: number;
+    grows: number;
+    bytesThisFrame: number;
+}
+
+class StreamingBuffer {
+    public buffer: WebGLBuffer;
+    public segmentBytes: number;
+
+    private gl: WebGL2RenderingContext;
+    private target: number;
+    private stats: StreamingStats;
+    private segment: number = 0;
+    private cursor: number = 0;
+    private retired: WebGLBuffer[] = [];
+
+    constructor(gl: WebGL2RenderingContext, target: number, segmentBytes: number, stats: StreamingStats) {
+        this.gl = gl;
+        this.target = target;
+        this.segmentBytes = segmentBytes;
+        this.stats = stats;
+        this.buffer = this.allocate();
+    }
+
+    // Uploads data into this frame's segment and returns its byte offset in buffer
+    //
+    // Growing replaces buffer, so bind it after writing. Data written earlier in the frame stays valid
+    // in the previous buffer until the frame ends.
+    public write(data: ArrayBufferView): number {
+        const gl = this.gl;
+        const bytes = data.byteLength;
+        const end = (this.segment + 1) * this.segmentBytes;
+
+        if (this.cursor + bytes > end) {
+            this.grow(bytes);
+        }
+
+        const offset = this.cursor;
+
+        gl.bindBuffer(this.target, this.buffer);
+        gl.bufferSubData(this.target, offset, data);
+        gl.bindBuffer(this.target, null);
+
+        // Offsets stay 16 byte aligned for any vertex attribute or uniform block layout
+        this.cursor = offset + Math.ceil(bytes / 16) * 16;
+        this.stats.bytesThisFrame += bytes;
+
+        return offset;
+    }
+
+    public beginFrame(segment: number, orphan: boolean): void {
+        const gl = this.gl;
+
+        for (const buffer of this.retired) {
+            // Deletion is deferred by GL until the GPU no longer reads it
+            gl.deleteBuffer(buffer);
+        }
+
+        this.retired = [];
+        this.segment = segment;
+        this.cursor = segment * this.segmentBytes;
+
+        if (orphan) {
+            gl.bindBuffer(this.target, this.buffer);
+            gl.bufferData(this.target, this.segmentBytes * FRAMES_IN_FLIGHT, gl.STREAM_DRAW);
+            gl.bindBuffer(this.target, null);
+            this.stats.orphans++;
+        }
+    }
+
+    public dispose(): void {
+        for (const buffer of [...this.retired, this.buffer]) {
+            this.gl.deleteBuffer(buffer);
+        }
+
+        this.retired = [];
+    }
+
+    private grow(bytes: number): void {
+        while (this.segmentBytes < (this.cursor - this.segment * this.segmentBytes) + bytes) {
+            this.segmentBytes *= 2;
+        }
+
+        this.retired.push(this.buffer);
+        this.buffer = this.allocate();
+        this.cursor = this.segment * this.segmentBytes;
+        this.stats.grows++;
+    }
+
+    private allocate(): WebGLBuffer {
+        const gl = this.gl;
+        const buffer = gl.createBuffer();
+
+        gl.bindBuffer(this.target, buffer);
+        gl.bufferData(this.target, this.segmentBytes * FRAMES_IN_FLIGHT, gl.STREAM_DRAW);
+        gl.bindBuffer(this.target, null);
+
+        return buffer;
+    }
+}
+
+// Owns the frame fences shared by every streaming buffer
+class StreamingBuffers {
+    public readonly stats: StreamingStats = { avoidedStalls: 0, orphans: 0, grows: 0, bytesThisFrame: 0 };
+
+    private gl: WebGL2RenderingContext;
+    private buffers: StreamingBuffer[] = [];
+    private fences: (WebGLSync | null)[] = new Array(FRAMES_IN_FLIGHT).fill(null);
+    private segment: number = 0;
+
+    constructor(gl: WebGL2RenderingContext) {
+        this.gl = gl;
+    }
+
+    public create(target: number, segmentBytes: number): StreamingBuffer {
+        const buffer = new StreamingBuffer(this.gl, target, segmentBytes, this.stats);
+
+        buffer.beginFrame(this.segment, false);
+        this.buffers.push(buffer);
+
+        return buffer;
+    }
+
+    public release(buffer: StreamingBuffer): void {
+        this.buffers.splice(this.buffers.indexOf(buffer), 1);
+        buffer.dispose();
+    }
+
+    // Moves every buffer to the next segment, orphaning if the GPU has not finished the frame that used it
+    public beginFrame(): void {
+        const gl = this.gl;
+
+        this.segment = (this.segment + 1) % FRAMES_IN_FLIGHT;
+        this.stats.bytesThisFrame = 0;
+
+        const fence = this.fences[this.segment];
+        let busy = false;
+
+        if (fence) {
+            const status = gl.clientWaitSync(fence, 0, 0);
+
+            busy = status === gl.TIMEOUT_EXPIRED;
+            gl.deleteSync(fence);
+            this.fences[this.segment] = null;
+        }
+
+        if (busy && this.buffers.length > 0) {
+            this.stats.avoidedStalls++;
+        }
+
+        for (const buffer of this.buffers) {
+            buffer.beginFrame(this.segment, busy);
+        }
+    }
+
+    public endFrame(): void {
+        this.fences[this.segment] = this.gl.fenceSync(this.gl.SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    public dispose(): void {
+        for (const fence of this.fences) {
+            if (fence) {
+                this.gl.deleteSync(fence);
+            }
+        }
+
+        for (const buffer of this.buffers) {
+            buffer.dispose();
+        }
+
+        this.buffers = [];
+        this.fences.fill(null);
+    }
+}
+
+export type { StreamingStats };
+export { StreamingBuffer };
+export default StreamingBuffers;
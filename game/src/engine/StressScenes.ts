@@ -0,0 +1,26 @@
+import AudioVoiceFloodScene from './scenes/AudioVoiceFloodScene';
+import ComponentAccessScene from './scenes/ComponentAccessScene';
+import DrawCallScene from './scenes/DrawCallScene';
+import HeavyPostScene from './scenes/HeavyPostScene';
+import ManyLightsScene from './scenes/ManyLightsScene';
+import ParticleStormScene from './scenes/ParticleStormScene';
+import SkinnedCrowdScene from './scenes/SkinnedCrowdScene';
+import StreamingWalkScene from './scenes/StreamingWalkScene';
+import SwarmScene from './scenes/SwarmScene';
+import type { StressScene } from './scenes/StressScene';
+
+// Every scene the benchmark harness can run, by the name passed to --stress
+const StressScenes: Record<string, () => StressScene> = {
+    'draw-calls': () => new DrawCallScene(),
+    'many-lights': () => new ManyLightsScene(),
+    'particle-storm': () => new ParticleStormScene(),
+    'swarm': () => new SwarmScene(),
+    'heavy-post': () => new HeavyPostScene(),
+    'streaming-walk': () => new StreamingWalkScene(),
+    'audio-flood': () => new AudioVoiceFloodScene(),
+    'component-access': () => new ComponentAccessScene(),
+    'skinned-crowd': () => new SkinnedCrowdScene()
+};
+
+export type { StressScene, Subsystem } from './scenes/StressScene';
+export default StressScenes;
@@ -0,0 +1,527 @@
+import type Engine from './Engine';
+import type { RenderPass } from './Engine';
+import RenderTarget from './RenderTarget';
+import Shader from './Shader';
+
+type Vector3 = [number, number, number];
+
+interface SwarmSettings {
+    count: number;
+    boundsMin: Vector3;
+    boundsMax: Vector3;
+    separation: number;
+    alignment: number;
+    cohesion: number;
+    wander: number;
+    // Negative flees the light
+    light: number;
+    minSpeed: number;
+    maxSpeed: number;
+    // Agents per flocking cell where separation takes over from cohesion
+    crowding: number;
+    // Ground swarms stay on boundsMin.y and lie flat, the rest fly and face the camera
+    ground: boolean;
+    // Wing beats per second at cruising speed
+    flapRate: number;
+    size: number;
+    color: Vector3;
+}
+
+const SwarmPresets: Record<'moths' | 'rats' | 'insects', Omit<SwarmSettings, 'count' | 'boundsMin' | 'boundsMax'>> = {
+    moths: {
+        separation: 2, alignment: 0.6, cohesion: 0.4, wander: 3, light: 6,
+        minSpeed: 0.8, maxSpeed: 3, crowding: 12, ground: false, flapRate: 14, size: 0.06, color: [0.55, 0.5, 0.42]
+    },
+    rats: {
+        separation: 4, alignment: 1.2, cohesion: 0.8, wander: 2, light: -8,
+        minSpeed: 0.3, maxSpeed: 4, crowding: 6, ground: true, flapRate: 3, size: 0.22, color: [0.12, 0.1, 0.09]
+    },
+    insects: {
+        separation: 1.5, alignment: 0.2, cohesion: 1.2, wander: 6, light: 1.5,
+        minSpeed: 0.5, maxSpeed: 2, crowding: 24, ground: false, flapRate: 40, size: 0.02, color: [0.08, 0.08, 0.07]
+    }
+};
+
+// Flocking cells, x by y by z, laid out as y slices side by side in one texture
+const GRID: Vector3 = [64, 8, 64];
+// position xyz and wing phase, velocity xyz and a per agent random seed
+const AGENT_BYTES = 32;
+
+const FLOCK_GLSL = `
+uniform sampler2D flock;
+uniform vec3 boundsMin;
+uniform vec3 boundsMax;
+uniform vec3 grid;
+
+vec3 cellOf(vec3 p) {
+    return floor((p - boundsMin) / (boundsMax - boundsMin) * grid);
+}
+
+// Summed velocity and agent count of the cell around p, nothing outside the bounds
+vec4 field(vec3 p) {
+    vec3 cell = cellOf(p);
+
+    if (any(lessThan(cell, vec3(0.0))) || any(greaterThanEqual(cell, grid))) {
+        return vec4(0.0);
+    }
+
+    return texelFetch(flock, ivec2(int(cell.x + cell.y * grid.x), int(cell.z)), 0);
+}`;
+
+const SPLAT_VERTEX = `#version 300 es
+layout(location = 0) in vec4 agent;
+layout(location = 1) in vec4 motion;
+
+uniform vec3 boundsMin;
+uniform vec3 boundsMax;
+uniform vec3 grid;
+
+out vec4 velocityCount;
+
+void main() {
+    vec3 cell = clamp(floor((agent.xyz - boundsMin) / (boundsMax - boundsMin) * grid), vec3(0.0), grid - 1.0);
+    vec2 atlas = vec2(grid.x * grid.y, grid.z);
+
+    velocityCount = vec4(motion.xyz, 1.0);
+    gl_Position = vec4((vec2(cell.x + cell.y * grid.x, cell.z) + 0.5) / atlas * 2.0 - 1.0, 0.0, 1.0);
+    gl_PointSize = 1.0;
+}`;
+
+const SPLAT_FRAGMENT = `#version 300 es
+precision highp float;
+
+in vec4 velocityCount;
+out vec4 outColor;
+
+void main() {
+    outColor = velocityCount;
+}`;
+
+const UPDATE_VERTEX = `#version 300 es
+precision highp float;
+precision highp sampler2D;
+
+layout(location = 0) in vec4 agent;
+layout(location = 1) in vec4 motion;
+
+${FLOCK_GLSL}
+
+uniform bool useField;
+uniform float dt;
+uniform float time;
+// separation, alignment, cohesion, wander
+uniform vec4 weights;
+uniform float lightWeight;
+uniform vec3 lightPosition;
+uniform vec3 lightDirection;
+uniform float lightCone;
+uniform float lightRange;
+// min, max
+uniform vec2 speed;
+uniform float crowding;
+uniform bool ground;
+uniform float flapRate;
+
+out vec4 nextAgent;
+out vec4 nextMotion;
+
+vec3 hash3(float n) {
+    return fract(sin(vec3(n, n + 1.7, n + 3.1)) * 43758.5453);
+}
+
+void main() {
+    vec3 p = agent.xyz;
+    vec3 v = motion.xyz;
+    float seed = motion.w;
+    vec3 steer = vec3(0.0);
+
+    if (useField) {
+        vec3 cellSize = (boundsMax - boundsMin) / grid;
+        vec4 here = field(p);
+
+        // Mean velocity of the others in the cell
+        if (here.a > 1.0) {
+            steer += weights.y * ((here.rgb - v) / (here.a - 1.0) - v);
+        }
+
+        // Cohesion climbs the density gradient, separation descends it once the cell gets crowded
+        vec3 gradient = vec3(
+            field(p + vec3(cellSize.x, 0.0, 0.0)).a - field(p - vec3(cellSize.x, 0.0, 0.0)).a,
+            field(p + vec3(0.0, cellSize.y, 0.0)).a - field(p - vec3(0.0, cellSize.y, 0.0)).a,
+            field(p + vec3(0.0, 0.0, cellSize.z)).a - field(p - vec3(0.0, 0.0, cellSize.z)).a
+        ) / (2.0 * cellSize);
+
+        steer += gradient * (weights.z - weights.x * smoothstep(1.0, crowding, here.a));
+    }
+
+    // Inside the beam agents head for the light and spiral around it instead of hitting it
+    vec3 toLight = lightPosition - p;
+    float lightDistance = max(length(toLight), 1e-3);
+    float beam = smoothstep(lightCone, mix(lightCone, 1.0, 0.3), dot(-toLight / lightDistance, lightDirection));
+    float lit = beam * (1.0 - smoothstep(lightRange * 0.5, lightRange, lightDistance));
+
+    steer += lit * (lightWeight * toLight / lightDistance + abs(lightWeight) * 0.5 * cross(toLight / lightDistance, lightDirection));
+    steer += weights.w * (hash3(seed * 17.0 + floor(time * 2.0 + seed)) * 2.0 - 1.0);
+
+    // The bounds are a box SDF seen from inside, agents are pushed off within a metre of a face
+    steer += (1.0 - smoothstep(0.0, 1.0, p - boundsMin)) * 8.0;
+    steer -= (1.0 - smoothstep(0.0, 1.0, boundsMax - p)) * 8.0;
+
+    if (ground) {
+        steer.y = 0.0;
+        v.y = 0.0;
+    }
+
+    v += steer * dt;
+
+    float s = length(v);
+
+    v = s > 0.0 ? v * clamp(s, speed.x, speed.y) / s : vec3(speed.x, 0.0, 0.0);
+    p = clamp(p + v * dt, boundsMin, boundsMax);
+
+    if (ground) {
+        p.y = boundsMin.y;
+    }
+
+    float phase = agent.w + dt * flapRate * (0.75 + 0.5 * fract(seed * 7.13)) * (0.5 + length(v) / speed.y);
+
+    nextAgent = vec4(p, fract(phase));
+    nextMotion = vec4(v, seed);
+}`;
+
+const UPDATE_FRAGMENT = `#version 300 es
+precision lowp float;
+
+out vec4 outColor;
+
+void main() {
+    outColor = vec4(0.0);
+}`;
+
+const RENDER_VERTEX = `#version 300 es
+layout(location = 0) in vec4 agent;
+layout(location = 1) in vec4 motion;
+
+uniform mat4 viewProjection;
+uniform vec3 eye;
+uniform float size;
+uniform bool ground;
+uniform vec3 lightPosition;
+uniform vec3 lightDirection;
+uniform float lightCone;
+uniform float lightRange;
+
+out vec2 local;
+out float lit;
+
+void main() {
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    vec3 forward = normalize(motion.xyz + vec3(1e-4, 0.0, 0.0));
+    vec3 side;
+    float width;
+
+    // Ground agents lie flat along their heading, flyers face the camera with beating wings
+    if (ground) {
+        side = normalize(cross(vec3(0.0, 1.0, 0.0), forward) + vec3(0.0, 0.0, 1e-4));
+        width = 0.35;
+    } else {
+        side = normalize(cross(forward, eye - agent.xyz) + vec3(0.0, 1e-4, 0.0));
+        width = 0.3 + 0.7 * abs(sin(agent.w * 6.2831853));
+    }
+
+    vec3 world = agent.xyz + side * corner.x * width * size + forward * corner.y * size * 0.5;
+
+    vec3 toLight = lightPosition - agent.xyz;
+    float lightDistance = max(length(toLight), 1e-3);
+
+    lit = smoothstep(lightCone, mix(lightCone, 1.0, 0.3), dot(-toLight / lightDistance, lightDirection)) * (1.0 - smoothstep(lightRange * 0.5, lightRange, lightDistance));
+    local = corner;
+    gl_Position = viewProjection * vec4(world + (ground ? vec3(0.0, 0.02, 0.0) : vec3(0.0)), 1.0);
+}`;
+
+const RENDER_FRAGMENT = `#version 300 es
+precision mediump float;
+
+in vec2 local;
+in float lit;
+
+uniform vec3 color;
+uniform bool ground;
+
+out vec4 outColor;
+
+void main() {
+    // A body along the heading, with a pair of wings across it for flyers
+    float body = length(local * (ground ? vec2(1.0) : vec2(3.0, 1.0)));
+    float wings = ground ? 2.0 : length((abs(local) - vec2(0.5, 0.1)) * vec2(1.8, 1.4));
+
+    if (min(body, wings) > 1.0) {
+        discard;
+    }
+
+    outColor = vec4(color * (0.15 + lit * 1.5), 1.0);
+}`;
+
+// Flocking swarm simulated entirely on the GPU, per frame CPU cost does not depend on the agent count
+//
+// Agents live in two buffers that transform feedback ping-pongs between. Neighbours are found through
+// a coarse grid: every agent is splatted as a point into its cell with additive blending, summing
+// velocity and count, and the update reads alignment, cohesion and separation from the cells around
+// it. Drawn as instanced quads straight from the agent buffer.
+class Swarm implements RenderPass {
+    public readonly settings: SwarmSettings;
+    // Flashlight, follows the camera unless followCamera is cleared
+    public followCamera: boolean = true;
+    public readonly lightPosition: Float32Array = new Float32Array(3);
+    public readonly lightDirection: Float32Array = new Float32Array([0, 0, -1]);
+    public lightCone: number = Math.cos(0.4);
+    public lightRange: number = 15;
+    // False without float render targets, agents then only wander, follow the light and avoid walls
+    public readonly flocking: boolean;
+
+    private gl: WebGL2RenderingContext;
+    private splatShader: Shader;
+    private updateShader: Shader;
+    private drawShader: Shader;
+    private field: RenderTarget | null = null;
+    private buffers: WebGLBuffer[] = [];
+    private updateVaos: WebGLVertexArrayObject[] = [];
+    private renderVaos: WebGLVertexArrayObject[] = [];
+    private feedbacks: WebGLTransformFeedback[] = [];
+    private current: number = 0;
+    private lastTime: number = -1;
+
+    constructor(gl: WebGL2RenderingContext, settings: SwarmSettings, random: () => number = Math.random) {
+        this.gl = gl;
+        this.settings = settings;
+        this.flocking = gl.getExtension('EXT_color_buffer_float') !== null;
+        this.splatShader = new Shader(gl, SPLAT_VERTEX, SPLAT_FRAGMENT);
+        this.updateShader = new Shader(gl, UPDATE_VERTEX, UPDATE_FRAGMENT, ['nextAgent', 'nextMotion']);
+        this.drawShader = new Shader(gl, RENDER_VERTEX, RENDER_FRAGMENT);
+
+        if (this.flocking) {
+            this.field = new RenderTarget(gl, [gl.RGBA16F], false, gl.NEAREST);
+            this.field.resize(GRID[0] * GRID[1], GRID[2]);
+        }
+
+        const initial = this.spawn(random);
+
+        for (let i = 0; i < 2; i++) {
+            const buffer = gl.createBuffer();
+
+            gl.bindBuffer(gl.ARRAY_BUFFER, buffer);
+            gl.bufferData(gl.ARRAY_BUFFER, initial, gl.DYNAMIC_COPY);
+
+            this.buffers.push(buffer);
+            this.updateVaos.push(this.createVao(buffer, 0));
+            this.renderVaos.push(this.createVao(buffer, 1));
+
+            const feedback = gl.createTransformFeedback();
+
+            gl.bindTransformFeedback(gl.TRANSFORM_FEEDBACK, feedback);
+            gl.bindBufferBase(gl.TRANSFORM_FEEDBACK_BUFFER, 0, buffer);
+            this.feedbacks.push(feedback);
+        }
+
+        // A buffer bound anywhere else while it is captured into is an error
+        gl.bindTransformFeedback(gl.TRANSFORM_FEEDBACK, null);
+        gl.bindBuffer(gl.TRANSFORM_FEEDBACK_BUFFER, null);
+        gl.bindBuffer(gl.ARRAY_BUFFER, null);
+    }
+
+    public get count(): number {
+        return this.settings.count;
+    }
+
+    // Steps the swarm and draws it into the scene target
+    public render(engine: Engine, time: number): void {
+        const dt = this.lastTime < 0 ? 0 : Math.min(0.05, (time - this.lastTime) / 1000);
+
+        this.lastTime = time;
+
+        if (this.followCamera) {
+            this.aimLight(engine);
+        }
+
+        if (this.field) {
+            this.splatField();
+        }
+
+        engine.post.scene.bind();
+        this.step(dt, time / 1000);
+        this.draw(engine);
+        engine.drawCalls += this.field ? 3 : 2;
+    }
+
+    public dispose(): void {
+        const gl = this.gl;
+
+        this.splatShader.dispose();
+        this.updateShader.dispose();
+        this.drawShader.dispose();
+        this.field?.dispose();
+
+        for (let i = 0; i < this.buffers.length; i++) {
+            gl.deleteBuffer(this.buffers[i]);
+            gl.deleteVertexArray(this.updateVaos[i]);
+            gl.deleteVertexArray(this.renderVaos[i]);
+            gl.deleteTransformFeedback(this.feedbacks[i]);
+        }
+
+        this.buffers = [];
+    }
+
+    private spawn(random: () => number): Float32Array {
+        const { count, boundsMin, boundsMax, minSpeed, ground } = this.settings;
+        const data = new Float32Array(count * AGENT_BYTES / 4);
+
+        for (let i = 0; i < count; i++) {
+            const o = i * AGENT_BYTES / 4;
+            const angle = random() * Math.PI * 2;
+
+            for (let k = 0; k < 3; k++) {
+                data[o + k] = boundsMin[k] + random() * (boundsMax[k] - boundsMin[k]);
+            }
+
+            if (ground) {
+                data[o + 1] = boundsMin[1];
+            }
+
+            data[o + 3] = random();
+            data[o + 4] = Math.cos(angle) * minSpeed;
+            data[o + 5] = ground ? 0 : (random() - 0.5) * minSpeed;
+            data[o + 6] = Math.sin(angle) * minSpeed;
+            data[o + 7] = random() * 1000;
+        }
+
+        return data;
+    }
+
+    private createVao(buffer: WebGLBuffer, divisor: number): WebGLVertexArrayObject {
+        const gl = this.gl;
+        const vao = gl.createVertexArray();
+
+        gl.bindVertexArray(vao);
+        gl.bindBuffer(gl.ARRAY_BUFFER, buffer);
+
+        for (let location = 0; location < 2; location++) {
+            gl.enableVertexAttribArray(location);
+            gl.vertexAttribPointer(location, 4, gl.FLOAT, false, AGENT_BYTES, location * 16);
+            gl.vertexAttribDivisor(location, divisor);
+        }
+
+        gl.bindVertexArray(null);
+
+        return vao;
+    }
+
+    // Camera view rows are its right, up and backward axes
+    private aimLight(engine: Engine): void {
+        const camera = engine.camera;
+        const view = camera.view;
+
+        this.lightPosition.set(camera.position);
+        this.lightDirection[0] = -view[2];
+        this.lightDirection[1] = -view[6];
+        this.lightDirection[2] = -view[10];
+    }
+
+    private splatField(): void {
+        const gl = this.gl;
+        const shader = this.splatShader;
+
+        this.field!.bind();
+        gl.clearColor(0, 0, 0, 0);
+        gl.clear(gl.COLOR_BUFFER_BIT);
+        gl.disable(gl.DEPTH_TEST);
+        gl.enable(gl.BLEND);
+        gl.blendFunc(gl.ONE, gl.ONE);
+
+        shader.use();
+        this.setBounds(shader);
+        gl.bindVertexArray(this.updateVaos[this.current]);
+        gl.drawArrays(gl.POINTS, 0, this.settings.count);
+        gl.bindVertexArray(null);
+
+        gl.disable(gl.BLEND);
+        gl.enable(gl.DEPTH_TEST);
+    }
+
+    // Expects a framebuffer other than the field bound, sampling an attached texture is a feedback loop
+    private step(dt: number, time: number): void {
+        const gl = this.gl;
+        const shader = this.updateShader;
+        const settings = this.settings;
+        const next = 1 - this.current;
+
+        shader.use();
+        this.setBounds(shader);
+        this.setLight(shader);
+        gl.activeTexture(gl.TEXTURE0);
+        gl.bindTexture(gl.TEXTURE_2D, this.field ? this.field.texture : null);
+        gl.uniform1i(shader.uniform('flock'), 0);
+        gl.uniform1i(shader.uniform('useField'), this.field ? 1 : 0);
+        gl.uniform1f(shader.uniform('dt'), dt);
+        gl.uniform1f(shader.uniform('time'), time);
+        gl.uniform4f(shader.uniform('weights'), settings.separation, settings.alignment, settings.cohesion, settings.wander);
+        gl.uniform1f(shader.uniform('lightWeight'), settings.light);
+        gl.uniform2f(shader.uniform('speed'), settings.minSpeed, settings.maxSpeed);
+        gl.uniform1f(shader.uniform('crowding'), settings.crowding);
+        gl.uniform1i(shader.uniform('ground'), settings.ground ? 1 : 0);
+        gl.uniform1f(shader.uniform('flapRate'), settings.flapRate);
+
+        gl.enable(gl.RASTERIZER_DISCARD);
+        gl.bindVertexArray(this.updateVaos[this.current]);
+        gl.bindTransformFeedback(gl.TRANSFORM_FEEDBACK, this.feedbacks[next]);
+        gl.beginTransformFeedback(gl.POINTS);
+        gl.drawArrays(gl.POINTS, 0, settings.count);
+        gl.endTransformFeedback();
+        gl.bindTransformFeedback(gl.TRANSFORM_FEEDBACK, null);
+        gl.bindVertexArray(null);
+        gl.disable(gl.RASTERIZER_DISCARD);
+        gl.bindTexture(gl.TEXTURE_2D, null);
+
+        this.current = next;
+    }
+
+    private draw(engine: Engine): void {
+        const gl = this.gl;
+        const shader = this.drawShader;
+        const settings = this.settings;
+        const [r, g, b] = settings.color;
+
+        shader.use();
+        this.setLight(shader);
+        gl.uniformMatrix4fv(shader.uniform('viewProjection'), false, engine.camera.viewProjection);
+        gl.uniform3fv(shader.uniform('eye'), engine.camera.position);
+        gl.uniform1f(shader.uniform('size'), settings.size);
+        gl.uniform1i(shader.uniform('ground'), settings.ground ? 1 : 0);
+        gl.uniform3f(shader.uniform('color'), r, g, b);
+
+        gl.bindVertexArray(this.renderVaos[this.current]);
+        gl.drawArraysInstanced(gl.TRIANGLE_STRIP, 0, 4, settings.count);
+        gl.bindVertexArray(null);
+    }
+
+    private setBounds(shader: Shader): void {
+        const gl = this.gl;
+        const { boundsMin, boundsMax } = this.settings;
+
+        gl.uniform3fv(shader.uniform('boundsMin'), boundsMin);
+        gl.uniform3fv(shader.uniform('boundsMax'), boundsMax);
+        gl.uniform3fv(shader.uniform('grid'), GRID);
+    }
+
+    private setLight(shader: Shader): void {
+        const gl = this.gl;
+
+        gl.uniform3fv(shader.uniform('lightPosition'), this.lightPosition);
+        gl.uniform3fv(shader.uniform('lightDirection'), this.lightDirection);
+        gl.uniform1f(shader.uniform('lightCone'), this.lightCone);
+        gl.uniform1f(shader.uniform('lightRange'), this.lightRange);
+    }
+}
+
+export type { SwarmSettings };
+export { SwarmPresets };
+export default Swarm;
@@ -0,0 +1,78 @@
+import type Engine from '../Engine';
+import type { StressScene } from './StressScene';
+
+// Keeps a few hundred filtered, spatialised voices playing at once
+class AudioVoiceFloodScene implements StressScene {
+    public readonly subsystem = 'audio';
+
+    private static readonly VOICES = 256;
+
+    private context: AudioContext | null = null;
+    private buffer: AudioBuffer | null = null;
+    private active: number = 0;
+    private started: number = 0;
+    private random: () => number = Math.random;
+
+    public setup(_engine: Engine, random: () => number): void {
+        const context = new AudioContext();
+        const buffer = context.createBuffer(1, context.sampleRate, context.sampleRate);
+        const samples = buffer.getChannelData(0);
+
+        for (let i = 0; i < samples.length; i++) {
+            samples[i] = random() * 2 - 1;
+        }
+
+        this.context = context;
+        this.buffer = buffer;
+        this.random = random;
+    }
+
+    public update(): void {
+        while (this.active < AudioVoiceFloodScene.VOICES) {
+            this.startVoice();
+        }
+    }
+
+    public counters(): Record<string, number> {
+        // playoutStats is Chromium only, it counts frames the audio thread failed to deliver in time
+        const stats = (this.context as unknown as { playoutStats?: { fallbackFramesEvents: number } } | null)?.playoutStats;
+
+        return { voices: this.active, started: this.started, glitches: stats?.fallbackFramesEvents ?? -1 };
+    }
+
+    public dispose(): void {
+        this.context?.close();
+        this.context = null;
+    }
+
+    private startVoice(): void {
+        const context = this.context!;
+        const source = context.createBufferSource();
+        const filter = context.createBiquadFilter();
+        const panner = context.createPanner();
+        const gain = context.createGain();
+
+        source.buffer = this.buffer;
+        source.loop = true;
+        source.playbackRate.value = 0.5 + this.random();
+        filter.type = 'bandpass';
+        filter.frequency.value = 200 + this.random() * 4000;
+        panner.panningModel = 'HRTF';
+        panner.positionX.value = (this.random() - 0.5) * 20;
+        panner.positionZ.value = (this.random() - 0.5) * 20;
+        gain.gain.value = 0.5 / AudioVoiceFloodScene.VOICES;
+
+        source.connect(filter).connect(panner).connect(gain).connect(context.destination);
+        source.onended = () => {
+            source.disconnect();
+            this.active--;
+        };
+        source.start();
+        source.stop(context.currentTime + 0.5 + this.random() * 2);
+
+        this.active++;
+        this.started++;
+    }
+}
+
+export default AudioVoiceFloodScene;
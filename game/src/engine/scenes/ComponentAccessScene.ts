@@ -0,0 +1,134 @@
+import { AnimationLayout, AnimationQuery, TransformColumns, TransformLayout, writeTransform } from '../Components';
+import type Engine from '../Engine';
+import type { StressScene } from './StressScene';
+
+// Bookkeeping fields that spawn code for one entity kind or another adds to its components
+const KIND_FIELDS = ['dirty', 'parent', 'layer', 'owner', 'version', 'flags'];
+
+// What the generated accessors replace, components looked up by name and fields by string key
+//
+// Each entity kind builds its components in its own field order, some with extra fields, the way
+// separate spawn paths do. Every field access site then sees one object shape per kind.
+class GenericWorld {
+    private components: Map<string, Record<string, number>[]> = new Map();
+
+    // kinds[entity] picks the shape, kinds up to KIND_FIELDS.length give distinct ones
+    public add(name: string, fields: string[], kinds: Uint8Array): void {
+        this.components.set(name, Array.from(kinds, (kind) => {
+            const component: Record<string, number> = {};
+
+            for (let i = 0; i < fields.length; i++) {
+                component[fields[(i + kind) % fields.length]] = 0;
+            }
+
+            for (const field of KIND_FIELDS.slice(0, kind)) {
+                component[field] = 0;
+            }
+
+            return component;
+        }));
+    }
+
+    public get(entity: number, name: string): Record<string, number> {
+        return this.components.get(name)![entity];
+    }
+}
+
+// Runs the same movement, animation and serialization work through the generated component code
+// and through generic lookups, counters report both per frame
+class ComponentAccessScene implements StressScene {
+    public readonly subsystem = 'simulation';
+
+    private static readonly COUNT = 20000;
+
+    private transforms: Float32Array = new Float32Array(ComponentAccessScene.COUNT * TransformLayout.stride);
+    private animation: Float32Array = new Float32Array(ComponentAccessScene.COUNT * AnimationLayout.stride);
+    private transformColumns: TransformColumns = new TransformColumns(this.transforms);
+    private animationQuery: AnimationQuery = new AnimationQuery(this.animation);
+    private world: GenericWorld = new GenericWorld();
+    private transformFields: string[] = [];
+    private view: DataView = new DataView(new ArrayBuffer(ComponentAccessScene.COUNT * TransformLayout.stride * 4));
+    private generatedMs: number = 0;
+    private genericMs: number = 0;
+    private frames: number = 0;
+
+    public setup(_engine: Engine, random: () => number): void {
+        const count = ComponentAccessScene.COUNT;
+        const fields = (layout: Record<string, number>) => Object.keys(layout).filter((key) => key !== 'stride');
+
+        const kinds = Uint8Array.from({ length: count }, () => Math.floor(random() * KIND_FIELDS.length));
+
+        this.transformFields = fields(TransformLayout);
+        this.world.add('Transform', this.transformFields, kinds);
+        this.world.add('Animation', fields(AnimationLayout), kinds);
+
+        for (let i = 0; i < count; i++) {
+            const transform = this.world.get(i, 'Transform');
+
+            transform.positionX = (random() - 0.5) * 100;
+            transform.positionZ = (random() - 0.5) * 100;
+            this.transformColumns.setPositionX(i, transform.positionX);
+            this.transformColumns.setPositionZ(i, transform.positionZ);
+        }
+    }
+
+    public update(_engine: Engine, time: number): void {
+        const dt = 1 / 60;
+        const drift = Math.sin(time / 1000) * dt;
+        let start = performance.now();
+        const transform = this.transformColumns;
+        const animation = this.animationQuery.reset(null, ComponentAccessScene.COUNT);
+
+        // Columns for the two fields that move, the query for a component that is read and written whole
+        for (let i = 0; i < ComponentAccessScene.COUNT; i++) {
+            transform.setPositionX(i, transform.positionX(i) + drift);
+            transform.setPositionZ(i, transform.positionZ(i) - drift);
+        }
+
+        while (animation.next()) {
+            animation.phase = (animation.phase + dt) % 1;
+            animation.store();
+        }
+
+        writeTransform(this.view, 0, this.transforms, ComponentAccessScene.COUNT);
+        this.generatedMs += performance.now() - start;
+
+        start = performance.now();
+
+        for (let i = 0; i < ComponentAccessScene.COUNT; i++) {
+            const transform = this.world.get(i, 'Transform');
+            const animation = this.world.get(i, 'Animation');
+
+            transform.positionX += drift;
+            transform.positionZ -= drift;
+            animation.phase = (animation.phase + dt) % 1;
+        }
+
+        let offset = 0;
+
+        for (let i = 0; i < ComponentAccessScene.COUNT; i++) {
+            const transform = this.world.get(i, 'Transform');
+
+            // Schema order, the same bytes writeTransform produces whatever the object's own key order
+            for (const field of this.transformFields) {
+                this.view.setFloat32(offset, transform[field], true);
+                offset += 4;
+            }
+        }
+
+        this.genericMs += performance.now() - start;
+        this.frames++;
+    }
+
+    public counters(): Record<string, number> {
+        const frames = Math.max(1, this.frames);
+
+        return { entities: ComponentAccessScene.COUNT, generatedMs: this.generatedMs / frames, genericMs: this.genericMs / frames };
+    }
+
+    public dispose(): void {
+        this.world = new GenericWorld();
+    }
+}
+
+export default ComponentAccessScene;
@@ -0,0 +1,68 @@
+import type Engine from '../Engine';
+import type { ArenaMesh } from '../GeometryArena';
+import Primitives from '../Primitives';
+import Shader from '../Shader';
+import { FLAT_FRAGMENT, orbit, STATIC_VERTEX } from './StressScene';
+import type { StressScene } from './StressScene';
+
+// Thousands of small meshes spread over hundreds of materials
+class DrawCallScene implements StressScene {
+    public readonly subsystem = 'draw';
+
+    private shader: Shader | null = null;
+    private meshes: ArenaMesh[] = [];
+    private materialOf: number[] = [];
+    private materials: number = 0;
+
+    public setup(engine: Engine, random: () => number): void {
+        const gl = engine.gl;
+        const shader = new Shader(gl, STATIC_VERTEX, FLAT_FRAGMENT);
+        const ids: number[] = [];
+
+        for (let i = 0; i < 512; i++) {
+            const r = random();
+            const g = random();
+            const b = random();
+
+            ids.push(engine.registerMaterial(() => {
+                shader.use();
+                gl.uniformMatrix4fv(shader.uniform('viewProjection'), false, engine.camera.viewProjection);
+                gl.uniform3f(shader.uniform('color'), r, g, b);
+            }));
+        }
+
+        for (let i = 0; i < 8000; i++) {
+            const size = 0.2 + random() * 0.8;
+            const { vertices, indices } = Primitives.box((random() - 0.5) * 80, size / 2, (random() - 0.5) * 80, size, size * (1 + random() * 3), size);
+
+            this.meshes.push(engine.arena.allocate(Primitives.PositionNormal, vertices, indices));
+            this.materialOf.push(ids[Math.floor(random() * ids.length)]);
+        }
+
+        this.shader = shader;
+        this.materials = ids.length;
+    }
+
+    public update(engine: Engine, time: number): void {
+        orbit(engine, time, 45, 18);
+
+        for (let i = 0; i < this.meshes.length; i++) {
+            engine.arena.draw(this.meshes[i], this.materialOf[i]);
+        }
+    }
+
+    public counters(): Record<string, number> {
+        return { meshes: this.meshes.length, materials: this.materials };
+    }
+
+    public dispose(engine: Engine): void {
+        for (const mesh of this.meshes) {
+            engine.arena.release(mesh);
+        }
+
+        this.shader?.dispose();
+        this.meshes = [];
+    }
+}
+
+export default DrawCallScene;
@@ -0,0 +1,172 @@
+import type Engine from '../Engine';
+import type { RenderPass } from '../Engine';
+import Shader from '../Shader';
+import type { StressScene } from './StressScene';
+
+const NOISE_FRAGMENT = `#version 300 es
+precision highp float;
+
+in vec2 uv;
+uniform float time;
+out vec4 outColor;
+
+void main() {
+    float n = fract(sin(dot(uv * 1000.0 + time, vec2(12.9898, 78.233))) * 43758.5453);
+    outColor = vec4(vec3(n) * (0.5 + 0.5 * sin(uv.y * 300.0 + time * 10.0)), 1.0);
+}`;
+
+const BLUR_FRAGMENT = `#version 300 es
+precision mediump float;
+
+in vec2 uv;
+uniform sampler2D source;
+uniform vec2 direction;
+out vec4 outColor;
+
+void main() {
+    vec4 sum = texture(source, uv) * 0.1964825501511404;
+
+    for (int i = 1; i <= 6; i++) {
+        float weight = 0.2969069646728344 * exp(-float(i * i) / 18.0);
+        vec2 offset = direction * float(i) * 1.5;
+
+        sum += (texture(source, uv + offset) + texture(source, uv - offset)) * weight;
+    }
+
+    outColor = sum;
+}`;
+
+const COMPOSITE_FRAGMENT = `#version 300 es
+precision mediump float;
+
+in vec2 uv;
+uniform sampler2D source;
+uniform float time;
+out vec4 outColor;
+
+void main() {
+    vec2 offset = (uv - 0.5) * 0.006;
+    vec3 color = vec3(texture(source, uv + offset).r, texture(source, uv).g, texture(source, uv - offset).b);
+    float vignette = smoothstep(0.9, 0.3, length(uv - 0.5));
+    float grain = fract(sin(dot(uv * 800.0 + time, vec2(12.9898, 78.233))) * 43758.5453) * 0.1;
+
+    outColor = vec4(color * vignette + grain, 1.0);
+}`;
+// Full resolution blur chain with a composite on top, no scene geometry at all
+class HeavyPostScene implements StressScene, RenderPass {
+    public readonly subsystem = 'post';
+
+    private static readonly BLUR_PASSES = 8;
+
+    private noise: Shader | null = null;
+    private blur: Shader | null = null;
+    private composite: Shader | null = null;
+    private targets: { framebuffer: WebGLFramebuffer; texture: WebGLTexture }[] = [];
+    private width: number = 0;
+    private height: number = 0;
+
+    public setup(engine: Engine): void {
+        const gl = engine.gl;
+
+        this.noise = new Shader(gl, Shader.FULLSCREEN_VERTEX, NOISE_FRAGMENT);
+        this.blur = new Shader(gl, Shader.FULLSCREEN_VERTEX, BLUR_FRAGMENT);
+        this.composite = new Shader(gl, Shader.FULLSCREEN_VERTEX, COMPOSITE_FRAGMENT);
+
+        engine.passes.push(this);
+    }
+
+    public update(): void {}
+
+    public render(engine: Engine, time: number): void {
+        const gl = engine.gl;
+        const width = gl.drawingBufferWidth;
+        const height = gl.drawingBufferHeight;
+
+        if (!this.noise || !this.blur || !this.composite) {
+            return;
+        }
+
+        if (width !== this.width || height !== this.height) {
+            this.resize(gl, width, height);
+        }
+
+        gl.disable(gl.DEPTH_TEST);
+        gl.bindFramebuffer(gl.FRAMEBUFFER, this.targets[0].framebuffer);
+        this.noise.use();
+        gl.uniform1f(this.noise.uniform('time'), time * 0.001);
+        gl.drawArrays(gl.TRIANGLES, 0, 3);
+
+        this.blur.use();
+        gl.uniform1i(this.blur.uniform('source'), 0);
+        gl.activeTexture(gl.TEXTURE0);
+
+        for (let i = 0; i < HeavyPostScene.BLUR_PASSES * 2; i++) {
+            const source = this.targets[i % 2];
+            const target = this.targets[(i + 1) % 2];
+
+            gl.bindFramebuffer(gl.FRAMEBUFFER, target.framebuffer);
+            gl.bindTexture(gl.TEXTURE_2D, source.texture);
+            gl.uniform2f(this.blur.uniform('direction'), i % 2 === 0 ? 1 / width : 0, i % 2 === 0 ? 0 : 1 / height);
+            gl.drawArrays(gl.TRIANGLES, 0, 3);
+        }
+
+        engine.post.scene.bind();
+        gl.bindTexture(gl.TEXTURE_2D, this.targets[0].texture);
+        this.composite.use();
+        gl.uniform1i(this.composite.uniform('source'), 0);
+        gl.uniform1f(this.composite.uniform('time'), time * 0.001);
+        gl.drawArrays(gl.TRIANGLES, 0, 3);
+        gl.bindTexture(gl.TEXTURE_2D, null);
+        gl.enable(gl.DEPTH_TEST);
+
+        engine.drawCalls += HeavyPostScene.BLUR_PASSES * 2 + 2;
+    }
+
+    public counters(): Record<string, number> {
+        return { passes: HeavyPostScene.BLUR_PASSES * 2 + 2, pixels: this.width * this.height };
+    }
+
+    public dispose(engine: Engine): void {
+        engine.passes.splice(engine.passes.indexOf(this), 1);
+        this.noise?.dispose();
+        this.blur?.dispose();
+        this.composite?.dispose();
+        this.release(engine.gl);
+    }
+
+    private resize(gl: WebGL2RenderingContext, width: number, height: number): void {
+        this.release(gl);
+
+        for (let i = 0; i < 2; i++) {
+            const texture = gl.createTexture();
+            const framebuffer = gl.createFramebuffer();
+
+            gl.bindTexture(gl.TEXTURE_2D, texture);
+            gl.texStorage2D(gl.TEXTURE_2D, 1, gl.RGBA8, width, height);
+            gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MIN_FILTER, gl.LINEAR);
+            gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
+            gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
+            gl.bindFramebuffer(gl.FRAMEBUFFER, framebuffer);
+            gl.framebufferTexture2D(gl.FRAMEBUFFER, gl.COLOR_ATTACHMENT0, gl.TEXTURE_2D, texture, 0);
+
+            this.targets.push({ framebuffer, texture });
+        }
+
+        gl.bindTexture(gl.TEXTURE_2D, null);
+        gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+
+        this.width = width;
+        this.height = height;
+    }
+
+    private release(gl: WebGL2RenderingContext): void {
+        for (const target of this.targets) {
+            gl.deleteFramebuffer(target.framebuffer);
+            gl.deleteTexture(target.texture);
+        }
+
+        this.targets = [];
+    }
+}
+
+export default HeavyPostScene;
@@ -0,0 +1,126 @@
+import type Engine from '../Engine';
+import type { ArenaMesh } from '../GeometryArena';
+import Primitives from '../Primitives';
+import Shader from '../Shader';
+import { orbit, STATIC_VERTEX } from './StressScene';
+import type { StressScene } from './StressScene';
+
+const LIGHT_COUNT = 256;
+
+const LIT_FRAGMENT = `#version 300 es
+precision highp float;
+
+#define LIGHT_COUNT ${LIGHT_COUNT}
+
+in vec3 worldPosition;
+in vec3 worldNormal;
+
+layout(std140) uniform Lights {
+    vec4 positionRange[LIGHT_COUNT];
+    vec4 colorIntensity[LIGHT_COUNT];
+};
+
+out vec4 outColor;
+
+void main() {
+    vec3 normal = normalize(worldNormal);
+    vec3 total = vec3(0.02);
+
+    for (int i = 0; i < LIGHT_COUNT; i++) {
+        vec3 toLight = positionRange[i].xyz - worldPosition;
+        float distance = length(toLight);
+        float falloff = clamp(1.0 - distance / positionRange[i].w, 0.0, 1.0);
+
+        total += colorIntensity[i].rgb * colorIntensity[i].a * falloff * falloff * max(dot(normal, toLight / distance), 0.0);
+    }
+
+    outColor = vec4(total, 1.0);
+}`;
+// One material, every fragment loops over a few hundred moving point lights
+class ManyLightsScene implements StressScene {
+    public readonly subsystem = 'lighting';
+
+    private shader: Shader | null = null;
+    private ubo: WebGLBuffer | null = null;
+    private data: Float32Array = new Float32Array(LIGHT_COUNT * 8);
+    private phases: Float32Array = new Float32Array(LIGHT_COUNT * 2);
+    private meshes: ArenaMesh[] = [];
+    private material: number = 0;
+
+    public setup(engine: Engine, random: () => number): void {
+        const gl = engine.gl;
+        const shader = new Shader(gl, STATIC_VERTEX, LIT_FRAGMENT);
+        const ubo = gl.createBuffer();
+
+        gl.uniformBlockBinding(shader.program, gl.getUniformBlockIndex(shader.program, 'Lights'), 0);
+
+        for (let i = 0; i < LIGHT_COUNT; i++) {
+            this.phases[i * 2] = random() * Math.PI * 2;
+            this.phases[i * 2 + 1] = 3 + random() * 25;
+            this.data[i * 4 + 3] = 4 + random() * 6;
+            this.data[(LIGHT_COUNT + i) * 4] = random();
+            this.data[(LIGHT_COUNT + i) * 4 + 1] = random();
+            this.data[(LIGHT_COUNT + i) * 4 + 2] = random();
+            this.data[(LIGHT_COUNT + i) * 4 + 3] = 0.5 + random();
+        }
+
+        this.material = engine.registerMaterial(() => {
+            shader.use();
+            gl.uniformMatrix4fv(shader.uniform('viewProjection'), false, engine.camera.viewProjection);
+            gl.bindBufferBase(gl.UNIFORM_BUFFER, 0, ubo);
+        });
+
+        const floor = Primitives.box(0, -0.1, 0, 60, 0.2, 60);
+
+        this.meshes.push(engine.arena.allocate(Primitives.PositionNormal, floor.vertices, floor.indices));
+
+        for (let i = 0; i < 200; i++) {
+            const { vertices, indices } = Primitives.box((random() - 0.5) * 50, 1, (random() - 0.5) * 50, 1 + random(), 2, 1 + random());
+
+            this.meshes.push(engine.arena.allocate(Primitives.PositionNormal, vertices, indices));
+        }
+
+        this.shader = shader;
+        this.ubo = ubo;
+    }
+
+    public update(engine: Engine, time: number): void {
+        const gl = engine.gl;
+        const t = time * 0.001;
+
+        orbit(engine, time, 35, 20);
+
+        for (let i = 0; i < LIGHT_COUNT; i++) {
+            const phase = this.phases[i * 2];
+            const radius = this.phases[i * 2 + 1];
+
+            this.data[i * 4] = Math.sin(phase + t * 0.3) * radius;
+            this.data[i * 4 + 1] = 1 + Math.sin(phase * 3 + t);
+            this.data[i * 4 + 2] = Math.cos(phase + t * 0.3) * radius;
+        }
+
+        gl.bindBuffer(gl.UNIFORM_BUFFER, this.ubo);
+        gl.bufferData(gl.UNIFORM_BUFFER, this.data, gl.DYNAMIC_DRAW);
+        gl.bindBuffer(gl.UNIFORM_BUFFER, null);
+
+        for (const mesh of this.meshes) {
+            engine.arena.draw(mesh, this.material);
+        }
+    }
+
+    public counters(): Record<string, number> {
+        return { lights: LIGHT_COUNT, meshes: this.meshes.length };
+    }
+
+    public dispose(engine: Engine): void {
+        for (const mesh of this.meshes) {
+            engine.arena.release(mesh);
+        }
+
+        this.shader?.dispose();
+        engine.gl.deleteBuffer(this.ubo);
+        this.meshes = [];
+    }
+}
+
+export default ManyLightsScene;
@@ -0,0 +1,155 @@
+import type Engine from '../Engine';
+import type { RenderPass } from '../Engine';
+import Shader from '../Shader';
+import type { StreamingBuffer, StreamingStats } from '../StreamingBuffers';
+import { orbit } from './StressScene';
+import type { StressScene } from './StressScene';
+
+const PARTICLE_VERTEX = `#version 300 es
+layout(location = 0) in vec4 particle;
+
+uniform mat4 viewProjection;
+
+out float life;
+
+void main() {
+    life = particle.w;
+    gl_Position = viewProjection * vec4(particle.xyz, 1.0);
+    gl_PointSize = 2.0;
+}`;
+
+const PARTICLE_FRAGMENT = `#version 300 es
+precision mediump float;
+
+in float life;
+out vec4 outColor;
+
+void main() {
+    outColor = vec4(vec3(0.9, 0.85, 0.8) * life, 1.0) * 0.25;
+}`;
+// CPU simulated points re-uploaded every frame
+class ParticleStormScene implements StressScene, RenderPass {
+    public readonly subsystem = 'particles';
+
+    private static readonly COUNT = 200000;
+
+    private shader: Shader | null = null;
+    private vao: WebGLVertexArrayObject | null = null;
+    private stream: StreamingBuffer | null = null;
+    private streamStats: StreamingStats | null = null;
+    private particles: Float32Array = new Float32Array(ParticleStormScene.COUNT * 4);
+    private velocities: Float32Array = new Float32Array(ParticleStormScene.COUNT * 3);
+    private random: () => number = Math.random;
+    private lastTime: number = -1;
+
+    public setup(engine: Engine, random: () => number): void {
+        const gl = engine.gl;
+
+        this.random = random;
+        this.shader = new Shader(gl, PARTICLE_VERTEX, PARTICLE_FRAGMENT);
+        this.vao = gl.createVertexArray();
+        this.stream = engine.streams.create(gl.ARRAY_BUFFER, this.particles.byteLength);
+        this.streamStats = engine.streams.stats;
+
+        gl.bindVertexArray(this.vao);
+        gl.enableVertexAttribArray(0);
+        gl.bindVertexArray(null);
+
+        for (let i = 0; i < ParticleStormScene.COUNT; i++) {
+            this.spawn(i);
+            this.particles[i * 4 + 3] = random();
+        }
+
+        engine.passes.push(this);
+    }
+
+    public update(engine: Engine, time: number): void {
+        const dt = this.lastTime < 0 ? 0 : Math.min(0.05, (time - this.lastTime) / 1000);
+        const p = this.particles;
+        const v = this.velocities;
+
+        this.lastTime = time;
+        orbit(engine, time, 30, 8);
+
+        for (let i = 0; i < ParticleStormScene.COUNT; i++) {
+            // Swirl around the vertical axis with a little gravity
+            v[i * 3] += -p[i * 4 + 2] * 0.5 * dt;
+            v[i * 3 + 1] -= 1.5 * dt;
+            v[i * 3 + 2] += p[i * 4] * 0.5 * dt;
+
+            p[i * 4] += v[i * 3] * dt;
+            p[i * 4 + 1] += v[i * 3 + 1] * dt;
+            p[i * 4 + 2] += v[i * 3 + 2] * dt;
+            p[i * 4 + 3] -= dt * 0.25;
+
+            if (p[i * 4 + 3] <= 0 || p[i * 4 + 1] < 0) {
+                this.spawn(i);
+            }
+        }
+    }
+
+    public render(engine: Engine): void {
+        const gl = engine.gl;
+
+        if (!this.shader || !this.stream) {
+            return;
+        }
+
+        // The segment moves every frame, so the attribute is pointed at it again
+        const offset = this.stream.write(this.particles);
+
+        gl.bindVertexArray(this.vao);
+        gl.bindBuffer(gl.ARRAY_BUFFER, this.stream.buffer);
+        gl.vertexAttribPointer(0, 4, gl.FLOAT, false, 16, offset);
+        gl.bindBuffer(gl.ARRAY_BUFFER, null);
+
+        this.shader.use();
+        gl.uniformMatrix4fv(this.shader.uniform('viewProjection'), false, engine.camera.viewProjection);
+
+        gl.enable(gl.BLEND);
+        gl.blendFunc(gl.ONE, gl.ONE);
+        gl.depthMask(false);
+        gl.drawArrays(gl.POINTS, 0, ParticleStormScene.COUNT);
+        gl.bindVertexArray(null);
+        gl.depthMask(true);
+        gl.disable(gl.BLEND);
+
+        engine.drawCalls++;
+    }
+
+    public counters(): Record<string, number> {
+        return {
+            particles: ParticleStormScene.COUNT,
+            uploadBytes: this.particles.byteLength,
+            avoidedStalls: this.streamStats?.avoidedStalls ?? 0,
+            orphans: this.streamStats?.orphans ?? 0
+        };
+    }
+
+    public dispose(engine: Engine): void {
+        const gl = engine.gl;
+
+        engine.passes.splice(engine.passes.indexOf(this), 1);
+        this.shader?.dispose();
+        gl.deleteVertexArray(this.vao);
+
+        if (this.stream) {
+            engine.streams.release(this.stream);
+        }
+    }
+
+    private spawn(i: number): void {
+        const angle = this.random() * Math.PI * 2;
+        const radius = this.random() * 15;
+
+        this.particles[i * 4] = Math.sin(angle) * radius;
+        this.particles[i * 4 + 1] = 5 + this.random() * 10;
+        this.particles[i * 4 + 2] = Math.cos(angle) * radius;
+        this.particles[i * 4 + 3] = 1;
+        this.velocities[i * 3] = (this.random() - 0.5) * 2;
+        this.velocities[i * 3 + 1] = this.random() * 2;
+        this.velocities[i * 3 + 2] = (this.random() - 0.5) * 2;
+    }
+}
+
+export default ParticleStormScene;
@@ -0,0 +1,129 @@
+import type DepthPrepass from '../DepthPrepass';
+import type Engine from '../Engine';
+import type { VignetteSettings } from '../PostChain';
+import type { SkinnedMesh } from '../PreSkinning';
+import Primitives from '../Primitives';
+import Shader from '../Shader';
+import { FLAT_FRAGMENT, orbit, STATIC_VERTEX } from './StressScene';
+import type { StressScene } from './StressScene';
+
+// Hundreds of swaying skinned characters drawn by the prepass and both multi-resolution viewports
+// Counters report the skinning work done once per frame and what skinning in every pass would add
+class SkinnedCrowdScene implements StressScene {
+    public readonly subsystem = 'draw';
+
+    private static readonly COUNT = 400;
+    private static readonly JOINTS = 8;
+    private static readonly HEIGHT = 2;
+    // Dark enough past the middle for MultiResolution to shade the periphery at low resolution
+    private static readonly VIGNETTE: VignetteSettings = { inner: 0.15, outer: 0.6, strength: 0.9 };
+
+    private shader: Shader | null = null;
+    private characters: SkinnedMesh[] = [];
+    private phases: number[] = [];
+    private positions: number[] = [];
+    private previousMode: DepthPrepass['mode'] = 'auto';
+    private previousMultiResolution: boolean = false;
+    private previousVignette: VignetteSettings | null = null;
+    private frames: number = 0;
+    private skinnedVertices: number = 0;
+    private savedVertices: number = 0;
+    private passes: number = 0;
+
+    public setup(engine: Engine, random: () => number): void {
+        const gl = engine.gl;
+        const shader = new Shader(gl, STATIC_VERTEX, FLAT_FRAGMENT);
+        const { vertices, indices } = Primitives.tube(0.15, SkinnedCrowdScene.HEIGHT, SkinnedCrowdScene.JOINTS);
+        const material = engine.registerMaterial(() => {
+            shader.use();
+            gl.uniformMatrix4fv(shader.uniform('viewProjection'), false, engine.camera.viewProjection);
+            gl.uniform3f(shader.uniform('color'), 0.8, 0.55, 0.4);
+        });
+
+        for (let i = 0; i < SkinnedCrowdScene.COUNT; i++) {
+            this.characters.push(engine.skinning.create(vertices, indices, SkinnedCrowdScene.JOINTS, material));
+            this.phases.push(random() * Math.PI * 2);
+            this.positions.push((random() - 0.5) * 40, (random() - 0.5) * 40);
+        }
+
+        // Depth prepass and material pass in each multi-resolution viewport, four passes per frame
+        this.previousMode = engine.prepass.mode;
+        this.previousMultiResolution = engine.multiResolution.enabled;
+        this.previousVignette = { ...engine.post.vignette };
+        engine.prepass.mode = 'on';
+        engine.multiResolution.enabled = true;
+        Object.assign(engine.post.vignette, SkinnedCrowdScene.VIGNETTE);
+        this.shader = shader;
+    }
+
+    public update(engine: Engine, time: number): void {
+        orbit(engine, time, 22, 6);
+
+        const t = time / 1000;
+        const segment = SkinnedCrowdScene.HEIGHT / SkinnedCrowdScene.JOINTS;
+
+        this.characters.forEach((character, i) => {
+            const joints = character.joints;
+            const phase = this.phases[i];
+            // End of the chain so far and its accumulated bend about z
+            let angle = 0;
+            let x = this.positions[i * 2];
+            let y = 0;
+
+            for (let j = 0; j < SkinnedCrowdScene.JOINTS; j++) {
+                angle += Math.sin(t * 2 + phase + j * 0.6) * 0.12;
+
+                const cos = Math.cos(angle);
+                const sin = Math.sin(angle);
+                const pivot = j * segment;
+
+                // Rotates about z at the joint's bind pivot, then moves that pivot to the end of the chain
+                joints.set([
+                    cos, sin, 0, 0,
+                    -sin, cos, 0, 0,
+                    0, 0, 1, 0,
+                    x + sin * pivot, y - cos * pivot, this.positions[i * 2 + 1], 1
+                ], j * 16);
+
+                x -= sin * segment;
+                y += cos * segment;
+            }
+        });
+
+        const stats = engine.skinning.stats;
+
+        this.skinnedVertices += stats.skinnedVertices;
+        this.savedVertices += stats.savedVertices;
+        this.passes += stats.passes;
+        this.frames++;
+    }
+
+    public counters(): Record<string, number> {
+        const frames = Math.max(1, this.frames);
+
+        return {
+            characters: this.characters.length,
+            skinnedVertices: this.skinnedVertices / frames,
+            passes: this.passes / frames,
+            savedVertices: this.savedVertices / frames
+        };
+    }
+
+    public dispose(engine: Engine): void {
+        for (const character of this.characters) {
+            engine.skinning.release(character);
+        }
+
+        engine.prepass.mode = this.previousMode;
+        engine.multiResolution.enabled = this.previousMultiResolution;
+
+        if (this.previousVignette) {
+            Object.assign(engine.post.vignette, this.previousVignette);
+        }
+
+        this.shader?.dispose();
+        this.characters = [];
+    }
+}
+
+export default SkinnedCrowdScene;
@@ -0,0 +1,106 @@
+import type Engine from '../Engine';
+import type { ArenaMesh } from '../GeometryArena';
+import Primitives from '../Primitives';
+import Shader from '../Shader';
+import { FLAT_FRAGMENT, STATIC_VERTEX } from './StressScene';
+import type { StressScene } from './StressScene';
+
+// Walks down an endless corridor, geometry is allocated ahead of the camera and released behind it
+class StreamingWalkScene implements StressScene {
+    public readonly subsystem = 'streaming';
+
+    private static readonly SEGMENT_LENGTH = 8;
+    private static readonly SEGMENTS_AHEAD = 12;
+    private static readonly BOXES_PER_SEGMENT = 60;
+
+    private shader: Shader | null = null;
+    private material: number = 0;
+    private segments: { index: number; meshes: ArenaMesh[] }[] = [];
+    private random: () => number = Math.random;
+    private uploaded: number = 0;
+    private released: number = 0;
+
+    public setup(engine: Engine, random: () => number): void {
+        const gl = engine.gl;
+        const shader = new Shader(gl, STATIC_VERTEX, FLAT_FRAGMENT);
+
+        this.material = engine.registerMaterial(() => {
+            shader.use();
+            gl.uniformMatrix4fv(shader.uniform('viewProjection'), false, engine.camera.viewProjection);
+            gl.uniform3f(shader.uniform('color'), 0.6, 0.58, 0.5);
+        });
+
+        this.shader = shader;
+        this.random = random;
+    }
+
+    public update(engine: Engine, time: number): void {
+        const camera = engine.camera;
+        const z = -time * 0.006;
+        const current = Math.floor(-z / StreamingWalkScene.SEGMENT_LENGTH);
+
+        camera.position[0] = 0;
+        camera.position[1] = 1.6;
+        camera.position[2] = z;
+        camera.yaw = Math.sin(time * 0.0005) * 0.3;
+        camera.pitch = 0;
+
+        while (this.segments.length > 0 && this.segments[0].index < current - 1) {
+            for (const mesh of this.segments.shift()!.meshes) {
+                engine.arena.release(mesh);
+                this.released++;
+            }
+        }
+
+        const next = this.segments.length > 0 ? this.segments[this.segments.length - 1].index + 1 : current;
+
+        for (let index = next; index <= current + StreamingWalkScene.SEGMENTS_AHEAD; index++) {
+            this.segments.push({ index, meshes: this.buildSegment(engine, index) });
+        }
+
+        for (const segment of this.segments) {
+            for (const mesh of segment.meshes) {
+                engine.arena.draw(mesh, this.material);
+            }
+        }
+    }
+
+    public counters(): Record<string, number> {
+        return { segments: this.segments.length, uploadedMeshes: this.uploaded, releasedMeshes: this.released };
+    }
+
+    public dispose(engine: Engine): void {
+        for (const segment of this.segments) {
+            for (const mesh of segment.meshes) {
+                engine.arena.release(mesh);
+            }
+        }
+
+        this.segments = [];
+        this.shader?.dispose();
+    }
+
+    private buildSegment(engine: Engine, index: number): ArenaMesh[] {
+        const meshes: ArenaMesh[] = [];
+        const start = -index * StreamingWalkScene.SEGMENT_LENGTH;
+
+        for (let i = 0; i < StreamingWalkScene.BOXES_PER_SEGMENT; i++) {
+            const side = this.random() < 0.5 ? -1 : 1;
+            const size = 0.2 + this.random() * 1.2;
+            const { vertices, indices } = Primitives.box(
+                side * (1.5 + this.random() * 2),
+                this.random() * 3,
+                start - this.random() * StreamingWalkScene.SEGMENT_LENGTH,
+                size, size, size
+            );
+
+            meshes.push(engine.arena.allocate(Primitives.PositionNormal, vertices, indices));
+        }
+
+        this.uploaded += meshes.length;
+
+        return meshes;
+    }
+}
+
+export default StreamingWalkScene;
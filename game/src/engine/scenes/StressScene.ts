@@ -0,0 +1,59 @@
+import type Engine from '../Engine';
+
+type Subsystem = 'draw' | 'lighting' | 'particles' | 'post' | 'streaming' | 'audio' | 'simulation';
+
+// Synthetic scene built to saturate one subsystem, the benchmark harness reports per scene
+interface StressScene {
+    readonly subsystem: Subsystem;
+    setup(engine: Engine, random: () => number): void;
+    update(engine: Engine, time: number): void;
+    counters(): Record<string, number>;
+    dispose(engine: Engine): void;
+}
+
+const STATIC_VERTEX = `#version 300 es
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+
+uniform mat4 viewProjection;
+
+out vec3 worldPosition;
+out vec3 worldNormal;
+
+// Depth has to match the prepass exactly, see DepthPrepass
+invariant gl_Position;
+
+void main() {
+    worldPosition = position;
+    worldNormal = normal;
+    gl_Position = viewProjection * vec4(position, 1.0);
+}`;
+
+const FLAT_FRAGMENT = `#version 300 es
+precision mediump float;
+
+in vec3 worldPosition;
+in vec3 worldNormal;
+
+uniform vec3 color;
+
+out vec4 outColor;
+
+void main() {
+    float light = 0.3 + 0.7 * max(dot(normalize(worldNormal), normalize(vec3(0.4, 1.0, 0.3))), 0.0);
+    outColor = vec4(color * light, 1.0);
+}`;
+
+const orbit = (engine: Engine, time: number, radius: number, height: number): void => {
+    const camera = engine.camera;
+    const angle = time * 0.0001;
+
+    camera.position[0] = Math.sin(angle) * radius;
+    camera.position[1] = height;
+    camera.position[2] = Math.cos(angle) * radius;
+    camera.yaw = angle;
+    camera.pitch = -Math.atan2(height, radius);
+};
+
+export type { StressScene, Subsystem };
+export { STATIC_VERTEX, FLAT_FRAGMENT, orbit };
@@ -0,0 +1,42 @@
+import type Engine from '../Engine';
+import Swarm, { SwarmPresets } from '../Swarm';
+import { orbit } from './StressScene';
+import type { StressScene } from './StressScene';
+
+// Tens of thousands of flocking moths chasing the camera's light, all simulated on the GPU
+class SwarmScene implements StressScene {
+    public readonly subsystem = 'particles';
+
+    private static readonly COUNT = 50000;
+
+    private swarm: Swarm | null = null;
+
+    public setup(engine: Engine, random: () => number): void {
+        this.swarm = new Swarm(engine.gl, {
+            ...SwarmPresets.moths,
+            count: SwarmScene.COUNT,
+            boundsMin: [-20, 0, -20],
+            boundsMax: [20, 8, 20]
+        }, random);
+
+        engine.passes.push(this.swarm);
+    }
+
+    public update(engine: Engine, time: number): void {
+        orbit(engine, time, 18, 3);
+    }
+
+    public counters(): Record<string, number> {
+        return { agents: SwarmScene.COUNT, flocking: this.swarm?.flocking ? 1 : 0 };
+    }
+
+    public dispose(engine: Engine): void {
+        if (this.swarm) {
+            engine.passes.splice(engine.passes.indexOf(this.swarm), 1);
+            this.swarm.dispose();
+            this.swarm = null;
+        }
+    }
+}
+
+export default SwarmScene;
@@ -1,8 +1,26 @@
-import Game from './Game';
 import './style.css';
 
+import ResourceScope from './engine/ResourceScope';
+
+// Only the menu lives in the entry chunk, Game pulls the engine in as a separate chunk
+type GameModule = typeof import('./Game');
+
 class Main {
     public static canvas: HTMLCanvasElement;
+    // Owns the home screen and its background video, the game releases it once gameplay starts
+    public static menu: ResourceScope = new ResourceScope('menu');
+    public static options: Record<string, string> = {};
+
+    private static game: Promise<GameModule> | null = null;
+    private static starting: Promise<void> | null = null;
+
+    public static loadGame(): Promise<GameModule> {
+        if (!this.game) {
+            this.game = import('./Game');
+        }
+
+        return this.game;
+    }
 
     public static async main(args: string[]): Promise<void> {
         if (!args || args.length < 1) {
@@ -23,13 +41,44 @@ class Main {
             titleElement.innerHTML = Titles[os];
         }
 
+        const homeScreen = document.querySelector('.home-screen');
+
+        if (homeScreen) {
+            this.menu.element(homeScreen);
+        }
+
+        const options = await window.api.args();
+
+        this.options = options;
+
+        if (options.stress) {
+            return this.benchmark(options);
+        }
+
         document.querySelector('.play-button')?.addEventListener('click', () => {
             this.startGame();
         });
+
+        performance.mark('menu');
+
+        // Fetch and parse the engine while the player looks at the menu
+        requestIdleCallback(() => this.loadGame(), { timeout: 2000 });
+    }
+
+    // Clicks while the game chunk is still loading join the start already under way
+    public static startGame(): Promise<void> {
+        if (!this.starting) {
+            this.starting = this.start();
+        }
+
+        return this.starting;
     }
 
-    public static startGame() {
-        document.querySelector('.home-screen')?.remove();
+    private static async start(): Promise<void> {
+        performance.mark('play');
+
+        const { default: Game } = await this.loadGame();
+
         const canvas = document.querySelector('canvas');
 
         if (canvas) {
@@ -40,9 +89,53 @@ class Main {
 
             this.canvas = canvas;
 
-            const game = new Game(canvas);
+            // Game runs init itself, calling it again would register everything twice
+            const game = new Game(canvas, this.menu, Number(this.options.capture ?? 0));
+
+            await game.started;
+            performance.mark('gameplay');
+
+            this.reportBoot();
+        }
+    }
+
+    // Headless runs skip the menu, run one stress scene and hand the report back to the main process
+    private static async benchmark(options: Record<string, string>): Promise<void> {
+        const { default: Benchmark } = await import('./Benchmark');
+
+        this.menu.release();
+        const canvas = document.querySelector('canvas');
+
+        if (!canvas) {
+            throw new Error('Could not Determine the Canvas to Context.');
+        }
+
+        canvas.style.display = 'block';
+        canvas.style.width = `${window.innerWidth}px`;
+        canvas.style.height = `${window.innerHeight}px`;
+
+        // A failed run still reports, the main process only quits once it hears back
+        try {
+            const report = await Benchmark.run(canvas, {
+                scene: options.stress,
+                seed: Number(options.seed ?? 1),
+                frames: Number(options.frames ?? 600),
+                warmup: Number(options.warmup ?? 60),
+                capture: Number(options.capture ?? 0)
+            });
+
+            await window.api.reportBenchmark(report);
+        } catch (error) {
+            await window.api.reportBenchmark({ error: error instanceof Error ? error.message : String(error) });
+        }
+    }
+
+    private static async reportBoot(): Promise<void> {
+        const menu = performance.measure('time-to-menu', { start: 0, end: 'menu' });
+        const gameplay = performance.measure('time-to-gameplay', 'play', 'gameplay');
 
-            game.init();
+        if (await window.api.isdev()) {
+            console.info(`time-to-menu ${menu.duration.toFixed(1)}ms, time-to-gameplay ${gameplay.duration.toFixed(1)}ms`);
         }
     }
 }
@@ -0,0 +1,115 @@
+import './style.css';
+import CommandReplayer from './engine/CommandReplayer';
+import optimizeGlsl from './engine/GlslOptimizer';
+import type { ReplayReport } from './engine/CommandReplayer';
+
+// Shader variants the capture can be replayed with, each is timed against the captured sources
+const VARIANTS: Record<string, ((source: string) => string) | null> = {
+    original: null,
+    optimized: (source) => optimizeGlsl(source).source,
+    'optimized + mediump': (source) => optimizeGlsl(source, { lowerPrecision: true }).source
+};
+
+// Standalone page that runs a GL command capture without the game, open /replay.html and pick a .glcap file
+const format = (report: ReplayReport): string => {
+    const lines = [`${report.frames} frames at ${report.width}x${report.height}`, '', 'frame  cpu ms'];
+
+    report.frameCpuMs.forEach((ms, frame) => lines.push(`${String(frame).padStart(5)}  ${ms.toFixed(3)}`));
+    lines.push('', 'frame  target      calls    cpu ms    gpu ms');
+
+    for (const pass of report.passes) {
+        lines.push(`${String(pass.frame).padStart(5)}  ${pass.target.padEnd(10)}  ${String(pass.calls).padStart(5)}  ${pass.cpuMs.toFixed(3).padStart(8)}  ${pass.gpuMs.toFixed(3).padStart(8)}`);
+    }
+
+    lines.push('', 'call                                      calls    cpu ms');
+
+    for (const call of report.calls) {
+        lines.push(`${call.name.padEnd(40)}  ${String(call.calls).padStart(5)}  ${call.cpuMs.toFixed(3).padStart(8)}`);
+    }
+
+    return lines.join('\n');
+};
+
+// Same frames, same passes, so they line up one to one
+const compare = (name: string, original: ReplayReport, variant: ReplayReport, bytes: [number, number]): string => {
+    const compileMs = (report: ReplayReport) => report.calls
+        .filter((call) => call.name === 'compileShader' || call.name === 'linkProgram')
+        .reduce((sum, call) => sum + call.cpuMs, 0);
+    const gpuMs = (report: ReplayReport) => report.passes.reduce((sum, pass) => sum + pass.gpuMs, 0);
+    const change = (before: number, after: number) => `${after >= before ? '+' : ''}${((after / Math.max(1e-6, before) - 1) * 100).toFixed(1)}%`;
+    const lines = [
+        `original vs ${name}`,
+        `shader bytes    ${String(bytes[0]).padStart(8)}  ${String(bytes[1]).padStart(8)}  ${change(bytes[0], bytes[1])}`,
+        `compile ms      ${compileMs(original).toFixed(3).padStart(8)}  ${compileMs(variant).toFixed(3).padStart(8)}  ${change(compileMs(original), compileMs(variant))}`,
+        `gpu ms          ${gpuMs(original).toFixed(3).padStart(8)}  ${gpuMs(variant).toFixed(3).padStart(8)}  ${change(gpuMs(original), gpuMs(variant))}`,
+        '',
+        'frame  target      original gpu ms  variant gpu ms'
+    ];
+
+    original.passes.forEach((pass, i) => {
+        const other = variant.passes[i];
+
+        lines.push(`${String(pass.frame).padStart(5)}  ${pass.target.padEnd(10)}  ${pass.gpuMs.toFixed(3).padStart(15)}  ${(other?.gpuMs ?? NaN).toFixed(3).padStart(14)}`);
+    });
+
+    return lines.join('\n');
+};
+
+const input = document.querySelector('.replay input') as HTMLInputElement;
+const select = document.querySelector('.replay select') as HTMLSelectElement;
+const output = document.querySelector('.replay-report') as HTMLPreElement;
+
+for (const name of Object.keys(VARIANTS)) {
+    select.add(new Option(name, name));
+}
+
+// Every replay gets a fresh context, a replay leaves all of its objects behind
+const replay = async (buffer: ArrayBuffer, rewrite: ((source: string) => string) | null): Promise<ReplayReport> => {
+    const canvas = document.createElement('canvas');
+    const gl = canvas.getContext('webgl2');
+
+    if (!gl) {
+        throw new Error('WebGL is Not Supported in your Browser or System, Could be due to mofiying the Runtime.');
+    }
+
+    document.querySelector('canvas')?.replaceWith(canvas);
+
+    const replayer = new CommandReplayer(gl, buffer);
+
+    replayer.rewriteShader = rewrite;
+
+    return replayer.run();
+};
+
+input.addEventListener('change', async () => {
+    const file = input.files?.[0];
+
+    if (!file) {
+        return;
+    }
+
+    const buffer = await file.arrayBuffer();
+    const rewrite = VARIANTS[select.value];
+
+    output.textContent = `replaying ${file.name}...`;
+
+    const original = await replay(buffer, null);
+
+    if (!rewrite) {
+        output.textContent = format(original);
+
+        return;
+    }
+
+    const bytes: [number, number] = [0, 0];
+    const variant = await replay(buffer, (source) => {
+        const rewritten = rewrite(source);
+
+        bytes[0] += source.length;
+        bytes[1] += rewritten.length;
+
+        return rewritten;
+    });
+
+    output.textContent = `${compare(select.value, original, variant, bytes)}\n\n${format(variant)}`;
+});
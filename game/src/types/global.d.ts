@@ -4,7 +4,12 @@ declare global {
 
             platform: () => Promise<any>,
             exit: () => Promise<any>,
-            isdev: () => Promise<any>
+            isdev: () => Promise<any>,
+            saveTelemetry: (name: string, data: ArrayBuffer) => Promise<void>,
+            loadTelemetry: (prefix: string) => Promise<Uint8Array[]>,
+            readAsset: (name: string, offset: number, length: number) => Promise<Uint8Array>,
+            args: () => Promise<Record<string, string>>,
+            reportBenchmark: (report: object) => Promise<void>
         };
     }
 }
@@ -0,0 +1,178 @@
+import { resolve } from 'node:path';
+import { defineConfig } from 'vite';
+import type { Plugin } from 'vite';
+import optimizeGlsl from './src/engine/GlslOptimizer';
+
+// Template literals that hold a shader, ${} interpolations included
+const SHADER_LITERAL = /`(#version 300 es(?:[^`\\$]|\$(?!\{)|\$\{[^`}]*\})*)`/g;
+
+const BASE64 = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
+
+const vlq = (value: number): string => {
+    let rest = value < 0 ? (-value << 1) | 1 : value << 1;
+    let out = '';
+
+    do {
+        const digit = rest & 31;
+
+        rest >>>= 5;
+        out += BASE64[rest > 0 ? digit | 32 : digit];
+    } while (rest > 0);
+
+    return out;
+};
+
+// Version 3 source map for one transformed module, segments added in generated order
+class SourceMapBuilder {
+    private lines: string[][] = [[]];
+    private column: number = 0;
+    private sourceLine: number = 0;
+    private sourceColumn: number = 0;
+
+    public add(column: number, sourceLine: number, sourceColumn: number): void {
+        const line = this.lines[this.lines.length - 1];
+
+        line.push(vlq(column - this.column) + 'A' + vlq(sourceLine - this.sourceLine) + vlq(sourceColumn - this.sourceColumn));
+        this.column = column;
+        this.sourceLine = sourceLine;
+        this.sourceColumn = sourceColumn;
+    }
+
+    public newLine(): void {
+        this.lines.push([]);
+        this.column = 0;
+    }
+
+    public toJSON(source: string): { version: number; sources: string[]; names: string[]; mappings: string } {
+        return { version: 3, sources: [source], names: [], mappings: this.lines.map((line) => line.join(',')).join(';') };
+    }
+}
+
+// Shaders ship folded, dead code free and minified, interpolations stand in as opaque names while optimizing
+const glslOptimizer = (): Plugin => {
+    let shaders = 0;
+    let before = 0;
+    let after = 0;
+
+    return {
+        name: 'glsl-optimizer',
+        apply: 'build',
+        transform(code, id) {
+            if (!/\.ts$/.test(id) || !code.includes('#version 300 es')) {
+                return null;
+            }
+
+            const lineStarts = [0];
+
+            for (let i = 0; i < code.length; i++) {
+                if (code[i] === '\n') {
+                    lineStarts.push(i + 1);
+                }
+            }
+
+            const map = new SourceMapBuilder();
+            let column = 0;
+            let output = '';
+
+            // Original line and column of an offset into code
+            const locate = (offset: number): [number, number] => {
+                let low = 0;
+                let high = lineStarts.length - 1;
+
+                while (low < high) {
+                    const middle = (low + high + 1) >> 1;
+
+                    if (lineStarts[middle] <= offset) {
+                        low = middle;
+                    } else {
+                        high = middle - 1;
+                    }
+                }
+
+                return [low, offset - lineStarts[low]];
+            };
+
+            // Appends text, every token start maps back to the original offset from(index)
+            const append = (text: string, from: (index: number) => number): void => {
+                for (let i = 0; i < text.length; i++) {
+                    if (text[i] === '\n') {
+                        map.newLine();
+                        column = 0;
+                    } else {
+                        const offset = /\s/.test(text[i]) || (/\w/.test(text[i]) && /\w/.test(text[i - 1] ?? '')) ? null : from(i);
+
+                        if (offset !== null) {
+                            map.add(column, ...locate(offset));
+                        }
+
+                        column++;
+                    }
+                }
+
+                output += text;
+            };
+
+            let copied = 0;
+
+            for (const match of code.matchAll(SHADER_LITERAL)) {
+                const literal = match[0];
+                const body = match[1];
+                const start = match.index;
+                const expressions: string[] = [];
+                const text = body.replace(/\$\{([^`}]*)\}/g, (_, expression: string) => `__GLSL_${expressions.push(expression) - 1}__`);
+                const { source } = optimizeGlsl(text, { opaque: expressions.map((_, i) => `__GLSL_${i}__`) });
+                // Set apart, so a spliced in negative number never joins the operator before it and spliced in
+                // directives keep their own lines, only inside a directive it has to stay on the line
+                const restored = source.split('\n').map((line) => line.replace(/__GLSL_(\d+)__/g, (_, i: string) => {
+                    const gap = line.startsWith('#') ? ' ' : '\n';
+
+                    return `${gap}\${${expressions[Number(i)]}}${gap}`;
+                })).join('\n');
+
+                if (source === text) {
+                    continue;
+                }
+
+                shaders++;
+                before += body.length;
+                after += restored.length;
+
+                // Unchanged code maps token by token, a rewritten shader maps to the start of its literal
+                append(code.slice(copied, start), (i) => copied + i);
+                append(`\`${restored}\``, () => start);
+                copied = start + literal.length;
+            }
+
+            if (copied === 0) {
+                return null;
+            }
+
+            append(code.slice(copied), (i) => copied + i);
+
+            return { code: output, map: map.toJSON(id) };
+        },
+        buildEnd() {
+            console.info(`glsl: ${shaders} shaders, ${before} -> ${after} bytes`);
+        }
+    };
+};
+
+export default defineConfig({
+    plugins: [glslOptimizer()],
+    // Cross origin isolation makes SharedArrayBuffer available to the simulation worker
+    server: {
+        headers: {
+            'Cross-Origin-Opener-Policy': 'same-origin',
+            'Cross-Origin-Embedder-Policy': 'require-corp'
+        }
+    },
+    build: {
+        rollupOptions: {
+            // The capture replayer is its own page and never loads the game
+            input: {
+                main: resolve(import.meta.dirname, 'index.html'),
+                replay: resolve(import.meta.dirname, 'replay.html')
+            }
+        }
+    }
+});
@@ -1,5 +1,6 @@
 const { app, BrowserWindow, ipcMain } = require('electron');
 const path = require('path');
+const fs = require('fs');
 const os = require('os');
 
 const IconExtension = {
@@ -21,6 +22,17 @@ OSNativeIconPath = path.join(
     `icon${IconExtension[currentOS] || IconExtension[defaultOS]}`
 );
 
+// --key=value switches, e.g. --stress=draw-calls --seed=7 --frames=600 --headless --report=out.json
+const Args = Object.fromEntries(
+    process.argv
+        .filter((arg) => arg.startsWith('--'))
+        .map((arg) => {
+            const [key, ...value] = arg.slice(2).split('=');
+
+            return [key, value.length > 0 ? value.join('=') : 'true'];
+        })
+);
+
 class Game {
     constructor() {
         this.window = null;
@@ -28,12 +40,18 @@ class Game {
     }
 
     createWindow() {
+        const headless = Args.headless === 'true';
+
         this.window = new BrowserWindow({
-            width: 1000,
-            height: 600,
+            width: Number(Args.width || 1000),
+            height: Number(Args.height || 600),
             autoHideMenuBar: true,
             icon: OSNativeIconPath,
+            show: !headless,
+            paintWhenInitiallyHidden: true,
             webPreferences: {
+                // Hidden benchmark windows must keep rendering at full rate
+                backgroundThrottling: !headless,
                 preload: path.join(__dirname, 'preload.js'),
                 nodeIntegration: false,
                 contextIsolation: true,
@@ -58,6 +76,14 @@ class Game {
 function MainGame() {
     const game = new Game();
 
+    // Packaged builds load from file:// where isolation headers cannot be set, the simulation worker needs shared memory
+    app.commandLine.appendSwitch('enable-features', 'SharedArrayBuffer');
+
+    if (Args.stress) {
+        // The audio stress scene starts its context without a click
+        app.commandLine.appendSwitch('autoplay-policy', 'no-user-gesture-required');
+    }
+
     app.whenReady().then(() => {
         game.createWindow();
 
@@ -85,6 +111,63 @@ function MainGame() {
     ipcMain.handle('isdev', () => {
         return !app.isPackaged
     })
+
+    ipcMain.handle('args', () => {
+        return Args
+    })
+
+    ipcMain.handle('benchmark:report', async (_event, report) => {
+        if (report.error) {
+            process.stderr.write(`${report.error}\n`);
+            app.exit(1);
+
+            return;
+        }
+
+        const json = JSON.stringify(report, null, 4);
+
+        if (Args.report) {
+            await fs.promises.writeFile(Args.report, json);
+        } else {
+            process.stdout.write(`${json}\n`);
+        }
+
+        app.quit();
+    })
+
+    ipcMain.handle('telemetry:save', async (_event, name, data) => {
+        const dir = path.join(app.getPath('userData'), 'telemetry');
+
+        await fs.promises.mkdir(dir, { recursive: true });
+        await fs.promises.writeFile(path.join(dir, path.basename(name)), Buffer.from(data));
+    })
+
+    // Ranged reads of the asset archives, the renderer only ever gets the bytes it asked for
+    ipcMain.handle('assets:read', async (_event, name, offset, length) => {
+        const root = app.isPackaged ? path.join(__dirname, 'static') : path.join(__dirname, 'game', 'public');
+        const file = await fs.promises.open(path.join(root, path.basename(name)), 'r');
+
+        try {
+            const buffer = Buffer.alloc(length);
+            const { bytesRead } = await file.read(buffer, 0, length, offset);
+
+            return new Uint8Array(buffer.buffer, buffer.byteOffset, bytesRead);
+        } finally {
+            await file.close();
+        }
+    })
+
+    ipcMain.handle('telemetry:load', async (_event, prefix) => {
+        const dir = path.join(app.getPath('userData'), 'telemetry');
+        const names = await fs.promises.readdir(dir).catch(() => []);
+        const files = [];
+
+        for (const name of names.filter((name) => name.startsWith(prefix))) {
+            files.push(new Uint8Array(await fs.promises.readFile(path.join(dir, name))));
+        }
+
+        return files;
+    })
 }
 
 MainGame();
\ No newline at end of file
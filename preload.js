@@ -3,5 +3,10 @@ const { contextBridge, ipcRenderer } = require('electron');
 contextBridge.exposeInMainWorld('api', {
     platform: () => ipcRenderer.invoke('platform'),
     exit: () => ipcRenderer.invoke('exit'),
-    isdev: () => ipcRenderer.invoke('isdev')
+    isdev: () => ipcRenderer.invoke('isdev'),
+    saveTelemetry: (name, data) => ipcRenderer.invoke('telemetry:save', name, data),
+    loadTelemetry: (prefix) => ipcRenderer.invoke('telemetry:load', prefix),
+    readAsset: (name, offset, length) => ipcRenderer.invoke('assets:read', name, offset, length),
+    args: () => ipcRenderer.invoke('args'),
+    reportBenchmark: (report) => ipcRenderer.invoke('benchmark:report', report)
 });
\ No newline at end of file
@@ -0,0 +1,135 @@
+// Headless benchmark harness, runs every stress scene in its own Electron process
+//
+// usage: node scripts/bench.js [--scenes=draw-calls,many-lights] [--seed=1] [--frames=600] [--timeout=300]
+//                              [--out=bench.json] [--baseline=bench.json] [--threshold=0.1] [--diagnose] [--top=20]
+//
+// Unpackaged Electron loads the game from the Vite dev server, start it first (npm run dev in game/).
+// A scene that has not reported after --timeout seconds is killed and fails the run.
+//
+// --diagnose runs the renderer with V8 deopt and IC logging and ranks deopts and polymorphic property
+// accesses by engine source location, see v8-diagnostics.js. Logging slows every frame, so timings
+// from a diagnose run are not compared against the baseline.
+const { spawnSync } = require('child_process');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const electron = require('electron');
+const diagnostics = require('./v8-diagnostics');
+
+const SCENES = ['draw-calls', 'many-lights', 'particle-storm', 'swarm', 'heavy-post', 'streaming-walk', 'audio-flood', 'component-access', 'skinned-crowd'];
+
+const Args = Object.fromEntries(
+    process.argv.slice(2).map((arg) => {
+        const [key, ...value] = arg.replace(/^--/, '').split('=');
+
+        return [key, value.length > 0 ? value.join('=') : 'true'];
+    })
+);
+
+async function runScene(scene) {
+    const report = path.join(os.tmpdir(), `static-bench-${process.pid}-${scene}.json`);
+    // V8 writes one log per isolate into the working directory, the sandbox would keep the renderer from writing it
+    const logs = Args.diagnose ? fs.mkdtempSync(path.join(os.tmpdir(), `static-v8-${scene}-`)) : null;
+    const result = spawnSync(electron, [
+        path.join(__dirname, '..'),
+        `--stress=${scene}`,
+        `--seed=${Args.seed || 1}`,
+        `--frames=${Args.frames || 600}`,
+        `--report=${report}`,
+        '--headless',
+        ...(logs ? ['--no-sandbox', '--js-flags=--log-code --log-deopt --log-ic --logfile=v8.log'] : [])
+    ], { stdio: 'inherit', cwd: logs ?? process.cwd(), timeout: Number(Args.timeout || 300) * 1000 });
+
+    if (result.error?.code === 'ETIMEDOUT') {
+        throw new Error(`Stress Scene '${scene}' Timed Out after ${Args.timeout || 300}s, is the Dev Server Running?`);
+    }
+
+    if (result.status !== 0 || !fs.existsSync(report)) {
+        throw new Error(`Stress Scene '${scene}' did not Produce a Report.`);
+    }
+
+    const data = JSON.parse(fs.readFileSync(report, 'utf8'));
+
+    fs.unlinkSync(report);
+
+    if (logs) {
+        data.v8 = await diagnostics.report(logs);
+        fs.rmSync(logs, { recursive: true, force: true });
+    }
+
+    return data;
+}
+
+function printDiagnostics(reports, top) {
+    for (const report of reports) {
+        console.log(`\n${report.scene}: ${report.v8.deopts.length} deopt sites, ${report.v8.ics.length} polymorphic property sites`);
+
+        if (report.v8.deopts.length > 0) {
+            console.table(report.v8.deopts.slice(0, top));
+        }
+
+        if (report.v8.ics.length > 0) {
+            console.table(report.v8.ics.slice(0, top));
+        }
+    }
+}
+
+// Compares p95 frame, CPU and GPU time per scene, so a regression names the subsystem it came from
+function compare(reports, baseline, threshold) {
+    const regressions = [];
+
+    for (const report of reports) {
+        const before = baseline.find((entry) => entry.scene === report.scene);
+
+        if (!before) {
+            continue;
+        }
+
+        for (const metric of ['frameMs', 'cpuMs', 'gpuMs']) {
+            const change = report[metric].p95 / Math.max(1e-6, before[metric].p95) - 1;
+
+            if (change > threshold) {
+                regressions.push(`${report.subsystem} (${report.scene}): ${metric} p95 ${before[metric].p95.toFixed(2)} -> ${report[metric].p95.toFixed(2)} (+${(change * 100).toFixed(0)}%)`);
+            }
+        }
+    }
+
+    return regressions;
+}
+
+async function main() {
+    const scenes = Args.scenes ? Args.scenes.split(',') : SCENES;
+    const reports = [];
+
+    for (const scene of scenes) {
+        reports.push(await runScene(scene));
+    }
+
+    console.table(Object.fromEntries(reports.map((report) => [report.scene, {
+        subsystem: report.subsystem,
+        'frame p95': report.frameMs.p95.toFixed(2),
+        'cpu p95': report.cpuMs.p95.toFixed(2),
+        'gpu p95': report.gpuMs.p95.toFixed(2),
+        draws: report.drawCalls.toFixed(0)
+    }])));
+
+    if (Args.diagnose) {
+        printDiagnostics(reports, Number(Args.top || 20));
+    }
+
+    if (Args.out) {
+        fs.writeFileSync(Args.out, JSON.stringify(reports, null, 4));
+    }
+
+    if (Args.baseline && !Args.diagnose) {
+        const regressions = compare(reports, JSON.parse(fs.readFileSync(Args.baseline, 'utf8')), Number(Args.threshold || 0.1));
+
+        for (const line of regressions) {
+            console.log(`REGRESSION ${line}`);
+        }
+
+        process.exitCode = regressions.length > 0 ? 1 : 0;
+    }
+}
+
+main();
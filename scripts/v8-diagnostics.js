@@ -0,0 +1,272 @@
+// Reads the V8 logs a benchmark run writes with --diagnose and ranks deopts and polymorphic property
+// accesses by the engine source they come from
+//
+// Log lines used (--log-code --log-deopt --log-ic):
+//   code-creation,type,kind,time,address,size,name[,sfi,state]   name is "function url:line:column" for JS
+//   code-move,from,to
+//   code-deopt,time,size,address,inlining id,script offset,kind,<url:line:column>[ inlined at <...>],reason
+//   <type>IC,pc,time,line,column,old state,new state,map,key,modifier,slow reason
+// Generated positions are mapped back through the page's source maps, inline or next to the script.
+const fs = require('fs');
+const path = require('path');
+const { fileURLToPath } = require('url');
+
+// V8 IC states worth reporting, P polymorphic, N megamorphic, G generic
+const STATE_RANK = { P: 1, N: 2, G: 3 };
+const STATE_NAMES = { P: 'polymorphic', N: 'megamorphic', G: 'generic' };
+const VLQ = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
+
+// Commas, newlines and non ascii characters are escaped in log fields
+const unescape = (field) => field.replace(/\\x([0-9A-Fa-f]{2})|\\u([0-9A-Fa-f]{4})|\\n/g, (match, byte, unit) => {
+    return match === '\\n' ? '\n' : String.fromCharCode(parseInt(byte ?? unit, 16));
+});
+
+// Only the page's own scripts, not Electron or Node internals
+const isPageScript = (url) => /^(https?|file):\/\//.test(url);
+
+function decodeMappings(mappings) {
+    const lines = [];
+    let source = 0;
+    let sourceLine = 0;
+    let sourceColumn = 0;
+
+    for (const line of mappings.split(';')) {
+        const segments = [];
+        let column = 0;
+
+        for (const segment of line.split(',')) {
+            if (segment === '') {
+                continue;
+            }
+
+            const values = [];
+            let value = 0;
+            let shift = 0;
+
+            for (const char of segment) {
+                const digit = VLQ.indexOf(char);
+
+                value += (digit & 31) << shift;
+
+                if (digit & 32) {
+                    shift += 5;
+                } else {
+                    values.push(value & 1 ? -(value >> 1) : value >> 1);
+                    value = 0;
+                    shift = 0;
+                }
+            }
+
+            column += values[0];
+
+            if (values.length >= 4) {
+                source += values[1];
+                sourceLine += values[2];
+                sourceColumn += values[3];
+                segments.push([column, source, sourceLine, sourceColumn]);
+            }
+        }
+
+        lines.push(segments);
+    }
+
+    return lines;
+}
+
+async function load(url) {
+    if (url.startsWith('data:')) {
+        const [meta, data] = url.slice(5).split(',', 2);
+
+        return meta.endsWith(';base64') ? Buffer.from(data, 'base64').toString('utf8') : decodeURIComponent(data);
+    }
+
+    if (url.startsWith('file://')) {
+        return fs.promises.readFile(fileURLToPath(url), 'utf8').catch(() => null);
+    }
+
+    const response = await fetch(url).catch(() => null);
+
+    return response?.ok ? response.text() : null;
+}
+
+// url -> { sources, lines } or null, the dev server inlines maps, builds put them next to the script
+async function loadSourceMap(url, cache) {
+    if (!cache.has(url)) {
+        cache.set(url, (async () => {
+            const script = await load(url);
+            const comment = script && /\/\/# sourceMappingURL=(\S+)\s*$/.exec(script);
+            const text = await load(comment ? new URL(comment[1], url).href : `${url}.map`);
+
+            if (!text) {
+                return null;
+            }
+
+            const map = JSON.parse(text);
+            const root = new URL(map.sourceRoot || '.', url).href;
+
+            return {
+                sources: map.sources.map((source) => {
+                    const resolved = new URL(source, root);
+
+                    return resolved.protocol === 'file:' ? path.relative(process.cwd(), fileURLToPath(resolved)) : resolved.pathname.replace(/^\//, '');
+                }),
+                lines: decodeMappings(map.mappings)
+            };
+        })());
+    }
+
+    return cache.get(url);
+}
+
+// V8 lines and columns start at 1, source maps count from 0
+async function locate(url, line, column, cache) {
+    const map = await loadSourceMap(url, cache);
+    const segments = map?.lines[line - 1];
+    let found = null;
+
+    for (const segment of segments ?? []) {
+        if (segment[0] > column - 1) {
+            break;
+        }
+
+        found = segment;
+    }
+
+    return found ? `${map.sources[found[1]]}:${found[2] + 1}:${found[3] + 1}` : `${url}:${line}:${column}`;
+}
+
+// Code objects by start address, so an IC's pc resolves to the script it belongs to
+class CodeMap {
+    constructor() {
+        this.starts = [];
+        this.entries = [];
+    }
+
+    add(start, size, url) {
+        const index = this.search(start) + 1;
+
+        if (this.starts[index - 1] === start) {
+            this.entries[index - 1] = { start, size, url };
+
+            return;
+        }
+
+        this.starts.splice(index, 0, start);
+        this.entries.splice(index, 0, { start, size, url });
+    }
+
+    move(from, to) {
+        const index = this.search(from);
+
+        if (this.starts[index] === from) {
+            const [entry] = this.entries.splice(index, 1);
+
+            this.starts.splice(index, 1);
+            this.add(to, entry.size, entry.url);
+        }
+    }
+
+    find(address) {
+        const entry = this.entries[this.search(address)];
+
+        return entry && address < entry.start + entry.size ? entry.url : null;
+    }
+
+    // Index of the last start at or below address, -1 if none
+    search(address) {
+        let low = 0;
+        let high = this.starts.length - 1;
+
+        while (low <= high) {
+            const middle = (low + high) >> 1;
+
+            if (this.starts[middle] <= address) {
+                low = middle + 1;
+            } else {
+                high = middle - 1;
+            }
+        }
+
+        return high;
+    }
+}
+
+function parse(file, deopts, ics) {
+    const code = new CodeMap();
+
+    for (const line of fs.readFileSync(file, 'utf8').split('\n')) {
+        const fields = line.split(',');
+        const event = fields[0];
+
+        if (event === 'code-creation') {
+            const name = unescape(fields[6] ?? '');
+            const script = /\s(\S+):\d+:\d+$/.exec(name);
+
+            code.add(Number(fields[4]), Number(fields[5]), script && isPageScript(script[1]) ? script[1] : null);
+        } else if (event === 'code-move') {
+            code.move(Number(fields[1]), Number(fields[2]));
+        } else if (event === 'code-deopt') {
+            const location = /<(.+?):(\d+):(\d+)>/.exec(unescape(fields[fields.length - 2]));
+
+            if (location && isPageScript(location[1])) {
+                deopts.push({ url: location[1], line: Number(location[2]), column: Number(location[3]), reason: unescape(fields[fields.length - 1]) });
+            }
+        } else if (event.endsWith('IC') && fields.length >= 9) {
+            const url = code.find(Number(fields[1]));
+            const state = fields[6];
+
+            if (url && STATE_RANK[state]) {
+                ics.push({ url, line: Number(fields[3]), column: Number(fields[4]), type: event, state, map: fields[7], key: unescape(fields[8]) });
+            }
+        }
+    }
+}
+
+// Every v8 log in dir, ranked worst first
+async function report(dir) {
+    const deopts = [];
+    const ics = [];
+    const cache = new Map();
+
+    for (const file of fs.readdirSync(dir).filter((name) => name.endsWith('v8.log'))) {
+        parse(path.join(dir, file), deopts, ics);
+    }
+
+    const deoptSites = new Map();
+
+    for (const deopt of deopts) {
+        const location = await locate(deopt.url, deopt.line, deopt.column, cache);
+        const key = `${location} ${deopt.reason}`;
+        const site = deoptSites.get(key) ?? { location, reason: deopt.reason, count: 0 };
+
+        site.count++;
+        deoptSites.set(key, site);
+    }
+
+    const icSites = new Map();
+
+    for (const ic of ics) {
+        const location = await locate(ic.url, ic.line, ic.column, cache);
+        const key = `${location} ${ic.key}`;
+        const site = icSites.get(key) ?? { location, type: ic.type, key: ic.key, state: ic.state, transitions: 0, maps: new Set() };
+
+        site.transitions++;
+        site.maps.add(ic.map);
+
+        if (STATE_RANK[ic.state] > STATE_RANK[site.state]) {
+            site.state = ic.state;
+        }
+
+        icSites.set(key, site);
+    }
+
+    return {
+        deopts: [...deoptSites.values()].sort((a, b) => b.count - a.count),
+        ics: [...icSites.values()]
+            .map((site) => ({ ...site, state: STATE_NAMES[site.state], rank: STATE_RANK[site.state], maps: site.maps.size }))
+            .sort((a, b) => b.rank - a.rank || b.maps - a.maps || b.transitions - a.transitions)
+            .map(({ rank, ...site }) => site)
+    };
+}
+
+module.exports = { report };